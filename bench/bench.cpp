@@ -0,0 +1,191 @@
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "benchmark.hpp"
+
+using namespace bench;
+
+void bench::groupConstants(const precIndex n_groups,
+			   timeBins& lambda,
+			   timeBins& beta) {
+  const timeBins lambda_6 = {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01};
+  const timeBins beta_6   = {0.000215, 0.001424, 0.001274,
+			     0.002568, 0.000748, 0.000273};
+
+  if (n_groups == 6) {
+    lambda = lambda_6;
+    beta   = beta_6;
+    return;
+  }
+
+  lambda.resize(n_groups);
+  beta.assign(n_groups, 0.0065 / n_groups);
+
+  // from 0.0124 to 3.01 1/s, as in the six group set
+  for (precIndex k = 0; k < n_groups; k++) {
+    const double x = n_groups > 1 ? double(k) / (n_groups - 1) : 0.5;
+    lambda[k] = 0.0124 * std::pow(3.01 / 0.0124, x);
+  }
+}
+
+epke::EPKEParameters::ptr bench::makeParameters(const precIndex n_groups,
+						const timeIndex n_steps,
+						const double t_end) {
+  timeBins lambda, beta;
+  groupConstants(n_groups, lambda, beta);
+
+  timeBins time(n_steps), rho_imp(n_steps);
+  for (timeIndex n = 0; n < n_steps; n++) {
+    time[n] = t_end * n / (n_steps - 1);
+    rho_imp[n] = time[n] < 0.1 ? 0. : 0.5 * 0.0065;
+  }
+
+  precBins<epke::Precursor::ptr> precursors;
+  for (precIndex k = 0; k < n_groups; k++) {
+    precursors.push_back(std::make_shared<epke::Precursor>(
+			   timeBins(n_steps, lambda[k]),
+			   timeBins(n_steps, beta[k])));
+  }
+
+  return std::make_shared<epke::EPKEParameters>(time,
+						precursors,
+						rho_imp,
+						timeBins(n_steps, 2e-5),
+						timeBins(n_steps, 1.),
+						timeBins(n_steps, 0.0065),
+						timeBins(n_steps, 0.29),
+						0.5,
+						-0.0092,
+						1.0);
+}
+
+epke::EPKEOutput::ptr bench::makeInitial(const epke::EPKEParameters& params) {
+  const timeIndex n_steps  = params.getNumTimeSteps();
+  const precIndex n_groups = params.getNumPrecursors();
+
+  precBins<timeBins> concentrations;
+  for (precIndex k = 0; k < n_groups; k++) {
+    concentrations.push_back(timeBins(n_steps,
+				      params.getDelayedFraction(k, 0) /
+				      params.getDecayConstant(k, 0)));
+  }
+
+  return std::make_shared<epke::EPKEOutput>(1,
+					    n_steps,
+					    params.getTime().toVector(),
+					    concentrations,
+					    timeBins(n_steps, 1.),
+					    timeBins(n_steps, 1.),
+					    timeBins(n_steps, 0.));
+}
+
+static void writeString(std::FILE* file, const std::string& s) {
+  std::fputc('"', file);
+  for (const char c : s) {
+    if (c == '"' || c == '\\') { std::fputc('\\', file); }
+    std::fputc(c, file);
+  }
+  std::fputc('"', file);
+}
+
+void bench::writeJSON(std::FILE* file, const std::vector<Result>& results) {
+  const std::time_t now = std::time(nullptr);
+  char timestamp[32];
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ",
+		std::gmtime(&now));
+
+#ifdef __OPTIMIZE__
+  const bool optimized = true;
+#else
+  const bool optimized = false;
+#endif
+
+  std::fprintf(file, "{\n  \"timestamp\": ");
+  writeString(file, timestamp);
+  std::fprintf(file, ",\n  \"compiler\": ");
+  writeString(file, __VERSION__);
+  std::fprintf(file, ",\n  \"optimized\": %s", optimized ? "true" : "false");
+  std::fprintf(file, ",\n  \"hardware_threads\": %u",
+	       std::thread::hardware_concurrency());
+  std::fprintf(file, ",\n  \"results\": [");
+
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+
+    std::fprintf(file, "%s\n    {\"suite\": ", i > 0 ? "," : "");
+    writeString(file, r.suite);
+    std::fprintf(file, ", \"name\": ");
+    writeString(file, r.name);
+    std::fprintf(file, ", \"params\": {");
+
+    bool first = true;
+    for (const auto& p : r.params) {
+      std::fprintf(file, "%s", first ? "" : ", ");
+      writeString(file, p.first);
+      std::fprintf(file, ": %.17g", p.second);
+      first = false;
+    }
+
+    std::fprintf(file, "}, \"repetitions\": %zu, \"min\": %.9g, "
+		 "\"median\": %.9g, \"mean\": %.9g",
+		 r.repetitions, r.min, r.median, r.mean);
+
+    if (r.items > 0.) {
+      std::fprintf(file, ", \"items\": %.17g, \"items_per_second\": %.9g, "
+		   "\"items_name\": ", r.items, r.items / r.median);
+      writeString(file, r.items_name);
+    }
+
+    std::fprintf(file, "}");
+  }
+
+  std::fprintf(file, "\n  ]\n}\n");
+}
+
+int main(int argc, char* argv[]) {
+  std::string filter;
+  std::string outpath;
+  bool quick = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--quick") == 0) {
+      quick = true;
+    } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outpath = argv[++i];
+    } else {
+      std::cerr << "usage: " << argv[0]
+		<< " [--quick] [--filter suite/name] [--out results.json]"
+		<< std::endl;
+      return 1;
+    }
+  }
+
+  Suite suite(filter, quick);
+
+  benchSolver(suite);
+  benchInterpolate(suite);
+  benchIO(suite);
+  benchParareal(suite);
+
+  std::FILE* file = outpath.empty() ? stdout : std::fopen(outpath.c_str(), "w");
+  if (!file) {
+    std::cerr << "Could not open " << outpath << " for writing" << std::endl;
+    return 1;
+  }
+
+  writeJSON(file, suite.getResults());
+
+  if (file != stdout) {
+    std::fclose(file);
+    std::cerr << "Wrote " << suite.getResults().size() << " results to "
+	      << outpath << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include "benchmark.hpp"
+
+#include "utility/interpolate.hpp"
+
+using namespace bench;
+
+void bench::benchInterpolate(Suite& suite) {
+  const std::vector<timeIndex> sizes = suite.isQuick() ?
+    std::vector<timeIndex>{100, 1000} : std::vector<timeIndex>{100, 1000, 10000};
+
+  for (const timeIndex n : sizes) {
+    for (const timeIndex refinement : {1, 20}) {
+      const timeIndex m = (n - 1) * refinement + 1;
+
+      const timeBins x_uniform = util::linspace(0., 1., n);
+      const timeBins x_new     = util::linspace(0., 1., m);
+
+      // the same number of points, clustered towards t = 0
+      timeBins x_graded(n);
+      for (timeIndex i = 0; i < n; i++) { x_graded[i] = std::pow(x_uniform[i], 2.); }
+
+      timeBins y(n);
+      for (timeIndex i = 0; i < n; i++) { y[i] = std::exp(x_uniform[i]); }
+
+      timeBins y_new;
+
+      suite.measure("interpolate", "uniform", {{"n", n}, {"m", m}}, m, "points",
+		    [&]() {
+		      y_new = util::interpolate(x_uniform, y, x_new);
+		      doNotOptimize(y_new.back());
+		    });
+
+      suite.measure("interpolate", "graded", {{"n", n}, {"m", m}}, m, "points",
+		    [&]() {
+		      y_new = util::interpolate(x_graded, y, x_new);
+		      doNotOptimize(y_new.back());
+		    });
+
+      // eight series sharing one lookup, as for the parameters of a refinement
+      const util::Interpolation interpolation(x_uniform, x_new);
+
+      suite.measure("interpolate", "batch_8", {{"n", n}, {"m", m}}, 8 * m,
+		    "points",
+		    [&]() {
+		      for (int s = 0; s < 8; s++) {
+			y_new = interpolation(y);
+			doNotOptimize(y_new.back());
+		      }
+		    });
+    }
+  }
+}
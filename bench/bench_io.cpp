@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <string>
+
+#include "benchmark.hpp"
+
+#include "pugi/pugixml.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/load_data.hpp"
+#include "utility/xml_writer.hpp"
+
+using namespace bench;
+
+// Writing and reading an output with six groups through xml and through the
+// binary container
+void bench::benchIO(Suite& suite) {
+  const std::vector<timeIndex> sizes = suite.isQuick() ?
+    std::vector<timeIndex>{1000, 10000} :
+    std::vector<timeIndex>{1000, 10000, 100000};
+
+  const std::string xml_path    = "bench_io.xml";
+  const std::string binary_path = "bench_io.epkb";
+
+  for (const timeIndex n_steps : sizes) {
+    auto params = makeParameters(6, n_steps);
+    auto output = makeInitial(*params);
+
+    // every series of the output holds n_steps values
+    const double n_values = n_steps * (4 + params->getNumPrecursors());
+
+    suite.measure("io", "xml_write", {{"steps", n_steps}}, n_values, "values",
+		  [&]() {
+		    util::XMLWriter writer(xml_path);
+		    output->writeToXML(writer);
+		    writer.finish();
+		  });
+
+    suite.measure("io", "xml_load", {{"steps", n_steps}}, n_values, "values",
+		  [&]() {
+		    pugi::xml_document doc;
+		    doc.load_file(xml_path.c_str());
+
+		    const pugi::xml_node node = doc.child("epke_output");
+		    for (const char* name : {"time", "power", "pow_norm", "rho"}) {
+		      doNotOptimize(util::loadVectorData(node.child(name), n_steps).back());
+		    }
+		    doNotOptimize(
+		      util::loadZetas(node.child("concentrations"), n_steps).back().back());
+		  });
+
+    suite.measure("io", "binary_write", {{"steps", n_steps}}, n_values, "values",
+		  [&]() {
+		    util::BinaryWriter writer(binary_path);
+		    output->writeToBinary(writer);
+		    writer.write();
+		  });
+
+    suite.measure("io", "binary_load", {{"steps", n_steps}}, n_values, "values",
+		  [&]() {
+		    util::BinaryFile file(binary_path);
+		    double sum = 0.;
+		    for (precIndex k = 0; k < params->getNumPrecursors(); k++) {
+		      for (const double v :
+			     file.get("concentration_" + std::to_string(k))) {
+			sum += v;
+		      }
+		    }
+		    doNotOptimize(sum);
+		  });
+  }
+
+  std::remove(xml_path.c_str());
+  std::remove(binary_path.c_str());
+}
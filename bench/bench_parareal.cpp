@@ -0,0 +1,124 @@
+#include <thread>
+
+#include "benchmark.hpp"
+
+#include "epke/solver.hpp"
+#include "parareal/mgrit.hpp"
+#include "parareal/parareal.hpp"
+
+using namespace bench;
+
+using GroupSolver = epke::FixedSolver<6>;
+using Propagator  = para::Parareal<GroupSolver, GroupSolver>;
+
+// Parareal over n_windows coarse steps, set up as Input::execute() does
+static std::unique_ptr<Propagator> makeParareal(const timeIndex n_windows,
+					      const timeIndex n_fine_per_coarse,
+					      const para::paraIndex n_threads,
+					      const para::paraIndex n_iterations,
+					      const bool asynchronous = false) {
+  auto coarse_params = makeParameters(6, n_windows + 1);
+
+  const timeIndex n_fine = n_windows * n_fine_per_coarse + 1;
+  auto fine_params = para::interpolate(coarse_params,
+				       util::linspace(0., 1., n_fine));
+
+  coarse_params->buildCoefficients();
+  fine_params->buildCoefficients();
+
+  auto coarse_solver = std::make_shared<GroupSolver>(coarse_params,
+						     makeInitial(*coarse_params));
+  auto fine_precomp  = makeInitial(*fine_params);
+  auto fine_solver   = std::make_shared<GroupSolver>(fine_params, fine_precomp);
+
+  return std::make_unique<Propagator>(coarse_solver, fine_solver, fine_precomp,
+				      n_fine_per_coarse, n_iterations, "",
+				      n_threads, 0., true, asynchronous);
+}
+
+static void benchSolve(Suite& suite,
+		       const std::string& name,
+		       const timeIndex n_windows,
+		       const timeIndex n_fine_per_coarse,
+		       const para::paraIndex n_threads,
+		       const para::paraIndex n_iterations,
+		       const bool asynchronous = false) {
+  std::unique_ptr<Propagator> parareal;
+
+  suite.measure("parareal", name,
+		{{"threads", n_threads}, {"windows", n_windows},
+		 {"n_fine_per_coarse", n_fine_per_coarse},
+		 {"iterations", n_iterations}},
+		n_iterations * n_windows * n_fine_per_coarse, "fine_steps",
+		[&]() { parareal = makeParareal(n_windows, n_fine_per_coarse,
+						n_threads, n_iterations,
+						asynchronous); },
+		[&]() { parareal->solve(); });
+}
+
+// MGRIT V-cycles on the fine grid of the same transient, FCF relaxation
+static void benchMGRIT(Suite& suite,
+		       const timeIndex n_windows,
+		       const timeIndex n_fine_per_coarse,
+		       const timeIndex coarsening,
+		       const para::paraIndex n_threads,
+		       const para::paraIndex n_iterations) {
+  const timeIndex n_fine = n_windows * n_fine_per_coarse + 1;
+
+  std::unique_ptr<para::MGRIT<GroupSolver>> mgrit;
+
+  suite.measure("parareal", "mgrit",
+		{{"threads", n_threads}, {"windows", n_windows},
+		 {"n_fine_per_coarse", n_fine_per_coarse},
+		 {"coarsening", coarsening}, {"iterations", n_iterations}},
+		n_iterations * (n_fine - 1), "fine_points",
+		[&]() {
+		  auto params = para::interpolate(makeParameters(6, n_windows + 1),
+						  util::linspace(0., 1., n_fine));
+		  params->buildCoefficients();
+		  mgrit = std::make_unique<para::MGRIT<GroupSolver>>(
+		    params, makeInitial(*params), coarsening, 0, 3, n_iterations,
+		    "", n_threads, 0.);
+		},
+		[&]() { mgrit->solve(); });
+}
+
+void bench::benchParareal(Suite& suite) {
+  const para::paraIndex max_threads =
+    std::max(1u, std::thread::hardware_concurrency());
+  const para::paraIndex n_iterations = 3;
+
+  std::vector<para::paraIndex> threads;
+  for (para::paraIndex t = 1; t < max_threads; t *= 2) { threads.push_back(t); }
+  threads.push_back(max_threads);
+
+  const timeIndex n_windows = suite.isQuick() ? 32 : 128;
+  const timeIndex n_fine    = suite.isQuick() ? 20 : 100;
+
+  // strong scaling: the same transient on more threads
+  for (const auto n_threads : threads) {
+    benchSolve(suite, "strong", n_windows, n_fine, n_threads, n_iterations);
+  }
+
+  // weak scaling: a fixed number of windows per thread
+  for (const auto n_threads : threads) {
+    benchSolve(suite, "weak", 8 * n_threads, n_fine, n_threads, n_iterations);
+  }
+
+  // task graph schedule of the strong scaling transient
+  for (const auto n_threads : threads) {
+    benchSolve(suite, "async", n_windows, n_fine, n_threads, n_iterations, true);
+  }
+
+  // multilevel cycles in place of the serial coarse sweeps
+  for (const auto n_threads : threads) {
+    benchMGRIT(suite, n_windows, n_fine, n_fine, n_threads, n_iterations);
+    benchMGRIT(suite, n_windows, n_fine, 8, n_threads, n_iterations);
+  }
+
+  // cost of the fine windows against their refinement
+  for (const timeIndex refinement : {10, 50, 200}) {
+    benchSolve(suite, "refinement", n_windows, refinement, max_threads,
+	       n_iterations);
+  }
+}
@@ -0,0 +1,60 @@
+#include "benchmark.hpp"
+
+#include "epke/mixed_solver.hpp"
+#include "epke/solver.hpp"
+
+using namespace bench;
+
+// Time steps per second of a full solve, against the number of groups
+template <typename Solver>
+static void benchSolve(Suite& suite,
+		       const std::string& name,
+		       epke::EPKEParameters::ptr params) {
+  const timeIndex n_steps  = params->getNumTimeSteps();
+  const precIndex n_groups = params->getNumPrecursors();
+
+  std::shared_ptr<Solver> solver;
+
+  suite.measure("solver", name,
+		{{"groups", n_groups}, {"steps", n_steps},
+		 {"cached_coefficients", params->hasCoefficients()}},
+		n_steps - 1, "steps",
+		[&]() { solver = std::make_shared<Solver>(params,
+							  makeInitial(*params)); },
+		[&]() { solver->solve(); });
+}
+
+void bench::benchSolver(Suite& suite) {
+  const timeIndex n_steps = suite.isQuick() ? 2001 : 20001;
+
+  for (const precIndex n_groups : {1, 2, 4, 6, 8, 12}) {
+    auto params = makeParameters(n_groups, n_steps);
+
+    benchSolve<epke::Solver>(suite, "solve", params);
+
+    // the same solve reading the tabulated coefficients
+    params->buildCoefficients();
+    benchSolve<epke::Solver>(suite, "solve", params);
+
+    // the cheaper coarse propagator of parareal
+    benchSolve<epke::PromptJumpSolver<0>>(suite, "solve_prompt_jump", params);
+
+    // the single precision coarse propagator
+    benchSolve<epke::MixedSolver<float, 0>>(suite, "solve_single", params);
+
+    if (n_groups == 6) {
+      benchSolve<epke::FixedSolver<6>>(suite, "solve_fixed", params);
+      benchSolve<epke::PromptJumpSolver<6>>(suite, "solve_prompt_jump_fixed",
+					    params);
+      benchSolve<epke::MixedSolver<float, 6>>(suite, "solve_single_fixed",
+					       params);
+    }
+    if (n_groups == 8) {
+      benchSolve<epke::FixedSolver<8>>(suite, "solve_fixed", params);
+      benchSolve<epke::PromptJumpSolver<8>>(suite, "solve_prompt_jump_fixed",
+					    params);
+      benchSolve<epke::MixedSolver<float, 8>>(suite, "solve_single_fixed",
+					       params);
+    }
+  }
+}
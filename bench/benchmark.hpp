@@ -0,0 +1,151 @@
+#ifndef _BENCH_BENCHMARK_HEADER_
+#define _BENCH_BENCHMARK_HEADER_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+
+namespace bench {
+
+using para::timeBins;
+using para::timeIndex;
+using para::precIndex;
+using para::precBins;
+
+// Timing of a benchmark over its repetitions, in seconds per run
+struct Result {
+  std::string suite;
+  std::string name;
+  std::map<std::string, double> params;
+  std::size_t repetitions;
+  double      min;
+  double      median;
+  double      mean;
+  double      items;      // work items per run, e.g. time steps
+  std::string items_name; // what the items are
+};
+
+// Runs the registered benchmarks and collects their results. Every run is
+// timed on its own with steady_clock after an untimed setup, and runs are
+// repeated until both the minimum count and the minimum time are reached.
+class Suite {
+private:
+  std::vector<Result> _results;
+  std::string         _filter;
+  double              _min_time;
+  std::size_t         _min_repetitions;
+
+public:
+  Suite(const std::string& filter, const bool quick)
+    : _filter(filter),
+      _min_time(quick ? 0.02 : 0.2),
+      _min_repetitions(quick ? 1 : 5) {}
+
+  const bool isQuick() const { return _min_repetitions == 1; }
+
+  const std::vector<Result>& getResults() const { return _results; }
+
+  // Time run() after each setup() and record it under suite/name
+  void measure(const std::string& suite,
+	       const std::string& name,
+	       const std::map<std::string, double>& params,
+	       const double items,
+	       const std::string& items_name,
+	       const std::function<void()>& setup,
+	       const std::function<void()>& run) {
+    const std::string id = suite + "/" + name;
+    if (id.find(_filter) == std::string::npos) { return; }
+
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> times;
+    double total = 0.;
+
+    // one untimed warm-up run
+    setup();
+    run();
+
+    while (times.size() < _min_repetitions || total < _min_time) {
+      setup();
+
+      const auto start = clock::now();
+      run();
+      const std::chrono::duration<double> duration = clock::now() - start;
+
+      times.push_back(duration.count());
+      total += times.back();
+    }
+
+    std::sort(times.begin(), times.end());
+
+    Result result = {suite, name, params, times.size(), times.front(),
+		     times[times.size() / 2], total / times.size(), items,
+		     items_name};
+    _results.push_back(result);
+
+    // progress on stderr, the results go to the json document
+    std::cerr << id;
+    for (const auto& p : params) { std::cerr << " " << p.first << "=" << p.second; }
+    std::cerr << ": " << result.median << " s";
+    if (items > 0.) {
+      std::cerr << " (" << items / result.median << " " << items_name << "/s)";
+    }
+    std::cerr << std::endl;
+  }
+
+  void measure(const std::string& suite,
+	       const std::string& name,
+	       const std::map<std::string, double>& params,
+	       const double items,
+	       const std::string& items_name,
+	       const std::function<void()>& run) {
+    measure(suite, name, params, items, items_name, []() {}, run);
+  }
+};
+
+// Sink for a result a benchmark never reads otherwise, so the compiler cannot
+// drop its computation
+inline void doNotOptimize(const double value) {
+  static volatile double sink;
+  sink = value;
+}
+
+// Write the results as a json document
+void writeJSON(std::FILE* file, const std::vector<Result>& results);
+
+// Synthetic transients, generated in code so the suite needs no input files
+
+// Decay constants and delayed fractions of n_groups groups. Six groups are
+// the standard U-235 set; other counts spread the same total delayed
+// fraction over geometrically spaced decay constants.
+void groupConstants(const precIndex n_groups, timeBins& lambda, timeBins& beta);
+
+// A reactivity step to 0.5 beta at t = 0.1 s with linear thermal feedback,
+// on a uniform grid of n_steps over [0, t_end]
+epke::EPKEParameters::ptr makeParameters(const precIndex n_groups,
+					 const timeIndex n_steps,
+					 const double t_end = 1.);
+
+// Critical initial conditions on the time grid of params
+epke::EPKEOutput::ptr makeInitial(const epke::EPKEParameters& params);
+
+// Suites, one per source file
+void benchSolver(Suite& suite);
+void benchInterpolate(Suite& suite);
+void benchIO(Suite& suite);
+void benchParareal(Suite& suite);
+
+} // namespace bench
+
+#endif
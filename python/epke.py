@@ -0,0 +1,187 @@
+"""In-process bindings of libepke, built with `make lib`.
+
+Inputs are passed to the solver as pointers to the given NumPy arrays, which
+are only copied when they are not contiguous float64 already. Solutions are
+NumPy views of the solver's own arrays, valid while their Output lives and
+until it is solved again.
+
+    params = epke.Parameters(time, decay_constants, delayed_fractions,
+                             rho_imp, gen_time, pow_norm, beta_eff, lambda_h)
+    output = epke.Output(params, power=[1.], pow_norm=[1.], rho=[0.],
+                         concentrations=[c0])
+    epke.solve_parareal(params, output, n_fine_per_coarse=20,
+                        max_iterations=4, n_threads=4)
+    output.power, output.concentrations[:, k]
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+_double_p = ctypes.POINTER(ctypes.c_double)
+
+
+def _load():
+    path = os.environ.get("EPKE_LIBRARY") or os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), "..", "libepke.so")
+    lib = ctypes.CDLL(path)
+
+    lib.epke_last_error.restype = ctypes.c_char_p
+
+    lib.epke_parameters_create.restype = ctypes.c_void_p
+    lib.epke_parameters_create.argtypes = (
+        [ctypes.c_size_t] * 2 + [_double_p] * 8 + [ctypes.c_double] * 3)
+    lib.epke_parameters_destroy.argtypes = [ctypes.c_void_p]
+
+    lib.epke_output_create.restype = ctypes.c_void_p
+    lib.epke_output_create.argtypes = (
+        [ctypes.c_void_p, ctypes.c_size_t] + [_double_p] * 4)
+    lib.epke_output_destroy.argtypes = [ctypes.c_void_p]
+
+    lib.epke_solve.argtypes = [ctypes.c_void_p] * 2
+    lib.epke_solve_parareal.argtypes = (
+        [ctypes.c_void_p] * 2 + [ctypes.c_size_t] * 3 +
+        [ctypes.c_double, ctypes.c_int])
+
+    for name in ["num_steps", "num_groups"]:
+        getattr(lib, "epke_output_" + name).restype = ctypes.c_size_t
+        getattr(lib, "epke_output_" + name).argtypes = [ctypes.c_void_p]
+
+    for name in ["time", "power", "pow_norm", "rho", "concentrations"]:
+        getattr(lib, "epke_output_" + name).restype = _double_p
+        getattr(lib, "epke_output_" + name).argtypes = [ctypes.c_void_p]
+
+    lib.epke_output_solve_time.restype = ctypes.c_double
+    lib.epke_output_solve_time.argtypes = [ctypes.c_void_p]
+
+    return lib
+
+
+_lib = _load()
+
+
+def _check(status):
+    if status != 0:
+        raise ValueError(_lib.epke_last_error().decode())
+
+
+def _handle(handle):
+    if not handle:
+        raise ValueError(_lib.epke_last_error().decode())
+    return handle
+
+
+def _array(values, shape):
+    """Contiguous float64 values of the given shape, scalars broadcast."""
+    return np.ascontiguousarray(np.broadcast_to(values, shape), dtype=np.float64)
+
+
+def _pointer(array):
+    return array.ctypes.data_as(_double_p)
+
+
+class Parameters:
+    """Parameters on a time grid. Each series is an array over the grid or a
+    single value, and the precursor data hold a row per group."""
+
+    def __init__(self, time, decay_constants, delayed_fractions, rho_imp,
+                 gen_time, pow_norm, beta_eff, lambda_h,
+                 theta=1.0, gamma_d=0.0, eta=1.0):
+        time = _array(time, np.shape(time))
+        n_steps = time.size
+        n_groups = np.shape(decay_constants)[0]
+
+        # a value per group is constant in time
+        rows = lambda values: np.reshape(values, (n_groups, -1))
+        series = [_array(rows(decay_constants), (n_groups, n_steps)),
+                  _array(rows(delayed_fractions), (n_groups, n_steps))]
+        series += [_array(values, (n_steps,))
+                   for values in [rho_imp, gen_time, pow_norm, beta_eff, lambda_h]]
+
+        self.n_steps = n_steps
+        self.n_groups = n_groups
+        self._handle = _handle(_lib.epke_parameters_create(
+            n_steps, n_groups, _pointer(time), *map(_pointer, series),
+            theta, gamma_d, eta))
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.epke_parameters_destroy(self._handle)
+
+
+class Output:
+    """Solution on the grid of params, from the values of its first steps
+    (the initial conditions) and their concentrations of every group."""
+
+    def __init__(self, params, power, pow_norm, rho, concentrations):
+        n_start = np.size(power)
+        arrays = [_array(power, (n_start,)),
+                  _array(pow_norm, (n_start,)),
+                  _array(rho, (n_start,)),
+                  _array(concentrations, (n_start, params.n_groups))]
+
+        self._handle = _handle(_lib.epke_output_create(
+            params._handle, n_start, *map(_pointer, arrays)))
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.epke_output_destroy(self._handle)
+
+    def _view(self, name, shape):
+        pointer = getattr(_lib, "epke_output_" + name)(self._handle)
+        buffer = (ctypes.c_double * int(np.prod(shape))).from_address(
+            ctypes.addressof(pointer.contents))
+        buffer._owner = self  # the view keeps the solution alive
+        return np.frombuffer(buffer, dtype=np.float64).reshape(shape)
+
+    @property
+    def n_steps(self):
+        return _lib.epke_output_num_steps(self._handle)
+
+    @property
+    def n_groups(self):
+        return _lib.epke_output_num_groups(self._handle)
+
+    @property
+    def time(self):
+        return self._view("time", (self.n_steps,))
+
+    @property
+    def power(self):
+        return self._view("power", (self.n_steps,))
+
+    @property
+    def pow_norm(self):
+        return self._view("pow_norm", (self.n_steps,))
+
+    @property
+    def rho(self):
+        return self._view("rho", (self.n_steps,))
+
+    @property
+    def concentrations(self):
+        """Concentrations of every step, a column per group."""
+        return self._view("concentrations", (self.n_steps, self.n_groups))
+
+    @property
+    def solve_time(self):
+        return _lib.epke_output_solve_time(self._handle)
+
+
+def solve(params, output):
+    """Solve the steps of output after its initial conditions."""
+    _check(_lib.epke_solve(params._handle, output._handle))
+
+
+def solve_parareal(params, output, n_fine_per_coarse, max_iterations,
+                   n_threads=1, tolerance=0., coarse="full"):
+    """Solve with parareal on the grid of params as the coarse grid. The
+    coarse propagator is "full" or "prompt_jump", and output then holds the
+    solution on the fine grid."""
+    if coarse not in ("full", "prompt_jump"):
+        raise ValueError("Unknown coarse propagator: " + coarse)
+
+    _check(_lib.epke_solve_parareal(
+        params._handle, output._handle, n_fine_per_coarse, max_iterations,
+        n_threads, tolerance, coarse == "prompt_jump"))
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "epke/adaptive_solver.hpp"
+#include "epke/solver.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/interpolate.hpp"
+#include "utility/time_major.hpp"
+#include "utility/xml_writer.hpp"
+
+using namespace epke;
+
+// Limits on the change of dt from one step to the next, and the margin
+// below the step the error estimate allows
+static constexpr double max_growth = 5.;
+static constexpr double max_shrink = 0.2;
+static constexpr double safety     = 0.9;
+
+// Order of the local error of the scheme
+static constexpr double error_order = 3.;
+
+AdaptiveSolver::AdaptiveSolver(const Params::ptr params,
+			       const Output::ptr initial,
+			       const Tolerances& tolerances,
+			       const std::string outpath,
+			       const timeBins& output_time)
+  : _outpath(outpath),
+    _params(params),
+    _initial(initial),
+    _tolerances(tolerances),
+    _output_time(output_time) {}
+
+const std::size_t AdaptiveSolver::getRowSize() const {
+  return 2 * _params->getNumPrecursors() + 5;
+}
+
+void AdaptiveSolver::sampleParameters(const double t, double* row) const {
+  const util::Series& grid   = _params->getTime();
+  const std::size_t   n_grid = grid.size();
+
+  // interval of the input grid holding t
+  std::size_t i = 0;
+
+  if (n_grid > 1) {
+    const std::size_t upper = std::upper_bound(grid.begin(), grid.end(), t) -
+      grid.begin();
+    i = std::min(upper > 0 ? upper - 1 : 0, n_grid - 2);
+  }
+
+  auto sample = [&](auto value) -> double {
+    if (n_grid == 1) { return value(0); }
+
+    const double ya = value(i), yb = value(i + 1);
+    return ya + ( yb - ya ) / ( grid[i+1] - grid[i] ) * ( t - grid[i] );
+  };
+
+  const precIndex n_groups = _params->getNumPrecursors();
+
+  for (precIndex k = 0; k < n_groups; k++) {
+    row[2 * k] =
+      sample([&](const timeIndex n) { return _params->getDecayConstant(k, n); });
+    row[2 * k + 1] =
+      sample([&](const timeIndex n) { return _params->getDelayedFraction(k, n); });
+  }
+
+  double* shared = row + 2 * n_groups;
+  shared[0] = sample([&](const timeIndex n) { return _params->getRhoImp(n); });
+  shared[1] = sample([&](const timeIndex n) { return _params->getGenTime(n); });
+  shared[2] = sample([&](const timeIndex n) { return _params->getPowNorm(n); });
+  shared[3] = sample([&](const timeIndex n) { return _params->getBetaEff(n); });
+  shared[4] = sample([&](const timeIndex n) { return _params->getLambdaH(n); });
+}
+
+AdaptiveSolver::Output::ptr
+AdaptiveSolver::trySteps(const timeBins& trial_time,
+			 const double* trial_parameters) const {
+  const timeIndex m        = _time.size();
+  const precIndex n_groups = _params->getNumPrecursors();
+  const std::size_t width  = getRowSize();
+
+  // A step reads the two previous steps, and t_0 for the reference
+  // generation time and initial power, so only those are carried along
+  std::vector<timeIndex> history = {0};
+  if (m > 2) { history.push_back(m - 2); }
+  if (m > 1) { history.push_back(m - 1); }
+
+  timeBins time;
+  for (const auto n : history) { time.push_back(_time[n]); }
+  time.insert(time.end(), trial_time.begin(), trial_time.end());
+
+  const timeIndex n_history = history.size();
+  const timeIndex n_steps   = time.size();
+
+  timeBins power(n_steps, 0.), pow_norm(n_steps, 0.), rho(n_steps, 0.);
+  timeBins concentrations(n_steps * n_groups, 0.);
+  timeBins rows(n_steps * width);
+
+  for (timeIndex i = 0; i < n_history; i++) {
+    const timeIndex n = history[i];
+
+    power[i]    = _power[n];
+    pow_norm[i] = _pow_norm[n];
+    rho[i]      = _rho[n];
+    std::copy_n(_concentrations.data() + n * n_groups, n_groups,
+		concentrations.data() + i * n_groups);
+    std::copy_n(_parameters.data() + n * width, width, rows.data() + i * width);
+  }
+
+  std::copy_n(trial_parameters, trial_time.size() * width,
+	      rows.data() + n_history * width);
+
+  auto trial = std::make_shared<Output>(n_history,
+					n_steps,
+					time,
+					n_groups,
+					concentrations,
+					power,
+					pow_norm,
+					rho);
+
+  auto column = [&](const std::size_t c) {
+    timeBins values(n_steps);
+    for (timeIndex i = 0; i < n_steps; i++) { values[i] = rows[i * width + c]; }
+    return values;
+  };
+
+  precBins<Precursor::ptr> precursors;
+  for (precIndex k = 0; k < n_groups; k++) {
+    precursors.push_back(std::make_shared<Precursor>(column(2 * k),
+						     column(2 * k + 1)));
+  }
+
+  const std::size_t shared = 2 * n_groups;
+
+  Solver solver(std::make_shared<Params>(time,
+					 precursors,
+					 column(shared),
+					 column(shared + 1),
+					 column(shared + 2),
+					 column(shared + 3),
+					 column(shared + 4),
+					 _params->getTheta(),
+					 _params->getGammaD(),
+					 _params->getEta()),
+		trial);
+  solver.solve();
+
+  return trial;
+}
+
+const double AdaptiveSolver::computeError(const Output::ptr coarse,
+					  const Output::ptr fine) const {
+  const timeIndex n_coarse = coarse->getNumTimeSteps() - 1;
+  const timeIndex n_fine   = fine->getNumTimeSteps() - 1;
+
+  auto scaled = [this](const double a, const double b) {
+    const double scale = _tolerances.atol +
+      _tolerances.rtol * std::max(std::fabs(a), std::fabs(b));
+    return a == b ? 0. : std::fabs(a - b) / scale;
+  };
+
+  double error = scaled(coarse->getPower(n_coarse), fine->getPower(n_fine));
+
+  for (precIndex k = 0; k < _params->getNumPrecursors(); k++) {
+    error = std::max(error, scaled(coarse->getConcentration(k, n_coarse),
+				   fine->getConcentration(k, n_fine)));
+  }
+
+  return error;
+}
+
+void AdaptiveSolver::accept(const Output::ptr trial, const timeIndex n_trial) {
+  const precIndex n_groups = _params->getNumPrecursors();
+
+  for (timeIndex n = trial->getNumTimeSteps() - n_trial;
+       n < trial->getNumTimeSteps(); n++) {
+    _time.push_back(trial->getTime(n));
+    _power.push_back(trial->getPower(n));
+    _pow_norm.push_back(trial->getPowNorm(n));
+    _rho.push_back(trial->getRho(n));
+
+    const double* conc = trial->getConcentrationsAt(n);
+    _concentrations.insert(_concentrations.end(), conc, conc + n_groups);
+  }
+}
+
+void AdaptiveSolver::solve() {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  const precIndex n_groups = _params->getNumPrecursors();
+  const timeIndex n_start  = _initial->getStartTimeIndex();
+  const timeIndex n_stop   = _initial->getStopTimeIndex();
+
+  // the initial history is kept on the input grid
+  _time.clear(); _power.clear(); _pow_norm.clear(); _rho.clear();
+  _concentrations.clear(); _parameters.clear();
+  _n_rejected = 0;
+
+  const std::size_t width = getRowSize();
+
+  for (timeIndex n = 0; n < n_start; n++) {
+    _time.push_back(_params->getTime(n));
+    _power.push_back(_initial->getPower(n));
+    _pow_norm.push_back(_initial->getPowNorm(n));
+    _rho.push_back(_initial->getRho(n));
+
+    const double* conc = _initial->getConcentrationsAt(n);
+    _concentrations.insert(_concentrations.end(), conc, conc + n_groups);
+
+    _parameters.resize(_parameters.size() + width);
+    sampleParameters(_time.back(), _parameters.data() + n * width);
+  }
+
+  // parameters at the two trial times of a step, which both trials share
+  timeBins trial_parameters(2 * width);
+
+  const double t_end = _params->getTime(n_stop - 1);
+
+  auto limit = [this](double dt) {
+    if (_tolerances.dt_max > 0.) { dt = std::min(dt, _tolerances.dt_max); }
+    return std::max(dt, _tolerances.dt_min);
+  };
+
+  double dt = limit(_tolerances.dt_initial > 0. ? _tolerances.dt_initial :
+		    _params->computeDT(std::min(n_start, n_stop - 1)));
+
+  while (_time.back() < t_end) {
+    const double t = _time.back();
+
+    // steps at the lower bound are kept whatever their error
+    const bool at_dt_min = dt <= _tolerances.dt_min;
+
+    // finish on t_end instead of leaving a sliver of a step
+    const double t_next = t_end - (t + dt) < 0.1 * dt ? t_end : t + dt;
+    const double h      = t_next - t;
+
+    if (h <= std::numeric_limits<double>::epsilon() * std::max(1., std::fabs(t))) {
+      throw std::runtime_error("Adaptive time step underflow at t = " +
+			       std::to_string(t));
+    }
+
+    sampleParameters(t + 0.5 * h, trial_parameters.data());
+    sampleParameters(t_next, trial_parameters.data() + width);
+
+    const Output::ptr coarse = trySteps({t_next}, trial_parameters.data() + width);
+    const Output::ptr fine   = trySteps({t + 0.5 * h, t_next}, trial_parameters.data());
+
+    const double error = computeError(coarse, fine);
+
+    // keep the two half steps, the more accurate of the two solutions
+    if (error <= 1. || at_dt_min) {
+      accept(fine, 2);
+      _parameters.insert(_parameters.end(), trial_parameters.begin(),
+			 trial_parameters.end());
+    } else {
+      _n_rejected++;
+    }
+
+    double factor = std::isnan(error) ? max_shrink :
+      error > 0. ? safety * std::pow(error, -1. / error_order) : max_growth;
+    factor = std::min(max_growth, std::max(max_shrink, factor));
+
+    dt = limit(h * factor);
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> duration = stop - start;
+  _solve_time = duration.count();
+}
+
+AdaptiveSolver::Output::ptr AdaptiveSolver::getOutput() const {
+  auto output = std::make_shared<Output>(_initial->getStartTimeIndex(),
+					 _time.size(),
+					 _time,
+					 _params->getNumPrecursors(),
+					 _concentrations,
+					 _power,
+					 _pow_norm,
+					 _rho);
+  output->setSolveTime(_solve_time);
+
+  return output;
+}
+
+AdaptiveSolver::Output::ptr
+AdaptiveSolver::getOutput(const timeBins& time) const {
+  const precIndex n_groups = _params->getNumPrecursors();
+  const util::Interpolation interpolate(_time, time);
+
+  precBins<timeBins> concentrations;
+
+  for (precIndex k = 0; k < n_groups; k++) {
+    concentrations.push_back(interpolate(
+      util::StridedView(_concentrations.data() + k, n_groups, _time.size())));
+  }
+
+  // the requested times up to the end of the initial history are not solved
+  const timeIndex n_start = std::max<timeIndex>(1,
+    std::upper_bound(time.begin(), time.end(),
+		     _time[_initial->getStartTimeIndex() - 1]) - time.begin());
+
+  auto output = std::make_shared<Output>(n_start,
+					 time.size(),
+					 time,
+					 concentrations,
+					 interpolate(_power),
+					 interpolate(_pow_norm),
+					 interpolate(_rho));
+  output->setSolveTime(_solve_time);
+
+  return output;
+}
+
+void AdaptiveSolver::writeToXML() const {
+  util::XMLWriter writer(_outpath);
+
+  writer.open("adaptive");
+  writer.attribute("solve_time", _solve_time);
+  writer.attribute("n_steps", _time.size());
+  writer.attribute("n_rejected", _n_rejected);
+  writer.attribute("rtol", _tolerances.rtol);
+  writer.attribute("atol", _tolerances.atol);
+
+  if (_output_time.empty()) {
+    getOutput()->writeToXML(writer);
+  } else {
+    getOutput(_output_time)->writeToXML(writer);
+
+    // the grid the solution was interpolated from
+    writer.element("adaptive_time", _time);
+  }
+
+  writer.close();
+  writer.finish();
+}
+
+void AdaptiveSolver::writeToBinary() const {
+  util::BinaryWriter writer(_outpath);
+
+  // the writer reads from the output when it writes
+  const Output::ptr output = _output_time.empty() ? getOutput() :
+    getOutput(_output_time);
+
+  output->writeToBinary(writer);
+
+  writer.add("n_rejected", static_cast<double>(_n_rejected));
+  if (!_output_time.empty()) { writer.add("adaptive_time", _time); }
+
+  writer.write();
+}
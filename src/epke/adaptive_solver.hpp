@@ -0,0 +1,116 @@
+#ifndef _EPKE_ADAPTIVE_SOLVER_HEADER_
+#define _EPKE_ADAPTIVE_SOLVER_HEADER_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+
+namespace epke {
+
+  // Solves the epke on a time grid chosen as the transient evolves. Every
+  // step is taken once with dt and once as two steps of dt / 2, and the
+  // difference of the two estimates the local error. The step is kept when
+  // the error is within the tolerances, and the next dt is scaled from it.
+  // Kept steps store the two half steps, so the solution is exactly what
+  // the scheme produces on the adaptive grid. The parameters are linearly
+  // interpolated from the input grid to the adaptive times.
+  class AdaptiveSolver {
+  public:
+    template <typename T>
+    using precBins  = para::precBins<T>;
+    using timeBins  = para::timeBins;
+    using timeIndex = para::timeIndex;
+    using precIndex = para::precIndex;
+    using ptr       = std::shared_ptr<AdaptiveSolver>;
+    using Output    = epke::EPKEOutput;
+    using Params    = epke::EPKEParameters;
+
+    struct Tolerances {
+      double rtol       = 1e-4; // relative error per step
+      double atol       = 0.;   // absolute error per step
+      double dt_min     = 0.;   // steps this small are kept regardless
+      double dt_max     = 0.;   // 0 leaves dt unbounded
+      double dt_initial = 0.;   // 0 starts from the first input step
+    };
+
+  private:
+    std::string _outpath;
+
+    // Parameters on the input grid and the initial conditions
+    Params::ptr _params;
+    Output::ptr _initial;
+
+    const Tolerances _tolerances;
+
+    // Times to interpolate the written solution to (empty keeps the grid)
+    const timeBins _output_time;
+
+    // Solution on the adaptive grid, concentrations time-major
+    timeBins _time;
+    timeBins _power;
+    timeBins _pow_norm;
+    timeBins _rho;
+    timeBins _concentrations;
+
+    // Parameters at each time of the adaptive grid, one row per time, so
+    // the trials of later steps read them instead of sampling them again
+    timeBins _parameters;
+
+    timeIndex _n_rejected = 0;
+    double    _solve_time = 0.;
+
+    // Length of a row of parameters: the decay constant and delayed
+    // fraction of each group, then rho_imp, gen_time, pow_norm, beta_eff
+    // and lambda_h
+    const std::size_t getRowSize() const;
+
+    // Row of parameters at time t, interpolated from the input grid
+    void sampleParameters(const double t, double* row) const;
+
+    // Take steps to each of the trial times from the last kept step, with
+    // the parameter rows of the trial times. Returns the solution on
+    // {t_0, the two latest kept times, trial times}.
+    Output::ptr trySteps(const timeBins& trial_time,
+			 const double* trial_parameters) const;
+
+    // Largest scaled difference of the final states of two trials
+    const double computeError(Output::ptr coarse, Output::ptr fine) const;
+
+    // Keep the trial steps of a solution returned by trySteps
+    void accept(Output::ptr trial, const timeIndex n_trial);
+
+  public:
+    AdaptiveSolver(Params::ptr parameters,
+		   Output::ptr initial,
+		   const Tolerances& tolerances,
+		   std::string outpath,
+		   const timeBins& output_time = {});
+
+    const std::string getOutpath() const { return _outpath; }
+
+    const timeIndex getNumTimeSteps() const { return _time.size(); }
+
+    const timeIndex getNumRejected() const { return _n_rejected; }
+
+    // Solve from the end of the initial history to its final time
+    void solve();
+
+    // Solution on the adaptive grid
+    Output::ptr getOutput() const;
+
+    // Solution linearly interpolated to the given times
+    Output::ptr getOutput(const timeBins& time) const;
+
+    // Stream the solution to an xml document at outpath
+    void writeToXML() const;
+
+    // Write the solution to a binary container at outpath
+    void writeToBinary() const;
+  }; // class AdaptiveSolver
+} // namespace epke
+
+#endif
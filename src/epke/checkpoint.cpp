@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include "epke/checkpoint.hpp"
+
+epke::Checkpoint::Checkpoint(const std::string& path) : _file(path) {
+  _n_steps    = _file.get("params_time").size();
+  _n_start    = _file.get("n_start")[0];
+  _state_size = _file.get("state_size")[0];
+
+  for (const double step : _file.get("checkpoint_steps")) {
+    _steps.push_back(step);
+  }
+}
+
+const double* epke::Checkpoint::getStates(const std::size_t i) const {
+  return _file.get("checkpoint_states").begin() + 2 * i * _state_size;
+}
+
+void epke::Checkpoint::write(const std::string& path,
+			     const EPKEParameters& params,
+			     const EPKEOutput& solution,
+			     const timeIndex interval,
+			     const Checkpoint* previous) {
+  const timeIndex   n_steps    = solution.getNumTimeSteps();
+  const timeIndex   n_offset   = solution.getTimeOffset();
+  const std::size_t state_size = solution.getStateSize();
+
+  // a resumed solution no longer stores its initial conditions
+  const timeIndex n_start = previous ? previous->_n_start :
+    solution.getStartTimeIndex();
+
+  timeBins initial_states(n_start * state_size);
+  if (previous) {
+    const auto saved = previous->_file.get("initial_states");
+    std::copy(saved.begin(), saved.end(), initial_states.begin());
+  } else {
+    for (timeIndex n = 0; n < n_start; n++) {
+      solution.packState(n, initial_states.data() + n * state_size);
+    }
+  }
+
+  // the states before each checkpoint, from the solution when it holds them
+  // and otherwise from the previous checkpoints
+  timeBins steps, states;
+
+  for (timeIndex c = interval; interval > 0 && c < n_steps; c += interval) {
+    if (c < 2 || c <= n_start) { continue; }
+
+    const std::size_t i = states.size();
+
+    if (c - 2 >= n_offset) {
+      states.resize(i + 2 * state_size);
+      solution.packState(c - 2, states.data() + i);
+      solution.packState(c - 1, states.data() + i + state_size);
+    } else if (previous) {
+      const auto& saved = previous->_steps;
+      const auto it = std::find(saved.begin(), saved.end(), c);
+      if (it == saved.end()) { continue; }
+
+      const double* saved_states = previous->getStates(it - saved.begin());
+      states.insert(states.end(), saved_states, saved_states + 2 * state_size);
+    } else {
+      continue;
+    }
+
+    steps.push_back(c);
+  }
+
+  util::BinaryWriter writer(path);
+
+  params.writeToBinary(writer, "params_");
+  writer.add("params_theta", params.getTheta());
+  writer.add("params_gamma_d", params.getGammaD());
+  writer.add("params_eta", params.getEta());
+
+  writer.add("n_start", n_start);
+  writer.add("state_size", state_size);
+  writer.add("initial_power", solution.getInitialPower());
+  writer.add("initial_states", initial_states);
+  writer.add("checkpoint_steps", steps);
+  writer.add("checkpoint_states", states);
+
+  writer.write();
+}
+
+const para::timeIndex
+epke::Checkpoint::findFirstChange(const EPKEParameters& params,
+				  const EPKEOutput& initial) const {
+  const precIndex n_groups = params.getNumPrecursors();
+
+  // another grid, scheme or set of groups changes every step
+  if (params.getNumTimeSteps() != _n_steps ||
+      static_cast<std::size_t>(n_groups) + 3 != _state_size ||
+      params.getTheta() != _file.get("params_theta")[0] ||
+      params.getGammaD() != _file.get("params_gamma_d")[0] ||
+      params.getEta() != _file.get("params_eta")[0]) {
+    return 0;
+  }
+
+  // as do other initial conditions
+  if (initial.getStartTimeIndex() != _n_start ||
+      initial.getStateSize() != _state_size) {
+    return 0;
+  }
+
+  const auto initial_states = _file.get("initial_states");
+  timeBins state(_state_size);
+
+  for (timeIndex n = 0; n < _n_start; n++) {
+    initial.packState(n, state.data());
+    if (!std::equal(state.begin(), state.end(),
+		    initial_states.begin() + n * _state_size)) {
+      return 0;
+    }
+  }
+
+  const auto time     = _file.get("params_time", _n_steps);
+  const auto rho_imp  = _file.get("params_rho_imp", _n_steps);
+  const auto gen_time = _file.get("params_gen_time", _n_steps);
+  const auto pow_norm = _file.get("params_pow_norm", _n_steps);
+  const auto beta_eff = _file.get("params_beta_eff", _n_steps);
+  const auto lambda_h = _file.get("params_lambda_h", _n_steps);
+
+  std::vector<util::ArrayView> lambda, beta;
+  for (precIndex k = 0; k < n_groups; k++) {
+    const std::string group = std::to_string(k);
+    lambda.push_back(_file.get("params_decay_constant_" + group, _n_steps));
+    beta.push_back(_file.get("params_delayed_fraction_" + group, _n_steps));
+  }
+
+  // step n only reads the parameters up to n
+  for (timeIndex n = 0; n < _n_steps; n++) {
+    bool same = time[n] == params.getTime(n) &&
+      rho_imp[n] == params.getRhoImp(n) &&
+      gen_time[n] == params.getGenTime(n) &&
+      pow_norm[n] == params.getPowNorm(n) &&
+      beta_eff[n] == params.getBetaEff(n) &&
+      lambda_h[n] == params.getLambdaH(n);
+
+    for (precIndex k = 0; k < n_groups && same; k++) {
+      same = lambda[k][n] == params.getDecayConstant(k, n) &&
+	beta[k][n] == params.getDelayedFraction(k, n);
+    }
+
+    if (!same) { return n; }
+  }
+
+  return _n_steps;
+}
+
+epke::EPKEOutput::ptr
+epke::Checkpoint::createRestart(const EPKEParameters& params,
+				const EPKEOutput& initial,
+				const timeIndex n) const {
+  // the checkpoints are in increasing order of their steps
+  std::size_t i = _steps.size();
+  while (i > 0 && _steps[i-1] > n) { i--; }
+
+  if (i == 0 || _steps[i-1] >= initial.getStopTimeIndex()) { return nullptr; }
+
+  const timeIndex c        = _steps[i-1];
+  const timeIndex n_offset = c - 2;
+  const timeIndex n_steps  = params.getNumTimeSteps() - n_offset;
+  const precIndex n_groups = params.getNumPrecursors();
+
+  timeBins time(n_steps);
+  for (timeIndex j = 0; j < n_steps; j++) { time[j] = params.getTime(n_offset + j); }
+
+  auto restart = std::make_shared<EPKEOutput>(c,
+					      initial.getStopTimeIndex(),
+					      time,
+					      n_groups,
+					      timeBins(n_steps * n_groups, 0.),
+					      timeBins(n_steps, 0.),
+					      timeBins(n_steps, 0.),
+					      timeBins(n_steps, 0.),
+					      n_offset);
+
+  const double* states = getStates(i-1);
+  restart->unpackState(c - 2, states);
+  restart->unpackState(c - 1, states + _state_size);
+  restart->setInitialPower(_file.get("initial_power")[0]);
+
+  return restart;
+}
@@ -0,0 +1,69 @@
+#ifndef _EPKE_CHECKPOINT_HEADER_
+#define _EPKE_CHECKPOINT_HEADER_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "utility/binary_io.hpp"
+
+namespace epke {
+
+  // Solver states saved every few steps of a solve, in a binary container
+  // with the parameters and initial conditions the solve ran on. Step n of
+  // the solver only reads the parameters up to n, the states at n-1 and n-2
+  // and the values at t = 0, so a solve whose inputs first differ at n can
+  // resume from any checkpoint up to n and reproduce the full solve exactly.
+  class Checkpoint {
+  public:
+    using timeBins  = para::timeBins;
+    using timeIndex = para::timeIndex;
+    using precIndex = para::precIndex;
+    using ptr       = std::shared_ptr<Checkpoint>;
+
+  private:
+    util::BinaryFile _file;
+
+    timeIndex   _n_steps;
+    timeIndex   _n_start; // number of initial conditions
+    std::size_t _state_size;
+
+    // The step each checkpoint resumes at, holding the states before it
+    std::vector<timeIndex> _steps;
+
+    // States at n-2 and n-1 of checkpoint i
+    const double* getStates(const std::size_t i) const;
+
+  public:
+    Checkpoint(const std::string& path);
+
+    // Save the checkpoints every interval steps of a solution, which may
+    // start past t = 0 when it was resumed from previous. Every value is
+    // copied before the file is written, so path may be the file of previous.
+    static void write(const std::string& path,
+		      const EPKEParameters& params,
+		      const EPKEOutput& solution,
+		      const timeIndex interval,
+		      const Checkpoint* previous = nullptr);
+
+    const std::vector<timeIndex>& getSteps() const { return _steps; }
+
+    // First time index at which the parameters or the initial conditions
+    // differ from the saved ones, the number of steps when none do
+    const timeIndex findFirstChange(const EPKEParameters& params,
+				    const EPKEOutput& initial) const;
+
+    // Output resuming at the last checkpoint at or before step n, holding
+    // the two steps before it, or null when there is none past the initial
+    // conditions
+    EPKEOutput::ptr createRestart(const EPKEParameters& params,
+				  const EPKEOutput& initial,
+				  const timeIndex n) const;
+  }; // class Checkpoint
+
+} // namespace epke
+
+#endif
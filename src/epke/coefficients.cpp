@@ -0,0 +1,87 @@
+#include "epke/coefficients.hpp"
+#include "epke/parameters.hpp"
+
+#include "utility/interpolate.hpp"
+
+epke::Coefficients::Entry
+epke::Coefficients::compute(const double lambda,
+			    const double delta_t,
+			    const double gamma) {
+  using util::E, util::k0, util::omegaN, util::omegaN1, util::omegaN2;
+
+  return {E(lambda, delta_t),
+	  k0(lambda, delta_t),
+	  omegaN(lambda, delta_t, gamma),
+	  omegaN1(lambda, delta_t, gamma),
+	  omegaN2(lambda, delta_t, gamma)};
+}
+
+epke::Coefficients::Coefficients(const EPKEParameters& params)
+  : _n_channels(params.getNumPrecursors() + 1), _collapsed(true) {
+  const timeIndex n_steps = params.getNumTimeSteps();
+
+  // window parameters store two steps of history before the first step
+  // whose dt and gamma they hold
+  _n_first = params.getTimeOffset() == 0 ? 0 : params.getTimeOffset() + 2;
+
+  auto lambda = [&](const precIndex c, const timeIndex n) {
+    return c < params.getNumPrecursors() ?
+      params.getDecayConstant(c, n) : params.getLambdaH(n);
+  };
+
+  // Every step of an evenly spaced grid has its spacing, though differences
+  // of its points round differently from step to step. Other grids collapse
+  // only when dt matches exactly: k1 and k2 amplify rounding differences in
+  // dt by 1 / (lambda * dt)^2 for the slow groups.
+  const bool   uniform = params.getTime().isUniform();
+  const double dt = uniform ? params.getTime().getDelta() : params.computeDT(_n_first);
+
+  // the first step of a window also needs a gamma of one
+  if (_n_first >= 2 && !uniform) {
+    _collapsed = params.computeDT(_n_first - 1) == dt;
+  }
+
+  // constant lambdas are only compared when stored per step
+  const bool constant = params.hasConstantDecay();
+
+  for (timeIndex n = _n_first + 1; n < n_steps && _collapsed; n++) {
+    _collapsed = uniform || params.computeDT(n) == dt;
+
+    for (precIndex c = 0; c < _n_channels && _collapsed && !constant; c++) {
+      _collapsed = lambda(c, n) == lambda(c, _n_first);
+    }
+  }
+
+  const timeIndex n_tabulated = _collapsed ? 1 : n_steps - _n_first;
+  _entries.reserve(n_tabulated * _n_channels);
+
+  // every channel of a step shares dt and gamma, so they go through the
+  // batched kernel together
+  std::vector<double> lambdas(_n_channels);
+  std::vector<double> weights(7 * _n_channels);
+  double* w = weights.data();
+  const util::ExponentialWeights out = {w,
+					w + _n_channels,
+					w + 2 * _n_channels,
+					w + 3 * _n_channels,
+					w + 4 * _n_channels,
+					w + 5 * _n_channels,
+					w + 6 * _n_channels};
+
+  for (timeIndex n = _n_first; n < _n_first + n_tabulated; n++) {
+    const double dt_n  = _collapsed ? dt  : params.computeDT(n);
+    const double gamma = _collapsed ? 1.0 : params.computeGamma(n);
+
+    for (precIndex c = 0; c < _n_channels; c++) { lambdas[c] = lambda(c, n); }
+
+    util::exponentialWeights(lambdas.data(), _n_channels, dt_n, gamma, out);
+
+    for (precIndex c = 0; c < _n_channels; c++) {
+      _entries.push_back({out.E[c],
+			  out.k0[c],
+			  out.omega_n[c],
+			  out.omega_n1[c],
+			  out.omega_n2[c]});
+    }
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef _EPKE_COEFFICIENTS_HEADER_
+#define _EPKE_COEFFICIENTS_HEADER_
+
+#include <memory>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+
+namespace epke {
+
+  class EPKEParameters;
+
+  // Table of the exponential integration coefficients used by every step of
+  // the solver. There is one channel per precursor group, with the heat
+  // conduction (lambda_h) channel last. The coefficients only depend on the
+  // parameters and the time grid, so they are built once and shared by every
+  // solve that uses the same parameters.
+  class Coefficients {
+  public:
+    using timeIndex = para::timeIndex;
+    using precIndex = para::precIndex;
+    using ptr       = std::shared_ptr<const Coefficients>;
+
+    struct Entry {
+      double E;        // exp(-lambda * dt)
+      double k0;       // 1 - E
+      double omega_n;  // weight of the value at n
+      double omega_n1; // weight of the value at n-1
+      double omega_n2; // weight of the value at n-2
+    };
+
+  private:
+    // Number of channels (precursor groups plus heat conduction)
+    const precIndex _n_channels;
+
+    // Single entry per channel when dt and every lambda are constant in time
+    bool _collapsed;
+
+    // First tabulated step, past the history of window parameters
+    timeIndex _n_first;
+
+    // Entries stored step-major: [n * _n_channels + c]
+    std::vector<Entry> _entries;
+
+  public:
+    Coefficients(const EPKEParameters& params);
+
+    // Evaluate the coefficients of a single channel
+    static Entry compute(const double lambda,
+			 const double delta_t,
+			 const double gamma);
+
+    const precIndex getNumChannels() const { return _n_channels; }
+
+    const bool isCollapsed() const { return _collapsed; }
+
+    // First step with coefficients, the only one stored when collapsed
+    const timeIndex getFirstStep() const { return _n_first; }
+
+    // Index of the heat conduction channel
+    const precIndex getHeatChannel() const { return _n_channels - 1; }
+
+    const Entry& get(const precIndex c, const timeIndex n) const {
+      return _entries[(_collapsed ? 0 : n - _n_first) * _n_channels + c];
+    }
+  }; // class Coefficients
+
+} // namespace epke
+
+#endif
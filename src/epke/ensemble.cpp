@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "epke/ensemble.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/interpolate.hpp"
+#include "utility/xml_writer.hpp"
+
+using namespace epke;
+
+Ensemble::Ensemble(const Params::ptr params,
+		   const Output::ptr initial,
+		   const std::vector<Perturbation>& perturbations,
+		   const std::string outpath)
+  : _outpath(outpath),
+    _params(params),
+    _initial(initial),
+    _perturbations(perturbations),
+    _n_scenarios(perturbations.size()) {
+  const timeIndex n_steps = initial->getNumTimeSteps();
+  const precIndex n_groups = params->getNumPrecursors();
+
+  _power.resize(n_steps * _n_scenarios);
+  _rho.resize(n_steps * _n_scenarios);
+  _concentrations.resize(n_steps * n_groups * _n_scenarios);
+
+  // every scenario starts from the same history
+  for (timeIndex n = 0; n < n_steps; n++) {
+    for (std::size_t s = 0; s < _n_scenarios; s++) {
+      _power[index(n, s)] = initial->getPower(n);
+      _rho[index(n, s)]   = initial->getRho(n);
+
+      for (precIndex k = 0; k < n_groups; k++) {
+	_concentrations[index(n, k, s)] = initial->getConcentration(k, n);
+      }
+    }
+  }
+
+  _alpha.resize(_n_scenarios);
+  _a1.resize(_n_scenarios);
+  _b1.resize(_n_scenarios);
+  _tau.resize(_n_scenarios);
+  _s_hat_d.resize(_n_scenarios);
+  _s_d_prev.resize(_n_scenarios);
+  _omega.resize(n_groups * _n_scenarios);
+  _zeta_hat.resize(n_groups * _n_scenarios);
+}
+
+std::vector<Ensemble::Perturbation>
+Ensemble::loadPerturbations(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+  if (!file) {
+    throw std::runtime_error("Could not open perturbation set " + path);
+  }
+
+  const std::size_t n_bytes = file.tellg();
+  const std::size_t record  = n_perturbation_fields * sizeof(double);
+
+  if (n_bytes % record != 0) {
+    throw std::runtime_error("Perturbation set " + path +
+			     " is not a whole number of " +
+			     std::to_string(n_perturbation_fields) + "-double records");
+  }
+
+  std::vector<double> data(n_bytes / sizeof(double));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(data.data()), n_bytes);
+
+  std::vector<Perturbation> perturbations(n_bytes / record);
+
+  for (std::size_t s = 0; s < perturbations.size(); s++) {
+    const double* fields = data.data() + s * n_perturbation_fields;
+    perturbations[s] = {fields[0], fields[1], fields[2], fields[3]};
+  }
+
+  return perturbations;
+}
+
+const Coefficients::Entry Ensemble::getCoefficients(const precIndex c,
+						    const timeIndex n) const {
+  if (_params->hasCoefficients()) {
+    return _params->getCoefficients().get(c, n);
+  }
+
+  const auto lambda = c < _params->getNumPrecursors() ?
+    _params->getDecayConstant(c,n) : _params->getLambdaH(n);
+
+  return Coefficients::compute(lambda, _params->computeDT(n),
+			       _params->computeGamma(n));
+}
+
+void Ensemble::step(const timeIndex n) {
+  // The expressions follow epke::Solver term by term, so a scenario with unit
+  // factors reproduces the scalar solver exactly
+  const std::size_t S = _n_scenarios;
+  const precIndex   G = _params->getNumPrecursors();
+  const Perturbation* pert = _perturbations.data();
+
+  const double dt    = _params->computeDT(n);
+  const double theta = _params->getTheta();
+  const double eta   = _params->getEta();
+
+  const double gen_time_0 = _params->getGenTime(0);
+  const double gen_time   = _params->getGenTime(n);
+  const double gen_time_1 = _params->getGenTime(n-1);
+  const double gen_time_2 = n < 2 ? gen_time_0 : _params->getGenTime(n-2);
+
+  const double* power_1 = _power.data() + index(n-1, 0);
+  const double* power_2 = n < 2 ? nullptr : _power.data() + index(n-2, 0);
+  const double* rho_1   = _rho.data() + index(n-1, 0);
+
+  // compute the transformation parameter
+  if (n > 1) {
+    const double dt_prev = _params->computeDT(n-1);
+    for (std::size_t s = 0; s < S; s++) {
+      _alpha[s] = 1 / dt_prev * log(power_1[s] / power_2[s]);
+    }
+  } else {
+    std::fill(_alpha.begin(), _alpha.end(), 0.);
+  }
+
+  std::fill(_tau.begin(), _tau.end(), 0.);
+  std::fill(_s_hat_d.begin(), _s_hat_d.end(), 0.);
+  std::fill(_s_d_prev.begin(), _s_d_prev.end(), 0.);
+
+  // per-group terms and the weighted sums of the power equation
+  for (precIndex j = 0; j < G; j++) {
+    const auto coeff  = getCoefficients(j, n);
+    const double lj   = _params->getDecayConstant(j, n);
+    const double lj_1 = _params->getDecayConstant(j, n-1);
+    const double b    = _params->getDelayedFraction(j, n);
+    const double b_1  = _params->getDelayedFraction(j, n-1);
+    const double b_2  = n < 2 ? 0. : _params->getDelayedFraction(j, n-2);
+
+    const double* conc_prev = _concentrations.data() + index(n-1, j, 0);
+    double* omega    = _omega.data() + j * S;
+    double* zeta_hat = _zeta_hat.data() + j * S;
+
+    for (std::size_t s = 0; s < S; s++) {
+      const double gt0 = pert[s].gen_time * gen_time_0;
+      const double pp  = n < 2 ? 0. : power_2[s];
+
+      omega[s] = gt0 / (pert[s].gen_time * gen_time) *
+	(pert[s].beta_eff * b) / lj * coeff.omega_n;
+
+      zeta_hat[s] = coeff.E * conc_prev[s] +
+	1. / lj * gt0 * power_1[s] * (pert[s].beta_eff * b_1) /
+	(pert[s].gen_time * gen_time_1) * coeff.omega_n1 +
+	1. / lj * gt0 * pp * (pert[s].beta_eff * b_2) /
+	(pert[s].gen_time * gen_time_2) * coeff.omega_n2;
+
+      _tau[s]      += lj * omega[s];
+      _s_hat_d[s]  += lj * zeta_hat[s];
+      _s_d_prev[s] += lj_1 * conc_prev[s];
+    }
+  }
+
+  // feedback coefficients
+  {
+    const auto coeff    = getCoefficients(G, n);
+    const double lh     = _params->getLambdaH(n);
+    const double gd     = _params->getGammaD();
+    const double norm   = _params->getPowNorm(n);
+    const double norm_1 = _params->getPowNorm(n-1);
+    const double norm_2 = n < 2 ? 0. : _params->getPowNorm(n-2);
+    const double imp    = _params->getRhoImp(n);
+    const double imp_1  = _params->getRhoImp(n-1);
+    const double power_0 = _initial->getInitialPower();
+
+    for (std::size_t s = 0; s < S; s++) {
+      const double gamma_d = pert[s].gamma_d * gd;
+      const double H_pp    = n < 2 ? 0. : norm_2 * power_2[s];
+
+      _a1[s] = gamma_d * norm / lh * coeff.omega_n;
+
+      _b1[s] = pert[s].rho_imp * imp + coeff.E * (rho_1[s] -
+						  pert[s].rho_imp * imp_1) -
+	1. / lh * power_0 * gamma_d * eta * coeff.k0 +
+	gamma_d / lh * (norm_1 * power_1[s] * coeff.omega_n1 +
+			H_pp * coeff.omega_n2);
+    }
+  }
+
+  // evaluate the power and update the state of every scenario
+  const double beta_eff   = _params->getBetaEff(n);
+  const double beta_eff_1 = _params->getBetaEff(n-1);
+
+  double* power = _power.data() + index(n, 0);
+  double* rho   = _rho.data() + index(n, 0);
+  bool valid = true;
+
+  for (std::size_t s = 0; s < S; s++) {
+    const double gt   = pert[s].gen_time * gen_time;
+    const double gt0  = pert[s].gen_time * gen_time_0;
+    const double gt_1 = pert[s].gen_time * gen_time_1;
+
+    const double a = theta * dt * _a1[s] / gt;
+    const double b = theta * dt * (((_b1[s] - pert[s].beta_eff * beta_eff)
+				    / gt - _alpha[s]) +
+				   _tau[s] / gt0) - 1;
+    const double c = theta * dt / gt0 * _s_hat_d[s] +
+      exp(_alpha[s] * dt) * ((1 - theta) * dt *
+			     (((rho_1[s] - pert[s].beta_eff * beta_eff_1) /
+			       gt_1 - _alpha[s]) * power_1[s] +
+			      _s_d_prev[s] / gt0) + power_1[s]);
+
+    valid = valid && a <= 0;
+    power[s] = a >= 0 ? -c / b : util::powerRoot(a, b, c);
+    rho[s]   = _a1[s] * power[s] + _b1[s];
+  }
+
+  if (!valid) {
+    throw std::runtime_error(
+      "Positive leading coefficient in the power equation at step " +
+      std::to_string(n));
+  }
+
+  for (precIndex j = 0; j < G; j++) {
+    const double* omega    = _omega.data() + j * S;
+    const double* zeta_hat = _zeta_hat.data() + j * S;
+    double* conc = _concentrations.data() + index(n, j, 0);
+
+    for (std::size_t s = 0; s < S; s++) {
+      conc[s] = power[s] * omega[s] + zeta_hat[s];
+    }
+  }
+}
+
+void Ensemble::solve() {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for (timeIndex n = _initial->getStartTimeIndex();
+       n < _initial->getStopTimeIndex(); n++) {
+    step(n);
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> duration = stop - start;
+  _solve_time = duration.count();
+}
+
+Ensemble::Output::ptr Ensemble::getOutput(const std::size_t s) const {
+  const timeIndex n_steps  = _initial->getNumTimeSteps();
+  const precIndex n_groups = _params->getNumPrecursors();
+
+  timeBins power(n_steps), pow_norm(_initial->getPowNorm()), rho(n_steps);
+  timeBins concentrations(n_steps * n_groups);
+
+  for (timeIndex n = 0; n < n_steps; n++) {
+    power[n] = _power[index(n, s)];
+    rho[n]   = _rho[index(n, s)];
+
+    for (precIndex k = 0; k < n_groups; k++) {
+      concentrations[n * n_groups + k] = _concentrations[index(n, k, s)];
+    }
+  }
+
+  for (timeIndex n = _initial->getStartTimeIndex();
+       n < _initial->getStopTimeIndex(); n++) {
+    pow_norm[n] = _params->getPowNorm(n);
+  }
+
+  timeBins time(n_steps);
+  for (timeIndex n = 0; n < n_steps; n++) {
+    time[n] = n < _initial->getStartTimeIndex() ||
+      n >= _initial->getStopTimeIndex() ?
+      _initial->getTime(n) : _params->getTime(n);
+  }
+
+  auto output = std::make_shared<Output>(_initial->getStartTimeIndex(),
+					 _initial->getStopTimeIndex(),
+					 time,
+					 n_groups,
+					 concentrations,
+					 power,
+					 pow_norm,
+					 rho);
+  output->setSolveTime(_solve_time);
+
+  return output;
+}
+
+std::vector<Ensemble::Output::ptr> Ensemble::getOutputs() const {
+  std::vector<Output::ptr> outputs;
+  outputs.reserve(_n_scenarios);
+
+  for (std::size_t s = 0; s < _n_scenarios; s++) {
+    outputs.push_back(getOutput(s));
+  }
+
+  return outputs;
+}
+
+void Ensemble::writeToXML() const {
+  util::XMLWriter writer(_outpath);
+
+  writer.open("ensemble");
+  writer.attribute("n_scenarios", _n_scenarios);
+  writer.attribute("solve_time", _solve_time);
+
+  // one scenario is copied out of the lanes at a time
+  for (std::size_t s = 0; s < _n_scenarios; s++) {
+    writer.open("scenario");
+    writer.attribute("index", s);
+    writer.attribute("rho_imp", _perturbations[s].rho_imp);
+    writer.attribute("gamma_d", _perturbations[s].gamma_d);
+    writer.attribute("beta_eff", _perturbations[s].beta_eff);
+    writer.attribute("gen_time", _perturbations[s].gen_time);
+
+    getOutput(s)->writeToXML(writer);
+    writer.close();
+  }
+
+  writer.close();
+  writer.finish();
+}
+
+void Ensemble::writeToBinary() const {
+  util::BinaryWriter writer(_outpath);
+
+  // the writer reads from the outputs when it writes
+  const std::vector<Output::ptr> outputs = getOutputs();
+
+  writer.add("solve_time", _solve_time);
+
+  for (std::size_t s = 0; s < _n_scenarios; s++) {
+    const std::string prefix = "scenario_" + std::to_string(s) + "/";
+
+    writer.add(prefix + "rho_imp", _perturbations[s].rho_imp);
+    writer.add(prefix + "gamma_d", _perturbations[s].gamma_d);
+    writer.add(prefix + "beta_eff", _perturbations[s].beta_eff);
+    writer.add(prefix + "gen_time", _perturbations[s].gen_time);
+
+    outputs[s]->writeToBinary(writer, prefix);
+  }
+
+  writer.write();
+}
@@ -0,0 +1,110 @@
+#ifndef _EPKE_ENSEMBLE_HEADER_
+#define _EPKE_ENSEMBLE_HEADER_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+#include "epke/coefficients.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+
+namespace epke {
+
+  // Solves many variants of one transient that share the time grid, the
+  // decay constants and the precomputed history. Every scenario scales the
+  // base parameters by its own perturbation, and all scenarios are advanced
+  // together one time step at a time. The state is stored scenario-innermost
+  // so the per-step loops run over contiguous lanes of scenarios.
+  class Ensemble {
+  public:
+    using timeBins  = para::timeBins;
+    using timeIndex = para::timeIndex;
+    using precIndex = para::precIndex;
+    using ptr       = std::shared_ptr<Ensemble>;
+    using Output    = epke::EPKEOutput;
+    using Params    = epke::EPKEParameters;
+
+    // Multiplicative factors applied to the base parameters. The beta_eff
+    // factor scales the delayed fractions of every group as well.
+    struct Perturbation {
+      double rho_imp  = 1.;
+      double gamma_d  = 1.;
+      double beta_eff = 1.;
+      double gen_time = 1.;
+    };
+
+    // Number of doubles per scenario in a binary perturbation set
+    static constexpr std::size_t n_perturbation_fields = 4;
+
+  private:
+    std::string _outpath;
+
+    // Shared parameters and initial conditions
+    Params::ptr _params;
+    Output::ptr _initial;
+
+    std::vector<Perturbation> _perturbations;
+    const std::size_t _n_scenarios;
+
+    // Scenario-innermost state: [n * S + s] and [(n * G + k) * S + s]
+    timeBins _power;
+    timeBins _rho;
+    timeBins _concentrations;
+
+    // Scratch lanes for the current step
+    timeBins _alpha, _a1, _b1;
+    timeBins _omega, _zeta_hat; // [k * S + s]
+    timeBins _tau, _s_hat_d, _s_d_prev;
+
+    double _solve_time = 0.;
+
+    // private methods
+    const Coefficients::Entry getCoefficients(const precIndex c,
+					      const timeIndex n) const;
+
+    const std::size_t index(const timeIndex n, const std::size_t s) const {
+      return n * _n_scenarios + s;
+    }
+
+    const std::size_t index(const timeIndex n,
+			    const precIndex k,
+			    const std::size_t s) const {
+      return (n * _params->getNumPrecursors() + k) * _n_scenarios + s;
+    }
+
+  public:
+    Ensemble(Params::ptr parameters,
+	     Output::ptr initial,
+	     const std::vector<Perturbation>& perturbations,
+	     std::string outpath);
+
+    // Read a perturbation set stored as consecutive records of
+    // rho_imp, gamma_d, beta_eff and gen_time factors in native doubles
+    static std::vector<Perturbation> loadPerturbations(const std::string& path);
+
+    const std::size_t getNumScenarios() const { return _n_scenarios; }
+
+    const std::string getOutpath() const { return _outpath; }
+
+    // Advance every scenario one time step
+    void step(const timeIndex n);
+
+    // Solve every scenario over the time window of the initial conditions
+    void solve();
+
+    // Copy the solution of each scenario out of the lanes
+    Output::ptr getOutput(const std::size_t s) const;
+
+    std::vector<Output::ptr> getOutputs() const;
+
+    // Stream every scenario to an xml document at outpath
+    void writeToXML() const;
+
+    // Write every scenario to a binary container, under scenario_<s>/ names
+    void writeToBinary() const;
+  }; // class Ensemble
+} // namespace epke
+
+#endif
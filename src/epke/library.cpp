@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "epke/library.hpp"
+#include "epke/output.hpp"
+#include "epke/parameters.hpp"
+#include "epke/precursor.hpp"
+#include "epke/solver.hpp"
+#include "parareal/parareal.hpp"
+#include "utility/series.hpp"
+
+using namespace para;
+
+struct epke_parameters {
+  epke::EPKEParameters::ptr params;
+};
+
+struct epke_output {
+  epke::EPKEOutput::ptr solution;
+};
+
+static thread_local std::string last_error;
+
+// Run a call of the interface, turning exceptions into its error status
+template <typename Call>
+static int guard(Call call) {
+  try {
+    call();
+    return 0;
+  } catch (const std::exception& error) {
+    last_error = error.what();
+    return 1;
+  } catch (...) {
+    last_error = "Unknown error";
+    return 1;
+  }
+}
+
+static void require(const bool condition, const char* message) {
+  if (!condition) { throw std::invalid_argument(message); }
+}
+
+// Steps of params with the coefficients tabulated when they were created
+template <typename Solver>
+static void runSolver(epke::EPKEParameters::ptr params,
+		      epke::EPKEOutput::ptr solution) {
+  using timer = std::chrono::steady_clock;
+  const timer::time_point clock_start = timer::now();
+
+  Solver solver(params, solution);
+  solver.solve();
+
+  const std::chrono::duration<double> duration = timer::now() - clock_start;
+  solution->setSolveTime(duration.count());
+}
+
+template <typename Coarse, typename Fine>
+static epke::EPKEOutput::ptr runParareal(epke::EPKEParameters::ptr params,
+					 const epke::EPKEOutput& initial,
+					 const timeIndex n_fine_per_coarse,
+					 const paraIndex max_iterations,
+					 const paraIndex n_threads,
+					 const double    tolerance) {
+  const timeIndex n_fine =
+    (params->getNumTimeSteps() - 1) * n_fine_per_coarse + 1;
+  const util::Series fine_time =
+    util::Series::uniform(0., params->getTime().back(), n_fine);
+
+  auto fine_params = para::interpolate(params, fine_time);
+  fine_params->buildCoefficients();
+
+  auto coarse_precomp = std::make_shared<epke::EPKEOutput>(initial);
+  auto fine_precomp   = std::make_shared<epke::EPKEOutput>(initial);
+  fine_precomp->resize(n_fine);
+
+  para::Parareal<Coarse, Fine> parareal(
+	   std::make_shared<Coarse>(params, coarse_precomp),
+	   std::make_shared<Fine>(fine_params, fine_precomp),
+	   fine_precomp,
+	   n_fine_per_coarse,
+	   max_iterations,
+	   "",
+	   n_threads,
+	   tolerance);
+
+  parareal.solve();
+  return parareal.getSolution();
+}
+
+// Dispatch to the solvers specialized on the number of precursor groups, as
+// epke-run does
+template <typename Fine, typename PromptJump>
+static epke::EPKEOutput::ptr runParareal(epke::EPKEParameters::ptr params,
+					 const epke::EPKEOutput& initial,
+					 const timeIndex n_fine_per_coarse,
+					 const paraIndex max_iterations,
+					 const paraIndex n_threads,
+					 const double    tolerance,
+					 const bool      prompt_jump) {
+  return prompt_jump ?
+    runParareal<PromptJump, Fine>(params, initial, n_fine_per_coarse,
+				  max_iterations, n_threads, tolerance) :
+    runParareal<Fine, Fine>(params, initial, n_fine_per_coarse,
+			    max_iterations, n_threads, tolerance);
+}
+
+extern "C" {
+
+const char* epke_last_error(void) { return last_error.c_str(); }
+
+epke_parameters* epke_parameters_create(const size_t  n_steps,
+					const size_t  n_groups,
+					const double* time,
+					const double* decay_constants,
+					const double* delayed_fractions,
+					const double* rho_imp,
+					const double* gen_time,
+					const double* pow_norm,
+					const double* beta_eff,
+					const double* lambda_h,
+					const double  theta,
+					const double  gamma_d,
+					const double  eta) {
+  epke_parameters* handle = nullptr;
+
+  guard([&]() {
+    require(n_steps >= 2, "The time grid needs at least two points");
+    require(n_groups >= 1 && n_groups <= 255, "Between 1 and 255 precursor groups are supported");
+    require(time && decay_constants && delayed_fractions && rho_imp &&
+	    gen_time && pow_norm && beta_eff && lambda_h, "Every array is required");
+
+    // series are stored compactly, as when they are read from a container
+    auto series = [n_steps](const double* values) {
+      return util::Series::compact(timeBins(values, values + n_steps));
+    };
+
+    precBins<epke::Precursor::ptr> precursors;
+    for (size_t k = 0; k < n_groups; k++) {
+      precursors.push_back(std::make_shared<epke::Precursor>(
+	series(decay_constants + k * n_steps),
+	series(delayed_fractions + k * n_steps)));
+    }
+
+    auto created = std::make_shared<epke::EPKEParameters>(
+      series(time), precursors, series(rho_imp), series(gen_time),
+      series(pow_norm), series(beta_eff), series(lambda_h),
+      theta, gamma_d, eta);
+
+    // tabulated here, since solves on other threads share the handle
+    created->buildCoefficients();
+    handle = new epke_parameters{created};
+  });
+
+  return handle;
+}
+
+void epke_parameters_destroy(epke_parameters* params) { delete params; }
+
+epke_output* epke_output_create(const epke_parameters* params,
+				const size_t           n_start,
+				const double*          power,
+				const double*          pow_norm,
+				const double*          rho,
+				const double*          concentrations) {
+  epke_output* handle = nullptr;
+
+  guard([&]() {
+    require(params, "The parameters are required");
+    require(power && pow_norm && rho && concentrations, "Every array is required");
+
+    const timeIndex n_steps  = params->params->getNumTimeSteps();
+    const precIndex n_groups = params->params->getNumPrecursors();
+    require(n_start >= 1 && n_start <= n_steps,
+	    "The initial conditions need between one and n_steps values");
+
+    // steps past the initial conditions are zero until they are solved
+    auto history = [n_steps, n_start](const double* values, const size_t size) {
+      timeBins bins(n_steps * size, 0.);
+      std::copy(values, values + n_start * size, bins.begin());
+      return bins;
+    };
+
+    handle = new epke_output{std::make_shared<epke::EPKEOutput>(
+      n_start, n_steps, params->params->getTime().toVector(), n_groups,
+      history(concentrations, n_groups), history(power, 1),
+      history(pow_norm, 1), history(rho, 1))};
+  });
+
+  return handle;
+}
+
+void epke_output_destroy(epke_output* output) { delete output; }
+
+int epke_solve(const epke_parameters* params, epke_output* output) {
+  return guard([&]() {
+    require(params && output, "The parameters and output are required");
+    require(output->solution->getNumTimeSteps() == params->params->getNumTimeSteps() &&
+	    output->solution->getNumPrecursors() == params->params->getNumPrecursors(),
+	    "The output is not on the grid of the parameters");
+
+    switch (params->params->getNumPrecursors()) {
+    case 6:  runSolver<epke::FixedSolver<6>>(params->params, output->solution); break;
+    case 8:  runSolver<epke::FixedSolver<8>>(params->params, output->solution); break;
+    default: runSolver<epke::Solver>(params->params, output->solution);
+    }
+  });
+}
+
+int epke_solve_parareal(const epke_parameters* params,
+			epke_output*           output,
+			const size_t           n_fine_per_coarse,
+			const size_t           max_iterations,
+			const size_t           n_threads,
+			const double           tolerance,
+			const int              prompt_jump) {
+  return guard([&]() {
+    require(params && output, "The parameters and output are required");
+    require(output->solution->getNumTimeSteps() == params->params->getNumTimeSteps() &&
+	    output->solution->getNumPrecursors() == params->params->getNumPrecursors(),
+	    "The output is not on the grid of the parameters");
+    require(n_fine_per_coarse >= 1, "n_fine_per_coarse must be at least 1");
+    require(max_iterations <= 255, "At most 255 parareal iterations are supported");
+    require(n_threads >= 1 && n_threads <= 65535, "Between 1 and 65535 threads are supported");
+
+    const auto& initial = *output->solution;
+
+    switch (params->params->getNumPrecursors()) {
+    case 6:
+      output->solution =
+	runParareal<epke::FixedSolver<6>, epke::PromptJumpSolver<6>>(
+	  params->params, initial, n_fine_per_coarse, max_iterations, n_threads,
+	  tolerance, prompt_jump);
+      break;
+    case 8:
+      output->solution =
+	runParareal<epke::FixedSolver<8>, epke::PromptJumpSolver<8>>(
+	  params->params, initial, n_fine_per_coarse, max_iterations, n_threads,
+	  tolerance, prompt_jump);
+      break;
+    default:
+      output->solution =
+	runParareal<epke::Solver, epke::PromptJumpSolver<0>>(
+	  params->params, initial, n_fine_per_coarse, max_iterations, n_threads,
+	  tolerance, prompt_jump);
+    }
+  });
+}
+
+size_t epke_output_num_steps(const epke_output* output) {
+  return output->solution->getNumTimeSteps();
+}
+
+size_t epke_output_num_groups(const epke_output* output) {
+  return output->solution->getNumPrecursors();
+}
+
+const double* epke_output_time(const epke_output* output) {
+  return output->solution->getTime().data();
+}
+
+const double* epke_output_power(const epke_output* output) {
+  return output->solution->getPower().data();
+}
+
+const double* epke_output_pow_norm(const epke_output* output) {
+  return output->solution->getPowNorm().data();
+}
+
+const double* epke_output_rho(const epke_output* output) {
+  return output->solution->getRho().data();
+}
+
+const double* epke_output_concentrations(const epke_output* output) {
+  return output->solution->getConcentrationsAt(0);
+}
+
+double epke_output_solve_time(const epke_output* output) {
+  return output->solution->getSolveTime();
+}
+
+} // extern "C"
@@ -0,0 +1,83 @@
+#ifndef _EPKE_LIBRARY_HEADER_
+#define _EPKE_LIBRARY_HEADER_
+
+#include <stddef.h>
+
+// C interface of libepke, for programs and scripting languages that run the
+// solver in process instead of writing inputs for epke-run. Arrays are
+// passed as pointers to contiguous doubles: the inputs are read during the
+// call, and the arrays of a solution stay valid until the next solve of the
+// output or its destruction. Concentrations are time-major, the groups of
+// each step next to each other. Functions returning int give 0 on success
+// and set the message of epke_last_error() otherwise.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct epke_parameters epke_parameters;
+typedef struct epke_output     epke_output;
+
+// Message of the last failed call on this thread
+const char* epke_last_error(void);
+
+// Parameters on a time grid of n_steps points. decay_constants and
+// delayed_fractions hold n_groups rows of n_steps values.
+epke_parameters* epke_parameters_create(size_t        n_steps,
+					size_t        n_groups,
+					const double* time,
+					const double* decay_constants,
+					const double* delayed_fractions,
+					const double* rho_imp,
+					const double* gen_time,
+					const double* pow_norm,
+					const double* beta_eff,
+					const double* lambda_h,
+					double        theta,
+					double        gamma_d,
+					double        eta);
+
+void epke_parameters_destroy(epke_parameters* params);
+
+// Solution on the grid of params, given its first n_start values (the
+// initial conditions) with n_start * n_groups time-major concentrations
+epke_output* epke_output_create(const epke_parameters* params,
+				size_t                 n_start,
+				const double*          power,
+				const double*          pow_norm,
+				const double*          rho,
+				const double*          concentrations);
+
+void epke_output_destroy(epke_output* output);
+
+// Solve the steps of output after its initial conditions
+int epke_solve(const epke_parameters* params, epke_output* output);
+
+// Solve with parareal on the grid of params as the coarse grid, with
+// n_fine_per_coarse fine steps per coarse step. The coarse propagator steps
+// like the fine one, or with the prompt jump approximation when prompt_jump
+// is nonzero. The output then holds the solution on the fine grid, or on
+// the coarse grid when max_iterations is 0.
+int epke_solve_parareal(const epke_parameters* params,
+			epke_output*           output,
+			size_t                 n_fine_per_coarse,
+			size_t                 max_iterations,
+			size_t                 n_threads,
+			double                 tolerance,
+			int                    prompt_jump);
+
+// Views of the solution
+size_t        epke_output_num_steps(const epke_output* output);
+size_t        epke_output_num_groups(const epke_output* output);
+const double* epke_output_time(const epke_output* output);
+const double* epke_output_power(const epke_output* output);
+const double* epke_output_pow_norm(const epke_output* output);
+const double* epke_output_rho(const epke_output* output);
+const double* epke_output_concentrations(const epke_output* output);
+double        epke_output_solve_time(const epke_output* output);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
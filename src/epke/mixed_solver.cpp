@@ -0,0 +1,257 @@
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "epke/mixed_solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace epke;
+
+template <typename Scalar, para::precIndex G>
+struct MixedSolver<Scalar, G>::Tables {
+  struct Entry {
+    Scalar E, k0, omega_n, omega_n1, omega_n2;
+  };
+
+  timeIndex n_offset;
+  precIndex n_groups;
+
+  Scalar theta, gamma_d, eta;
+  Scalar gen_time_0;
+
+  // Values of every stored step, from n_offset
+  std::vector<Scalar> dt, rho_imp, gen_time, pow_norm, beta_eff, lambda_h;
+
+  // Group values stored time-major, with a zero stride when constant
+  precIndex decay_stride, fraction_stride;
+  std::vector<Scalar> decay_constants, delayed_fractions;
+
+  // Coefficients of every channel stored step-major from n_first, or of
+  // n_first alone when collapsed
+  timeIndex n_first;
+  bool collapsed;
+  std::vector<Entry> coefficients;
+
+  const Scalar* getDecayConstantsAt(const timeIndex n) const {
+    return decay_constants.data() + (n - n_offset) * decay_stride;
+  }
+
+  const Scalar* getDelayedFractionsAt(const timeIndex n) const {
+    return delayed_fractions.data() + (n - n_offset) * fraction_stride;
+  }
+
+  const Entry& getCoefficients(const precIndex c, const timeIndex n) const {
+    return coefficients[(collapsed ? 0 : n - n_first) * (n_groups + 1) + c];
+  }
+};
+
+template <typename Scalar, para::precIndex G>
+std::shared_ptr<const typename MixedSolver<Scalar, G>::Tables>
+MixedSolver<Scalar, G>::buildTables(const Params& params) {
+  auto tables = std::make_shared<Tables>();
+
+  const timeIndex n_offset = params.getTimeOffset();
+  const timeIndex n_steps  = params.getNumTimeSteps();
+  const precIndex n_groups = params.getNumPrecursors();
+
+  tables->n_offset   = n_offset;
+  tables->n_groups   = n_groups;
+  tables->theta      = params.getTheta();
+  tables->gamma_d    = params.getGammaD();
+  tables->eta        = params.getEta();
+  tables->gen_time_0 = params.getInitialGenTime();
+
+  for (timeIndex n = n_offset; n < n_steps; n++) {
+    // the first step of window parameters is history and never stepped
+    tables->dt.push_back(n > n_offset ? params.computeDT(n) : 0.);
+    tables->rho_imp.push_back(params.getRhoImp(n));
+    tables->gen_time.push_back(params.getGenTime(n));
+    tables->pow_norm.push_back(params.getPowNorm(n));
+    tables->beta_eff.push_back(params.getBetaEff(n));
+    tables->lambda_h.push_back(params.getLambdaH(n));
+  }
+
+  // constant group values are stored once, like in the parameters
+  const bool single_step = n_steps - n_offset < 2;
+  const bool constant_decay = single_step ||
+    params.getDecayConstantsAt(n_offset) == params.getDecayConstantsAt(n_offset + 1);
+  const bool constant_fraction = single_step ||
+    params.getDelayedFractionsAt(n_offset) == params.getDelayedFractionsAt(n_offset + 1);
+
+  tables->decay_stride    = constant_decay    ? 0 : n_groups;
+  tables->fraction_stride = constant_fraction ? 0 : n_groups;
+
+  for (timeIndex n = n_offset; n < (constant_decay ? n_offset + 1 : n_steps); n++) {
+    const double* lambda = params.getDecayConstantsAt(n);
+    tables->decay_constants.insert(tables->decay_constants.end(),
+				   lambda, lambda + n_groups);
+  }
+
+  for (timeIndex n = n_offset; n < (constant_fraction ? n_offset + 1 : n_steps); n++) {
+    const double* beta = params.getDelayedFractionsAt(n);
+    tables->delayed_fractions.insert(tables->delayed_fractions.end(),
+				     beta, beta + n_groups);
+  }
+
+  // round the double table of the parameters, building one if they have none
+  std::shared_ptr<const Coefficients> built;
+  if (!params.hasCoefficients()) { built = std::make_shared<const Coefficients>(params); }
+  const Coefficients& coefficients = built ? *built : params.getCoefficients();
+
+  tables->n_first   = coefficients.getFirstStep();
+  tables->collapsed = coefficients.isCollapsed();
+
+  const timeIndex n_last = tables->collapsed ? tables->n_first + 1 : n_steps;
+  for (timeIndex n = tables->n_first; n < n_last; n++) {
+    for (precIndex c = 0; c <= n_groups; c++) {
+      const Coefficients::Entry& entry = coefficients.get(c, n);
+      tables->coefficients.push_back({static_cast<Scalar>(entry.E),
+				      static_cast<Scalar>(entry.k0),
+				      static_cast<Scalar>(entry.omega_n),
+				      static_cast<Scalar>(entry.omega_n1),
+				      static_cast<Scalar>(entry.omega_n2)});
+    }
+  }
+
+  return tables;
+}
+
+template <typename Scalar, para::precIndex G>
+MixedSolver<Scalar, G>::MixedSolver(const Params::ptr parameters,
+				    const Output::ptr solution)
+  : Solver(parameters, solution),
+    _tables(buildTables(*parameters)),
+    _omega(parameters->getNumPrecursors(), 0.),
+    _delta(parameters->getNumPrecursors(), 0.) {}
+
+// The steps of Solver::stepGroups with every term evaluated in Scalar, and
+// the concentrations and reactivity advanced by their increments
+template <typename Scalar, para::precIndex G>
+void MixedSolver<Scalar, G>::step(const timeIndex n) {
+  const Tables& tables = *_tables;
+  Output& solution = *getSolution();
+
+  const precIndex n_groups = G > 0 ? G : tables.n_groups;
+  const timeIndex i = n - tables.n_offset;
+
+  // fixed group counts keep the scratch on the stack
+  std::array<Scalar, G> omega_fixed, delta_fixed;
+  Scalar* omega = G > 0 ? omega_fixed.data() : _omega.data();
+  Scalar* delta = G > 0 ? delta_fixed.data() : _delta.data();
+
+  // the state of the earlier steps, rounded to Scalar
+  const Scalar power_prev      = solution.getPower(n-1);
+  const Scalar power_prev_prev = n < 2 ? 0. : solution.getPower(n-2);
+  const Scalar rho_prev        = solution.getRho(n-1);
+  const double* conc_prev      = solution.getConcentrationsAt(n-1);
+
+  // compute the transformation parameter
+  const Scalar alpha = n > 1 ?
+    1 / tables.dt[i-1] * std::log(power_prev / power_prev_prev) : 0.;
+
+  // group terms
+  const Scalar gen_time_0         = tables.gen_time_0;
+  const Scalar gen_time           = tables.gen_time[i];
+  const Scalar gen_time_prev      = tables.gen_time[i-1];
+  const Scalar gen_time_prev_prev = n < 2 ? gen_time_0 : tables.gen_time[i-2];
+
+  const Scalar* lambda      = tables.getDecayConstantsAt(n);
+  const Scalar* lambda_prev = tables.getDecayConstantsAt(n-1);
+  const Scalar* beta        = tables.getDelayedFractionsAt(n);
+  const Scalar* beta_prev   = tables.getDelayedFractionsAt(n-1);
+
+  const Scalar* beta_prev_prev = n < 2 ? nullptr :
+    tables.getDelayedFractionsAt(n-2);
+
+  for (precIndex j = 0; j < n_groups; j++) {
+    const auto lj    = lambda[j];
+    const auto coeff = tables.getCoefficients(j, n);
+
+    const Scalar beta_pp = n < 2 ? 0. : beta_prev_prev[j];
+    const Scalar conc_j  = conc_prev[j];
+
+    omega[j] = gen_time_0 / gen_time * beta[j] / lj * coeff.omega_n;
+
+    // zeta-hat less the concentration at n-1, as E = 1 - k0
+    delta[j] = -coeff.k0 * conc_j +
+      1 / lj * gen_time_0 * power_prev * beta_prev[j] / gen_time_prev *
+      coeff.omega_n1 +
+      1 / lj * gen_time_0 * power_prev_prev * beta_pp /
+      gen_time_prev_prev * coeff.omega_n2;
+  }
+
+  // feedback coefficients
+  const Scalar lh     = tables.lambda_h[i];
+  const auto   heat   = tables.getCoefficients(tables.n_groups, n);
+  const Scalar gamma_d = tables.gamma_d;
+
+  const Scalar H_prev_prev = n < 2 ? 0. : tables.pow_norm[i-2] * power_prev_prev;
+
+  const Scalar a1 = gamma_d * tables.pow_norm[i] / lh * heat.omega_n;
+
+  // b1 less the reactivity at n-1
+  const Scalar b1_delta = tables.rho_imp[i] - tables.rho_imp[i-1] -
+    heat.k0 * (rho_prev - tables.rho_imp[i-1]) -
+    1 / lh * static_cast<Scalar>(solution.getInitialPower()) * gamma_d *
+    tables.eta * heat.k0 +
+    gamma_d / lh * (tables.pow_norm[i-1] * power_prev * heat.omega_n1 +
+		    H_prev_prev * heat.omega_n2);
+  const Scalar b1 = rho_prev + b1_delta;
+
+  // accumulate the weighted sums
+  Scalar tau = 0., s_hat_d = 0., s_d_prev = 0.;
+  for (precIndex j = 0; j < n_groups; j++) {
+    const Scalar conc_j = conc_prev[j];
+
+    tau += lambda[j] * omega[j];
+    s_hat_d += lambda[j] * (conc_j + delta[j]);
+    s_d_prev += lambda_prev[j] * conc_j;
+  }
+
+  // compute the quadratic formula coefficients
+  const Scalar dt    = tables.dt[i];
+  const Scalar theta = tables.theta;
+
+  const Scalar a = theta * dt * a1 / gen_time;
+  const Scalar b = theta * dt * (((b1 - tables.beta_eff[i]) / gen_time - alpha) +
+				 tau / gen_time_0) - 1;
+  const Scalar c = theta * dt / gen_time_0 * s_hat_d +
+    std::exp(alpha * dt) * ((1 - theta) * dt *
+			    (((rho_prev - tables.beta_eff[i-1]) / gen_time_prev -
+			      alpha) * power_prev + s_d_prev / gen_time_0) +
+			    power_prev);
+
+  Scalar power;
+  if (a < 0) {
+    power = util::powerRoot(a, b, c);
+  } else if (a == 0) {
+    power = -c / b;
+  } else {
+    throw std::runtime_error("The power equation has no root at step " +
+			     std::to_string(n));
+  }
+
+  // the solution keeps the exact times and normalizations of the parameters
+  const Params& params = *getParameters();
+  solution.setTime(n, params.getTime(n));
+  solution.setPower(n, power);
+  solution.setPowNorm(n, params.getPowNorm(n));
+
+  // the increments of the step are added to the state in double, so that
+  // the rounding of a step stays relative to its change and does not build
+  // up in the slowly decaying groups over the steps
+  double* conc = solution.getConcentrationsAt(n);
+  for (precIndex j = 0; j < n_groups; j++) {
+    conc[j] = conc_prev[j] + (power * omega[j] + delta[j]);
+  }
+
+  solution.setRho(n, solution.getRho(n-1) + (a1 * power + b1_delta));
+}
+
+template class epke::MixedSolver<float, 0>;
+template class epke::MixedSolver<float, 6>;
+template class epke::MixedSolver<float, 8>;
+template class epke::MixedSolver<double, 0>;
+template class epke::MixedSolver<double, 6>;
+template class epke::MixedSolver<double, 8>;
@@ -0,0 +1,54 @@
+#ifndef _EPKE_MIXED_SOLVER_HEADER_
+#define _EPKE_MIXED_SOLVER_HEADER_
+
+#include <memory>
+#include <vector>
+
+#include "epke/solver.hpp"
+
+namespace epke {
+
+  // Coarse propagator for parareal that steps in the precision of Scalar.
+  // The parameters and coefficient tables its steps read are converted to
+  // Scalar once, when the solver is created, and each step evaluates the
+  // group terms, feedback and power in Scalar. The solution itself stays an
+  // EPKEOutput of doubles, since parareal corrects it with the fine solution
+  // between steps, and is rounded to Scalar where a step reads it. With a
+  // float Scalar the steps differ from Solver by single precision rounding,
+  // which only slows the parareal correction once the iterations are that
+  // close to the fine solution. G is 0 for the runtime number of groups, or
+  // one of the group counts of FixedSolver. Instantiated for float and double
+  // in mixed_solver.cpp.
+  template <typename Scalar, para::precIndex G>
+  class MixedSolver : public Solver {
+  public:
+    using ptr = std::shared_ptr<MixedSolver<Scalar, G>>;
+
+    // Parameters and coefficients of every step in Scalar, shared by copies
+    struct Tables;
+
+  private:
+    std::shared_ptr<const Tables> _tables;
+
+    // Scratch space for the runtime number of groups
+    std::vector<Scalar> _omega;
+    std::vector<Scalar> _delta;
+
+    static std::shared_ptr<const Tables> buildTables(const Params& params);
+
+  public:
+    MixedSolver(Params::ptr parameters, Output::ptr solution);
+
+    void reset(Output::ptr solution) { Solver::reset(solution); }
+
+    void reset(Params::ptr parameters, Output::ptr solution) {
+      _tables = buildTables(*parameters);
+      Solver::reset(parameters, solution);
+    }
+
+    void step(const timeIndex n) override;
+  }; // class MixedSolver
+
+} // namespace epke
+
+#endif
@@ -1,78 +1,223 @@
 #include <algorithm>
-#include <iterator>
-#include <iomanip>
-#include <sstream>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 
 #include "epke/output.hpp"
 
+#include "utility/binary_io.hpp"
 #include "utility/interpolate.hpp"
-#include "pugi/pugixml.hpp"
+#include "utility/xml_writer.hpp"
 
 para::SolverOutput::ptr
 epke::EPKEOutput::createPrecomputedImpl(const timeIndex n,
 					const timeIndex n_fine_per_coarse) const
 {
+  auto precomp = std::make_shared<EPKEOutput>(_n_precursors, 0, 0, 0);
+  fillPrecomputedImpl(n, n_fine_per_coarse, *precomp);
+  return precomp;
+}
+
+void epke::EPKEOutput::fillPrecomputedImpl(const timeIndex n,
+					   const timeIndex n_fine_per_coarse,
+					   SolverOutput& output) const
+{
+  EPKEOutput& precomp = static_cast<EPKEOutput&>(output);
+
   timeIndex n_start = n * n_fine_per_coarse + 1;
   timeIndex n_stop = (n+1) * n_fine_per_coarse + 1;
 
-  timeBins fine_time = util::linspace(_time.front(), _time.at(n), n_start);
-  timeBins fine_power = util::interpolate(_time, _power, fine_time);
-  timeBins fine_pow_norm = util::interpolate(_time, _pow_norm, fine_time);
-  timeBins fine_rho   = util::interpolate(_time, _rho, fine_time);
+  util::linspace(_time.front(), _time.at(n), n_start, precomp._time);
+  const util::Interpolation interpolate(_time, precomp._time);
+
+  precomp._n_start       = n_start;
+  precomp._n_stop        = n_stop;
+  precomp._n_offset      = 0;
+  precomp._n_precursors  = _n_precursors;
+  precomp._initial_power = 0.;
+
+  // the steps of the window start from zero, as in a new output
+  precomp._time.resize(n_stop, 0.);
+  precomp._power.assign(n_stop, 0.);
+  precomp._pow_norm.assign(n_stop, 0.);
+  precomp._rho.assign(n_stop, 0.);
+  precomp._concentrations.assign(n_stop * _n_precursors, 0.);
+
+  interpolate(_power, precomp._power.data());
+  interpolate(_pow_norm, precomp._pow_norm.data());
+  interpolate(_rho, precomp._rho.data());
+
+  for (precIndex k = 0; k < _n_precursors; k++) {
+    interpolate(getConcentrations(k), precomp._concentrations.data() + k,
+		_n_precursors);
+  }
+}
+
+para::SolverOutput::ptr
+epke::EPKEOutput::createWindowImpl(const timeIndex n,
+				   const timeIndex n_fine_per_coarse) const
+{
+  auto window = std::make_shared<EPKEOutput>(_n_precursors, 0, 0, 0);
+  fillWindowImpl(n, n_fine_per_coarse, *window);
+  return window;
+}
+
+void epke::EPKEOutput::fillWindowImpl(const timeIndex n,
+				      const timeIndex n_fine_per_coarse,
+				      SolverOutput& output) const
+{
+  EPKEOutput& window = static_cast<EPKEOutput&>(output);
+
+  timeIndex n_start = n * n_fine_per_coarse + 1;
+  timeIndex n_stop = (n+1) * n_fine_per_coarse + 1;
+
+  // the first fine step reads the two previous steps (n-1 and n-2)
+  timeIndex n_offset = n_start < 2 ? 0 : n_start - 2;
+
+  timeIndex n_steps = n_stop - n_offset;
+
+  window._n_start       = n_start;
+  window._n_stop        = n_stop;
+  window._n_offset      = n_offset;
+  window._n_precursors  = getNumPrecursors();
+  window._initial_power = getInitialPower();
+
+  // within the capacity of a window of the same refinement, so that only
+  // the first fill of a buffer allocates
+  window._time.assign(n_steps, 0.);
+  window._power.assign(n_steps, 0.);
+  window._pow_norm.assign(n_steps, 0.);
+  window._rho.assign(n_steps, 0.);
+  window._concentrations.assign(n_steps * getNumPrecursors(), 0.);
 
-  fine_time.resize(n_stop);
-  fine_power.resize(n_stop);
-  fine_pow_norm.resize(n_stop);
-  fine_rho.resize(n_stop);
+  // the history lies within the coarse step ending at index n
+  const timeIndex n_prev = n > 0 ? n - 1 : 0;
+  const double    a      = getTime(n_prev);
+  const double    b      = getTime(n);
 
-  precBins<timeBins> fine_concentrations;
+  // same spacing as the fine mesh from t_0 to t_n
+  const double delta = n > 0 ?
+    (getTime(n) - getTime(0)) / (n * n_fine_per_coarse) : 0.;
 
-  for (precIndex k = 0; k < getNumPrecursors(); k++) {
-    timeBins fine_concentration = util::interpolate(_time,
-						    _concentrations[k],
-						    fine_time);
-    fine_concentration.resize(n_stop);
-    fine_concentrations.push_back(fine_concentration);
+  // linearly interpolate within the coarse step, as util::interpolate does
+  auto history = [&](const double ya, const double yb, const double t) {
+    return n > 0 ? ya + ( yb - ya ) / ( b - a ) * ( t - a ) : yb;
+  };
+
+  for (timeIndex n_fine = n_offset; n_fine < n_start; n_fine++) {
+    const timeIndex i = n_fine - n_offset;
+
+    window._time[i] = n_fine == n_start - 1 ?
+      getTime(n) : getTime(0) + delta * n_fine;
+
+    const double t = window._time[i];
+
+    window._power[i]    = history(getPower(n_prev), getPower(n), t);
+    window._pow_norm[i] = history(getPowNorm(n_prev), getPowNorm(n), t);
+    window._rho[i]      = history(getRho(n_prev), getRho(n), t);
+
+    for (precIndex k = 0; k < getNumPrecursors(); k++) {
+      window._concentrations[i * getNumPrecursors() + k] =
+	history(getConcentration(k, n_prev), getConcentration(k, n), t);
+    }
   }
+}
 
-  return std::make_shared<EPKEOutput>(n_start,
-				      n_stop,
-				      fine_time,
-				      fine_concentrations,
-				      fine_power,
-				      fine_pow_norm,
-				      fine_rho);
+para::SolverOutput::ptr
+epke::EPKEOutput::createSliceImpl(const timeIndex n_start,
+				  const timeIndex n_stop,
+				  const timeIndex n_history) const
+{
+  const timeIndex n_offset = n_start < _n_offset + n_history ? _n_offset :
+    n_start - n_history;
+
+  // positions of the copied range in the stored buffers
+  const timeIndex first = n_offset - _n_offset;
+  const timeIndex last  = n_stop - _n_offset;
+
+  auto slice = [&](const timeBins& values) {
+    return timeBins(values.begin() + first, values.begin() + last);
+  };
+
+  auto output = std::make_shared<EPKEOutput>(
+    n_start,
+    n_stop,
+    slice(_time),
+    _n_precursors,
+    timeBins(_concentrations.begin() + first * _n_precursors,
+	     _concentrations.begin() + last * _n_precursors),
+    slice(_power),
+    slice(_pow_norm),
+    slice(_rho),
+    n_offset);
+
+  output->setInitialPower(getInitialPower());
+
+  return output;
 }
 
 epke::EPKEOutput::ptr
-epke::EPKEOutput::coarsen(const timeBins& coarse_time) const {
-  timeBins coarse_power(coarse_time.size());
-  timeBins coarse_pow_norm(coarse_time.size());
-  timeBins coarse_rho(coarse_time.size());
-  precBins<timeBins> coarse_concentrations(getNumPrecursors(),
-					   timeBins(coarse_time.size()));
+epke::EPKEOutput::coarsen(const util::Series& coarse_time,
+			  const timeIndex n_fine_per_coarse) const {
+  auto coarse = std::make_shared<EPKEOutput>(_n_precursors, 0, 0, 0);
+  coarsen(coarse_time, n_fine_per_coarse, *coarse);
+  return coarse;
+}
 
-  for (timeIndex n_coarse = 0; n_coarse < coarse_time.size(); n_coarse++) {
-    auto it = std::find(_time.cbegin(), _time.cend(), coarse_time.at(n_coarse));
+void epke::EPKEOutput::coarsen(const util::Series& coarse_time,
+			       const timeIndex n_fine_per_coarse,
+			       EPKEOutput& coarse) const {
+  const timeIndex n_coarse_steps = coarse_time.size();
 
-    timeIndex n_fine = std::distance(_time.cbegin(), it);
+  if ((n_coarse_steps - 1) * n_fine_per_coarse >= _time.size()) {
+    throw std::runtime_error("Cannot coarsen " + std::to_string(_time.size()) +
+			     " fine steps onto " + std::to_string(n_coarse_steps) +
+			     " coarse steps of " + std::to_string(n_fine_per_coarse));
+  }
 
-    coarse_power[n_coarse] = _power.at(n_fine);
-    coarse_pow_norm[n_coarse] = _pow_norm.at(n_fine);
-    coarse_rho[n_coarse] = _rho.at(n_fine);
+  coarse._time.assign(coarse_time.begin(), coarse_time.end());
+  coarse._n_start       = 0;
+  coarse._n_stop        = n_coarse_steps;
+  coarse._n_offset      = 0;
+  coarse._n_precursors  = _n_precursors;
+  coarse._initial_power = 0.;
+
+  coarse._power.resize(n_coarse_steps);
+  coarse._pow_norm.resize(n_coarse_steps);
+  coarse._rho.resize(n_coarse_steps);
+  coarse._concentrations.resize(n_coarse_steps * _n_precursors);
+
+  // coarse step n lies on fine step n * n_fine_per_coarse
+  for (timeIndex n_coarse = 0; n_coarse < n_coarse_steps; n_coarse++) {
+    const timeIndex n_fine = n_coarse * n_fine_per_coarse;
+
+    coarse._power[n_coarse] = _power[n_fine];
+    coarse._pow_norm[n_coarse] = _pow_norm[n_fine];
+    coarse._rho[n_coarse] = _rho[n_fine];
+
+    // copy the whole block of groups at this time step
+    std::copy_n(getConcentrationsAt(n_fine), _n_precursors,
+		coarse.getConcentrationsAt(n_coarse));
+  }
+}
 
-    for (precIndex k = 0; k < getNumPrecursors(); k++) {
-      coarse_concentrations[k][n_coarse] = _concentrations.at(k).at(n_fine);
-    }
+const double epke::EPKEOutput::computeJump(const timeIndex n,
+					  EPKEOutput::ptr other) const {
+  // relative difference, falling back to absolute when the reference is zero
+  auto jump = [](const double val, const double ref) {
+    return ref != 0. ? std::fabs(val - ref) / std::fabs(ref) :
+      std::fabs(val - ref);
+  };
+
+  double result = jump(getPower(n), other->getPower(n));
+
+  for (precIndex j = 0; j < getNumPrecursors(); j++) {
+    result = std::max(result, jump(getConcentration(j, n),
+				   other->getConcentration(j, n)));
   }
 
-  return std::make_shared<EPKEOutput>(0,
-				      coarse_time.size(),
-				      coarse_time,
-				      coarse_concentrations,
-				      coarse_power,
-				      coarse_pow_norm,
-				      coarse_rho);
+  return result;
 }
 
 void epke::EPKEOutput::resize(const timeIndex n_steps) {
@@ -81,9 +226,8 @@ void epke::EPKEOutput::resize(const timeIndex n_steps) {
   _pow_norm.resize(n_steps);
   _rho.resize(n_steps);
 
-  for (precIndex k = 0; k < getNumPrecursors(); k++) {
-    _concentrations[k].resize(n_steps);
-  }
+  // the time-major layout grows by whole time steps
+  _concentrations.resize(n_steps * _n_precursors);
 }
 
 void epke::EPKEOutput::updateCoarseImpl(const timeIndex n,
@@ -131,50 +275,142 @@ void epke::EPKEOutput::updatePararealImpl(const timeIndex n,
 	 old_co->getRho(n));
 }
 
-void epke::EPKEOutput::writeToXML(pugi::xml_document& doc) const {
-  pugi::xml_node parareal_node = doc.child("parareal");
-  pugi::xml_node output_node   = parareal_node.append_child("epke_output");
-  pugi::xml_node time_node     = output_node.append_child("time");
-  pugi::xml_node power_node    = output_node.append_child("power");
-  pugi::xml_node pow_norm_node = output_node.append_child("pow_norm");
-  pugi::xml_node rho_node      = output_node.append_child("rho");
-  pugi::xml_node concs_node    = output_node.append_child("concentrations");
+para::SolverOutput::ptr epke::EPKEOutput::createRecordImpl() const {
+  return std::make_shared<EPKEOutput>(_n_precursors, 0, 0, 0);
+}
 
-  std::ostringstream time_str, power_str, pow_norm_str, rho_str, conc_str;
+void epke::EPKEOutput::recordImpl(const para::OutputSpec& spec,
+				  const SolverOutput& source,
+				  const timeIndex n) {
+  const EPKEOutput& from = static_cast<const EPKEOutput&>(source);
 
-  parareal_node.append_attribute("solve_time") = _solve_time;
+  const bool power          = spec.keeps("power");
+  const bool pow_norm       = spec.keeps("pow_norm");
+  const bool rho            = spec.keeps("rho");
+  const bool concentrations = spec.keeps("concentrations");
 
-  for (int n = 0; n < getNumTimeSteps(); n++) {
-    time_str     << std::setprecision(6)  << _time.at(n);
-    power_str    << std::setprecision(12) << _power.at(n);
-    pow_norm_str << std::setprecision(12) << _pow_norm.at(n);
-    rho_str      << std::setprecision(12) << _rho.at(n);
+  // append the values a fraction w of the way from step n_prev to step n
+  auto append = [&](const double t, const timeIndex n_prev, const double w) {
+    auto blend = [w](const double a, const double b) { return a + w * (b - a); };
 
-    if (n != getNumTimeSteps() - 1) {
-      time_str     << " ";
-      power_str    << " ";
-      pow_norm_str << " ";
-      rho_str      << " ";
+    _time.push_back(t);
+    if (power) { _power.push_back(blend(from.getPower(n_prev), from.getPower(n))); }
+    if (pow_norm) {
+      _pow_norm.push_back(blend(from.getPowNorm(n_prev), from.getPowNorm(n)));
     }
-  }
+    if (rho) { _rho.push_back(blend(from.getRho(n_prev), from.getRho(n))); }
 
-  time_node.text()     = time_str.str().c_str();
-  power_node.text()    = power_str.str().c_str();
-  pow_norm_node.text() = pow_norm_str.str().c_str();
-  rho_node.text()      = rho_str.str().c_str();
-
-  for (int k = 0; k < getNumPrecursors(); k++) {
-    conc_str.str("");
-    conc_str.clear();
-    pugi::xml_node conc_node = concs_node.append_child("concentration");
-    conc_node.append_attribute("k") = k;
-    for (int n = 0; n < getNumTimeSteps(); n++) {
-      conc_str << std::setprecision(12) << _concentrations.at(k).at(n);
-
-      if (n != getNumTimeSteps() - 1) {
-        conc_str << " ";
+    if (concentrations) {
+      const double* prev = from.getConcentrationsAt(n_prev);
+      const double* conc = from.getConcentrationsAt(n);
+      for (precIndex k = 0; k < _n_precursors; k++) {
+	_concentrations.push_back(blend(prev[k], conc[k]));
+      }
+    }
+  };
+
+  const double t = from.getTime(n);
+
+  if (spec.times.empty()) {
+    if (n % spec.stride == 0) { append(t, n, 1.); }
+  } else {
+    // the times after step n-1 up to step n, and those up to t_0 at step 0
+    const auto first = n == 0 ? spec.times.begin() :
+      std::upper_bound(spec.times.begin(), spec.times.end(), from.getTime(n-1));
+    const auto last = std::upper_bound(first, spec.times.end(), t);
+
+    for (auto it = first; it != last; it++) {
+      if (n == 0) {
+	append(*it, n, 1.);
+      } else {
+	const double t_prev = from.getTime(n-1);
+	append(*it, n-1, (*it - t_prev) / (t - t_prev));
       }
     }
-    conc_node.text() = conc_str.str().c_str();
   }
+
+  _n_stop = _time.size();
+}
+
+void epke::EPKEOutput::appendImpl(const SolverOutput& output) {
+  const EPKEOutput& record = static_cast<const EPKEOutput&>(output);
+
+  auto append = [](timeBins& to, const timeBins& from) {
+    to.insert(to.end(), from.begin(), from.end());
+  };
+
+  append(_time, record._time);
+  append(_power, record._power);
+  append(_pow_norm, record._pow_norm);
+  append(_rho, record._rho);
+  append(_concentrations, record._concentrations);
+
+  _n_stop = _time.size();
+}
+
+void epke::EPKEOutput::packState(const timeIndex n, double* buf) const {
+  buf[0] = getPower(n);
+  buf[1] = getPowNorm(n);
+  buf[2] = getRho(n);
+  for (precIndex j = 0; j < getNumPrecursors(); j++) {
+    buf[3 + j] = getConcentration(j, n);
+  }
+}
+
+void epke::EPKEOutput::unpackState(const timeIndex n, const double* buf) {
+  setPower(n, buf[0]);
+  setPowNorm(n, buf[1]);
+  setRho(n, buf[2]);
+  for (precIndex j = 0; j < getNumPrecursors(); j++) {
+    setConcentration(j, n, buf[3 + j]);
+  }
+}
+
+void epke::EPKEOutput::writeToXML(util::XMLWriter& writer) const {
+  const timeIndex n_steps = _time.size();
+
+  writer.open("epke_output");
+  writer.element("time", _time);
+
+  // a record leaves out the quantities it does not keep
+  if (!_power.empty() || _time.empty()) { writer.element("power", _power); }
+  if (!_pow_norm.empty() || _time.empty()) { writer.element("pow_norm", _pow_norm); }
+  if (!_rho.empty() || _time.empty()) { writer.element("rho", _rho); }
+
+  if (!_concentrations.empty() || _time.empty()) {
+    writer.open("concentrations");
+    for (precIndex k = 0; k < getNumPrecursors(); k++) {
+      writer.open("concentration");
+      writer.attribute("k", +k);
+      writer.values(_concentrations.data() + k, n_steps, _n_precursors);
+      writer.close();
+    }
+    writer.close();
+  }
+
+  writer.close();
+}
+
+void epke::EPKEOutput::writeToBinary(util::BinaryWriter& writer,
+				     const std::string& prefix) const {
+  const timeIndex n_steps = _time.size();
+
+  writer.add(prefix + "time", _time);
+
+  // a record leaves out the quantities it does not keep
+  if (!_power.empty() || _time.empty()) { writer.add(prefix + "power", _power); }
+  if (!_pow_norm.empty() || _time.empty()) {
+    writer.add(prefix + "pow_norm", _pow_norm);
+  }
+  if (!_rho.empty() || _time.empty()) { writer.add(prefix + "rho", _rho); }
+
+  // the group histories are strided views of the time-major concentrations
+  if (!_concentrations.empty() || _time.empty()) {
+    for (precIndex k = 0; k < getNumPrecursors(); k++) {
+      writer.add(prefix + "concentration_" + std::to_string(k),
+		 _concentrations.data() + k, n_steps, _n_precursors);
+    }
+  }
+
+  writer.add(prefix + "solve_time", _solve_time);
 }
@@ -4,6 +4,8 @@
 #include <memory>
 
 #include "parareal/solver_output.hpp"
+#include "utility/series.hpp"
+#include "utility/time_major.hpp"
 
 namespace epke {
 
@@ -19,7 +21,11 @@ private:
   timeBins           _power;          // reactor power
   timeBins           _pow_norm;       // Power normalization factor
   timeBins           _rho;            // reactivity with feedback
-  precBins<timeBins> _concentrations; // precursor concentrations
+  precIndex          _n_precursors;   // number of precursor groups
+  timeBins           _concentrations; // time-major: [n * _n_precursors + k]
+
+  // power at t = 0 for window-local outputs that do not store it
+  double _initial_power = 0.;
 
 public:
   EPKEOutput(const precIndex n_precursors,
@@ -30,7 +36,8 @@ public:
       _power(n_time_steps, 0.),
       _pow_norm(n_time_steps, 0.),
       _rho(n_time_steps, 0.),
-      _concentrations(n_precursors, timeBins(n_time_steps, 0.)) {}
+      _n_precursors(n_precursors),
+      _concentrations(n_time_steps * n_precursors, 0.) {}
 
   // Construct from data vectors
   EPKEOutput(const timeIndex           n_start,
@@ -39,40 +46,118 @@ public:
 	     const precBins<timeBins>& concentrations,
 	     const timeBins&           power,
 	     const timeBins&           pow_norm,
-	     const timeBins&           rho)
-    : SolverOutput(time, n_start, n_stop),
+	     const timeBins&           rho,
+	     const timeIndex           n_offset = 0)
+    : SolverOutput(time, n_start, n_stop, n_offset),
+      _power(power),
+      _pow_norm(pow_norm),
+      _rho(rho),
+      _n_precursors(concentrations.size()),
+      _concentrations(util::packTimeMajor(concentrations)) {}
+
+  // Construct from data vectors with time-major concentrations
+  EPKEOutput(const timeIndex n_start,
+	     const timeIndex n_stop,
+	     const timeBins& time,
+	     const precIndex n_precursors,
+	     const timeBins& concentrations,
+	     const timeBins& power,
+	     const timeBins& pow_norm,
+	     const timeBins& rho,
+	     const timeIndex n_offset = 0)
+    : SolverOutput(time, n_start, n_stop, n_offset),
       _power(power),
       _pow_norm(pow_norm),
       _rho(rho),
+      _n_precursors(n_precursors),
       _concentrations(concentrations) {}
 
-  void setPower(const timeIndex n, const double val) { _power[n] = val; }
-  void setPowNorm(const timeIndex n, const double val) { _pow_norm[n] = val; }
-  void setRho(const timeIndex n, const double val) { _rho[n] = val; }
+  // Accessors take global time indices, shifted by the offset of the output
+  void setPower(const timeIndex n, const double val)
+  { _power[n - _n_offset] = val; }
+  void setPowNorm(const timeIndex n, const double val)
+  { _pow_norm[n - _n_offset] = val; }
+  void setRho(const timeIndex n, const double val)
+  { _rho[n - _n_offset] = val; }
   void setConcentration(const precIndex k, const timeIndex n, const double val)
-  { _concentrations[k][n] = val; }
+  { _concentrations[(n - _n_offset) * _n_precursors + k] = val; }
 
-  const double getPower(const timeIndex n) const { return _power.at(n); }
-  const double getPowNorm(const timeIndex n) const { return _pow_norm.at(n); }
-  const double getRho(const timeIndex n)   const { return _rho.at(n);   }
+  const double getPower(const timeIndex n) const {
+    return _power.at(n - _n_offset);
+  }
+  const double getPowNorm(const timeIndex n) const {
+    return _pow_norm.at(n - _n_offset);
+  }
+  const double getRho(const timeIndex n) const {
+    return _rho.at(n - _n_offset);
+  }
   const double getConcentration(const precIndex k, const timeIndex n) const {
-    return _concentrations.at(k).at(n);
+    return _concentrations.at((n - _n_offset) * _n_precursors + k);
   }
 
+  // Concentrations of all groups at time index n, stored contiguously
+  const double* getConcentrationsAt(const timeIndex n) const {
+    return _concentrations.data() + (n - _n_offset) * _n_precursors;
+  }
+  double* getConcentrationsAt(const timeIndex n) {
+    return _concentrations.data() + (n - _n_offset) * _n_precursors;
+  }
+
+  // power at t = 0, which the feedback term of every step reads
+  const double getInitialPower() const {
+    return _n_offset == 0 ? _power.at(0) : _initial_power;
+  }
+  void setInitialPower(const double val) { _initial_power = val; }
+
   const timeBins& getPower() const { return _power; }
   const timeBins& getPowNorm() const { return _pow_norm; }
   const timeBins& getRho() const { return _rho; }
-  const precBins<timeBins>& getConcentrations() const {
-    return _concentrations;
+  // Stored histories of all groups, copied out of the time-major storage
+  const precBins<timeBins> getConcentrations() const {
+    return util::unpackTimeMajor(_concentrations, _n_precursors);
+  }
+  // View of the stored history of group k
+  const util::StridedView getConcentrations(const precIndex k) const {
+    return util::StridedView(_concentrations.data() + k,
+			     _n_precursors,
+			     _time.size());
   }
 
-  const precIndex getNumPrecursors() const { return _concentrations.size(); }
+  const precIndex getNumPrecursors() const { return _n_precursors; }
 
   SolverOutput::ptr createPrecomputedImpl(const timeIndex n,
 					  const timeIndex n_fine_per_coarse)
     const override;
 
-  EPKEOutput::ptr coarsen(const timeBins& coarse_time) const;
+  SolverOutput::ptr createWindowImpl(const timeIndex n,
+				     const timeIndex n_fine_per_coarse)
+    const override;
+
+  void fillPrecomputedImpl(const timeIndex n,
+			   const timeIndex n_fine_per_coarse,
+			   SolverOutput& precomp) const override;
+
+  void fillWindowImpl(const timeIndex n,
+		      const timeIndex n_fine_per_coarse,
+		      SolverOutput& window) const override;
+
+  SolverOutput::ptr createSliceImpl(const timeIndex n_start,
+				    const timeIndex n_stop,
+				    const timeIndex n_history) const override;
+
+  // Values at the coarse time steps of a fine output refined by
+  // n_fine_per_coarse, so coarse step n is read from fine step
+  // n * n_fine_per_coarse
+  EPKEOutput::ptr coarsen(const util::Series& coarse_time,
+			  const timeIndex n_fine_per_coarse) const;
+
+  // Coarsen into an existing output, reusing its storage
+  void coarsen(const util::Series& coarse_time,
+	       const timeIndex n_fine_per_coarse,
+	       EPKEOutput& coarse) const;
+
+  // Largest relative difference in power and concentrations at time index n
+  const double computeJump(const timeIndex n, EPKEOutput::ptr other) const;
 
   void resize(const timeIndex n_steps) override;
 
@@ -83,7 +168,33 @@ public:
 			  SolverOutput::ptr fine_coarsened,
 			  SolverOutput::ptr old_coarse) override;
 
-  void writeToXML(pugi::xml_document& doc) const override;
+  // Records keep power, pow_norm and rho under those names and the groups
+  // under "concentrations". The series of a quantity a record does not keep
+  // stay empty and are not written.
+  SolverOutput::ptr createRecordImpl() const override;
+
+  void recordImpl(const para::OutputSpec& spec,
+		  const SolverOutput& source,
+		  const timeIndex n) override;
+
+  void appendImpl(const SolverOutput& record) override;
+
+  // State at a time step: power, pow_norm, rho and the concentrations
+  const std::size_t getStateSize() const override {
+    return 3 + getNumPrecursors();
+  }
+
+  void packState(const timeIndex n, double* buf) const override;
+
+  void unpackState(const timeIndex n, const double* buf) override;
+
+  // Stream an epke_output element
+  void writeToXML(util::XMLWriter& writer) const override;
+
+  // Add time, power, pow_norm, rho, one concentration_k array per group and
+  // the solve time, written straight from the stored buffers
+  void writeToBinary(util::BinaryWriter& writer,
+		     const std::string& prefix = "") const override;
 };
 
 } // namespace epke
@@ -1,81 +1,152 @@
-#include <iomanip>
-#include <sstream>
-
 #include "epke/parameters.hpp"
 
+#include "utility/binary_io.hpp"
 #include "utility/interpolate.hpp"
-#include "pugi/pugixml.hpp"
+#include "utility/xml_writer.hpp"
 
-para::SolverParameters::ptr
-epke::EPKEParameters::interpolateImpl(const timeBins& fine_time) const {
-  using util::interpolate;
+// Pack the histories of every group, or only their values when all of them
+// are constant in time
+static para::timeBins packHistories(const para::precBins<const util::Series*>& histories) {
+  bool constant = true;
+  for (const auto history : histories) { constant = constant && history->isConstant(); }
+
+  para::precBins<para::timeBins> packed;
+  for (const auto history : histories) {
+    packed.push_back(constant ? para::timeBins(1, (*history)[0]) : history->toVector());
+  }
+  return util::packTimeMajor(packed);
+}
+
+para::timeBins epke::EPKEParameters::packDecayConstants(
+			 const precBins<Precursor::ptr>& precursors) {
+  precBins<const util::Series*> histories;
+  for (const auto& p : precursors) { histories.push_back(&p->decayConstant()); }
+  return packHistories(histories);
+}
+
+para::timeBins epke::EPKEParameters::packDelayedFractions(
+			 const precBins<Precursor::ptr>& precursors) {
+  precBins<const util::Series*> histories;
+  for (const auto& p : precursors) { histories.push_back(&p->delayedFraction()); }
+  return packHistories(histories);
+}
+
+epke::EPKEParameters::precBins<epke::Precursor::ptr>
+epke::EPKEParameters::interpolatePrecursors(
+			 const util::Interpolation& interpolate) const {
+  // groups that are all constant in time stay constant
+  auto group = [&](const util::StridedView& history, const precIndex stride) {
+    return stride == 0 ? util::Series::constant(history[0], interpolate.size()) :
+      util::Series(interpolate(history));
+  };
 
-  // interpolate the precursors
   precBins<Precursor::ptr> fine_precursors;
 
-  for (const auto p : _precursors) {
-    Precursor::ptr fine_precursor
-      = std::make_shared<Precursor>(interpolate(_time,
-						p->decayConstant(),
-						fine_time),
-				    interpolate(_time,
-						p->delayedFraction(),
-						fine_time));
-    fine_precursors.push_back(fine_precursor);
+  for (precIndex k = 0; k < _n_precursors; k++) {
+    fine_precursors.push_back(
+      std::make_shared<Precursor>(group(getDecayConstants(k), _decay_stride),
+				  group(getDelayedFractions(k), _fraction_stride)));
   }
 
+  return fine_precursors;
+}
+
+para::SolverParameters::ptr
+epke::EPKEParameters::interpolateImpl(const util::Series& fine_time) const {
+  // every parameter shares the coarse and fine time grids
+  const util::Interpolation interpolate(_time, fine_time);
+
+  // interpolate the precursors
+  const precBins<Precursor::ptr> fine_precursors = interpolatePrecursors(interpolate);
+
   return
     std::make_shared<EPKEParameters>(fine_time,
 				     fine_precursors,
-				     interpolate(_time, _rho_imp,  fine_time),
-				     interpolate(_time, _gen_time, fine_time),
-				     interpolate(_time, _pow_norm, fine_time),
-				     interpolate(_time, _beta_eff, fine_time),
-				     interpolate(_time, _lambda_h, fine_time),
+				     interpolate(_rho_imp),
+				     interpolate(_gen_time),
+				     interpolate(_pow_norm),
+				     interpolate(_beta_eff),
+				     interpolate(_lambda_h),
 				     _theta,
 				     _gamma_d,
 				     _eta);
 }
 
-void epke::EPKEParameters::writeToXML(pugi::xml_document& doc) const {
-  pugi::xml_node parareal_node = doc.child("parareal");
-  pugi::xml_node params_node   = parareal_node.append_child("epke_input");
-  pugi::xml_node time_node     = params_node.append_child("time");
-  pugi::xml_node rho_imp_node  = params_node.append_child("rho_imp");
-  pugi::xml_node gen_time_node = params_node.append_child("gen_time");
-  pugi::xml_node pow_norm_node = params_node.append_child("pow_norm");
-  pugi::xml_node beta_eff_node = params_node.append_child("beta_eff");
-  pugi::xml_node lambda_h_node = params_node.append_child("lambda_h");
-
-  std::ostringstream time_str, rho_imp_str, gen_time_str, pow_norm_str,
-    beta_eff_str, lambda_h_str;
-
-  for (int n = 0; n < getNumTimeSteps(); n++) {
-    time_str     << std::setprecision(6)  << _time.at(n);
-    rho_imp_str  << std::setprecision(12) << _rho_imp.at(n);
-    gen_time_str << std::setprecision(12) << _gen_time.at(n);
-    pow_norm_str << std::setprecision(12) << _pow_norm.at(n);
-    beta_eff_str << std::setprecision(12) << _beta_eff.at(n);
-    lambda_h_str << std::setprecision(12) << _lambda_h.at(n);
-
-    if (n != getNumTimeSteps() - 1) {
-      time_str     << " ";
-      rho_imp_str  << " ";
-      gen_time_str << " ";
-      pow_norm_str << " ";
-      beta_eff_str << " ";
-      lambda_h_str << " ";
-    }
+para::SolverParameters::ptr
+epke::EPKEParameters::interpolateWindowImpl(const double    t_start,
+					    const double    t_end,
+					    const timeIndex n_fine,
+					    const timeIndex n_offset,
+					    const timeIndex n_stop) const {
+  // the points of util::linspace(t_start, t_end, n_fine) in the window
+  const util::Series fine_time =
+    util::Series::uniform(t_start, t_end, n_fine).window(n_offset, n_stop);
+
+  const util::Interpolation interpolate(_time, fine_time);
+
+  const precBins<Precursor::ptr> fine_precursors = interpolatePrecursors(interpolate);
+
+  auto window = std::make_shared<EPKEParameters>(fine_time,
+						 fine_precursors,
+						 interpolate(_rho_imp),
+						 interpolate(_gen_time),
+						 interpolate(_pow_norm),
+						 interpolate(_beta_eff),
+						 interpolate(_lambda_h),
+						 _theta,
+						 _gamma_d,
+						 _eta,
+						 n_offset);
+
+  window->setInitialGenTime(
+    util::Interpolation(_time, timeBins(1, t_start))(_gen_time).front());
+
+  return window;
+}
+
+void epke::EPKEParameters::writeToXML(util::XMLWriter& writer) const {
+  writer.open("epke_input");
+  writer.attribute("n_steps", _time.size());
+  writer.attribute("theta", _theta);
+  writer.attribute("gamma_d", _gamma_d);
+  writer.attribute("eta", _eta);
+
+  writer.element("time", _time);
+  writer.element("rho_imp", _rho_imp);
+  writer.element("gen_time", _gen_time);
+  writer.element("pow_norm", _pow_norm);
+  writer.element("beta_eff", _beta_eff);
+  writer.element("lambda_h", _lambda_h);
+
+  // the group histories, so the element reads back as an input
+  writer.open("precursors");
+  for (precIndex k = 0; k < getNumPrecursors(); k++) {
+    writer.open("precursor");
+    writer.element("decay_constant", _decay_constants.data() + k,
+		   _time.size(), _decay_stride);
+    writer.element("delayed_fraction", _delayed_fractions.data() + k,
+		   _time.size(), _fraction_stride);
+    writer.close();
   }
+  writer.close();
 
-  params_node.append_attribute("theta")   = _theta;
-  params_node.append_attribute("gamma_d") = _gamma_d;
-  params_node.append_attribute("eta")     = _eta;
+  writer.close();
+}
+
+void epke::EPKEParameters::writeToBinary(util::BinaryWriter& writer,
+					 const std::string& prefix) const {
+  writer.add(prefix + "time", _time);
+  writer.add(prefix + "rho_imp", _rho_imp);
+  writer.add(prefix + "gen_time", _gen_time);
+  writer.add(prefix + "pow_norm", _pow_norm);
+  writer.add(prefix + "beta_eff", _beta_eff);
+  writer.add(prefix + "lambda_h", _lambda_h);
 
-  time_node.text()     = time_str.str().c_str();
-  rho_imp_node.text()  = rho_imp_str.str().c_str();
-  gen_time_node.text() = gen_time_str.str().c_str();
-  pow_norm_node.text() = pow_norm_str.str().c_str();
-  beta_eff_node.text() = beta_eff_str.str().c_str();
-  lambda_h_node.text() = lambda_h_str.str().c_str();
+  for (precIndex k = 0; k < getNumPrecursors(); k++) {
+    const std::string group = std::to_string(k);
+    writer.add(prefix + "decay_constant_" + group,
+	       _decay_constants.data() + k, _time.size(), _decay_stride);
+    writer.add(prefix + "delayed_fraction_" + group,
+	       _delayed_fractions.data() + k, _time.size(), _fraction_stride);
+  }
 }
@@ -2,9 +2,16 @@
 #define _EPKE_PARAMETERS_HEADER_
 
 #include <memory>
+#include <stdexcept>
 
 #include "parareal/solver_parameters.hpp"
 #include "epke/precursor.hpp"
+#include "epke/coefficients.hpp"
+#include "utility/time_major.hpp"
+
+namespace util {
+  class Interpolation;
+}
 
 namespace epke {
 
@@ -17,15 +24,20 @@ public:
   using ptr       = std::shared_ptr<EPKEParameters>;
 
 private:
-  // time-dependent parameters
-  const timeBins _rho_imp;  // imposed reactivity (without feedback)
-  const timeBins _gen_time; // mean neutron generation time (Lambda)
-  const timeBins _pow_norm; // power normalization factor
-  const timeBins _beta_eff; // total delayed neutron fraction
-  const timeBins _lambda_h; // linear heat conduction constant
-
-  // Pointers to precursor objects
-  const precBins<Precursor::ptr> _precursors;
+  // time-dependent parameters, stored as a single value when constant
+  const util::Series _rho_imp;  // imposed reactivity (without feedback)
+  const util::Series _gen_time; // mean neutron generation time (Lambda)
+  const util::Series _pow_norm; // power normalization factor
+  const util::Series _beta_eff; // total delayed neutron fraction
+  const util::Series _lambda_h; // linear heat conduction constant
+
+  // Precursor data stored time-major: [n * stride + k], where the stride is
+  // zero and a single step is stored when every group is constant in time
+  const precIndex _n_precursors;
+  const timeBins  _decay_constants;   // lambda
+  const timeBins  _delayed_fractions; // beta
+  const precIndex _decay_stride;
+  const precIndex _fraction_stride;
 
   // coefficient for finite differencing scheme
   // theta = 0 -> fully explicit, theta = 1 -> fully implicit
@@ -38,54 +50,160 @@ private:
   // eta = 1 -> first order heat conduction for power increment
   const double _eta;
 
+  // Optional table of the exponential coefficients on this time grid
+  Coefficients::ptr _coefficients;
+
+  // generation time at t = 0 for window parameters that do not store it
+  double _initial_gen_time = 0.;
+
+  // Pack the precursor histories into the time-major layout
+  static timeBins packDecayConstants(const precBins<Precursor::ptr>& precursors);
+  static timeBins packDelayedFractions(const precBins<Precursor::ptr>& precursors);
+
+  // Time stride of a packed array, zero when it holds a single step
+  const precIndex packedStride(const timeBins& packed) const {
+    return packed.size() == _n_precursors ? 0 : _n_precursors;
+  }
+
+  // Precursors interpolated onto the points of interpolate
+  precBins<Precursor::ptr>
+  interpolatePrecursors(const util::Interpolation& interpolate) const;
+
+  // Index of group k at time index n in a packed array, checking n
+  const std::size_t packedIndex(const precIndex stride,
+				const precIndex k,
+				const timeIndex n) const {
+    if (n - _n_offset >= _time.size()) {
+      throw std::out_of_range("epke::EPKEParameters time index");
+    }
+    return (n - _n_offset) * stride + k;
+  }
+
 public:
-  EPKEParameters(const timeBins& time,
+  EPKEParameters(const util::Series& time,
 		 const precBins<Precursor::ptr>& precursors,
-		 const timeBins& rho_imp,
-		 const timeBins& gen_time,
-		 const timeBins& pow_norm,
-		 const timeBins& beta_eff,
-		 const timeBins& lambda_h,
+		 const util::Series& rho_imp,
+		 const util::Series& gen_time,
+		 const util::Series& pow_norm,
+		 const util::Series& beta_eff,
+		 const util::Series& lambda_h,
 		 const double theta,
 		 const double gamma_d,
-		 const double eta)
-    : SolverParameters(time),
-      _precursors(precursors),
+		 const double eta,
+		 const timeIndex n_offset = 0)
+    : SolverParameters(time, n_offset),
       _rho_imp(rho_imp),
       _gen_time(gen_time),
       _pow_norm(pow_norm),
       _beta_eff(beta_eff),
       _lambda_h(lambda_h),
+      _n_precursors(precursors.size()),
+      _decay_constants(packDecayConstants(precursors)),
+      _delayed_fractions(packDelayedFractions(precursors)),
+      _decay_stride(packedStride(_decay_constants)),
+      _fraction_stride(packedStride(_delayed_fractions)),
       _theta(theta),
       _gamma_d(gamma_d),
       _eta(eta) {}
 
-  // Getters
-  const double getTheta()                    const { return _theta;           }
-  const double getGammaD()                   const { return _gamma_d;         }
-  const double getEta()                      const { return _eta;             }
-  const double getRhoImp(const timeIndex n)  const { return _rho_imp.at(n);   }
-  const double getGenTime(const timeIndex n) const { return _gen_time.at(n);  }
-  const double getPowNorm(const timeIndex n) const { return _pow_norm.at(n);  }
-  const double getBetaEff(const timeIndex n) const { return _beta_eff.at(n);  }
-  const double getLambdaH(const timeIndex n) const { return _lambda_h.at(n);  }
+  // Getters, taking global time indices
+  const double getTheta()  const { return _theta;   }
+  const double getGammaD() const { return _gamma_d; }
+  const double getEta()    const { return _eta;     }
+  const double getRhoImp(const timeIndex n)  const {
+    return _rho_imp.at(n - _n_offset);
+  }
+  const double getGenTime(const timeIndex n) const {
+    return _gen_time.at(n - _n_offset);
+  }
+  const double getPowNorm(const timeIndex n) const {
+    return _pow_norm.at(n - _n_offset);
+  }
+  const double getBetaEff(const timeIndex n) const {
+    return _beta_eff.at(n - _n_offset);
+  }
+  const double getLambdaH(const timeIndex n) const {
+    return _lambda_h.at(n - _n_offset);
+  }
+
+  // generation time at t = 0, which every step reads
+  const double getInitialGenTime() const {
+    return _n_offset == 0 ? _gen_time.at(0) : _initial_gen_time;
+  }
+  void setInitialGenTime(const double val) { _initial_gen_time = val; }
 
   const precIndex getNumPrecursors() const override {
-    return _precursors.size();
+    return _n_precursors;
   }
 
   const double getDelayedFraction(precIndex k, timeIndex n) const {
-    return _precursors.at(k)->delayedFraction(n);
+    return _delayed_fractions.at(packedIndex(_fraction_stride, k, n));
   }
 
   const double getDecayConstant(precIndex k, timeIndex n) const {
-    return _precursors.at(k)->decayConstant(n);
+    return _decay_constants.at(packedIndex(_decay_stride, k, n));
   }
 
-  // Interpolate parameters for the fine time mesh
-  virtual Base::ptr interpolateImpl(const timeBins& fine_time) const override;
+  // Values of all groups at time index n, stored contiguously
+  const double* getDelayedFractionsAt(timeIndex n) const {
+    return _delayed_fractions.data() + (n - _n_offset) * _fraction_stride;
+  }
+
+  const double* getDecayConstantsAt(timeIndex n) const {
+    return _decay_constants.data() + (n - _n_offset) * _decay_stride;
+  }
+
+  // Views of the stored history of group k
+  const util::StridedView getDelayedFractions(precIndex k) const {
+    return util::StridedView(_delayed_fractions.data() + k,
+			     _fraction_stride,
+			     _time.size());
+  }
+
+  const util::StridedView getDecayConstants(precIndex k) const {
+    return util::StridedView(_decay_constants.data() + k,
+			     _decay_stride,
+			     _time.size());
+  }
+
+  // Whether every decay constant and lambda_h is constant in time
+  const bool hasConstantDecay() const {
+    return _decay_stride == 0 && _lambda_h.isConstant();
+  }
+
+  // Build the coefficient table so that solvers stop re-evaluating exp()
+  void buildCoefficients() {
+    _coefficients = std::make_shared<const Coefficients>(*this);
+  }
+
+  // Use the table of other parameters with the same time grid, decay
+  // constants and lambda_h
+  void shareCoefficients(const EPKEParameters& other) {
+    _coefficients = other._coefficients;
+  }
+
+  const bool hasCoefficients() const { return _coefficients != nullptr; }
 
-  void writeToXML(pugi::xml_document& doc) const override;
+  const Coefficients& getCoefficients() const { return *_coefficients; }
+
+  // Interpolate parameters for the fine time mesh
+  virtual Base::ptr interpolateImpl(const util::Series& fine_time) const override;
+
+  // Interpolate a window of the fine grid, with the same values as the
+  // full interpolation, so that only the window is ever held in memory
+  virtual Base::ptr interpolateWindowImpl(const double    t_start,
+					  const double    t_end,
+					  const timeIndex n_fine,
+					  const timeIndex n_offset,
+					  const timeIndex n_stop) const override;
+
+  // Stream an epke_input element, precursors included
+  void writeToXML(util::XMLWriter& writer) const override;
+
+  // Add the time series, with one decay_constant_k and delayed_fraction_k
+  // array per group. theta, gamma_d and eta stay in the xml input.
+  void writeToBinary(util::BinaryWriter& writer,
+		     const std::string& prefix = "") const override;
 };
 
 } // namespace epke
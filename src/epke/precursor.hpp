@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "parareal/definitions.hpp"
+#include "utility/series.hpp"
 
 namespace epke {
 
@@ -14,15 +15,16 @@ namespace epke {
     using ptr       = std::shared_ptr<Precursor>;
 
   private:
-    const timeBins _decay_constant; // lambda
-    const timeBins _delayed_fraction; // beta
+    const util::Series _decay_constant; // lambda
+    const util::Series _delayed_fraction; // beta
   public:
-    Precursor(const timeBins& decay_constant, const timeBins& delayed_fraction )
+    Precursor(const util::Series& decay_constant,
+	      const util::Series& delayed_fraction)
       : _decay_constant(decay_constant), _delayed_fraction(delayed_fraction) {}
 
     // accessors
-    const timeBins &decayConstant() const { return _decay_constant; }
-    const timeBins &delayedFraction() const { return _delayed_fraction; }
+    const util::Series &decayConstant() const { return _decay_constant; }
+    const util::Series &delayedFraction() const { return _delayed_fraction; }
 
     const double decayConstant(timeIndex n) const {
       return _decay_constant.at(n);
@@ -1,127 +1,159 @@
+#include <array>
+#include <stdexcept>
+#include <string>
+
 #include "epke/solver.hpp"
 #include "utility/interpolate.hpp"
 
 using namespace epke;
 
 Solver::Solver(const Params::ptr params, const Output::ptr solution)
-  : para::Solver(params, solution), _params(params), _solution(solution) {}
+  : para::Solver(params, solution),
+    _params(params),
+    _solution(solution),
+    _omega(params->getNumPrecursors(), 0.),
+    _zeta_hat(params->getNumPrecursors(), 0.) {}
 
 const double Solver::computeDT(const timeIndex n) const {
-  return n > 0 ? _params->getTime(n) - _params->getTime(n-1) :
-    _params->getTime(n+1) - _params->getTime(n);
+  return _params->computeDT(n);
 }
 
 const double Solver::computeGamma(const timeIndex n) const {
-  return n < 2 ? 1.0 : computeDT(n-1) / computeDT(n);
+  return _params->computeGamma(n);
 }
 
-const double Solver::computeOmega(const precIndex j,
-				  const timeIndex n) const {
-  using util::omegaN;
+const Coefficients::Entry Solver::getCoefficients(const precIndex c,
+						  const timeIndex n) const {
+  if (_params->hasCoefficients()) {
+    return _params->getCoefficients().get(c, n);
+  }
 
-  const auto lj    = _params->getDecayConstant(j,n);
-  const auto dt    = computeDT(n);
-  const auto gamma = computeGamma(n);
+  // channel c is a precursor group, or heat conduction past the last group
+  const auto lambda = c < _params->getNumPrecursors() ?
+    _params->getDecayConstant(c,n) : _params->getLambdaH(n);
 
-  return _params->getGenTime(0) / _params->getGenTime(n) *
-    _params->getDelayedFraction(j,n) / lj * omegaN(lj, dt, gamma);
+  return Coefficients::compute(lambda, computeDT(n), computeGamma(n));
 }
 
-const double Solver::computeZetaHat(const precIndex j,
-				    const timeIndex n) const {
-  using util::E, util::omegaN1, util::omegaN2;
+template <para::precIndex G>
+void Solver::computeGroupTerms(const timeIndex n,
+			       double* omega,
+			       double* zeta_hat) const {
+  const precIndex n_groups = G > 0 ? G : _params->getNumPrecursors();
 
-  double beta_prev_prev, power_prev_prev, gen_time_prev_prev;
+  // values shared by every group at this step
+  const auto gen_time_0    = _params->getInitialGenTime();
+  const auto gen_time      = _params->getGenTime(n);
+  const auto gen_time_prev = _params->getGenTime(n-1);
+  const auto power_prev    = getPower(n-1);
 
-  const auto lj    = _params->getDecayConstant(j,n);
-  const auto dt    = computeDT(n);
-  const auto gamma = computeGamma(n);
+  const auto power_prev_prev    = n < 2 ? 0. : getPower(n-2);
+  const auto gen_time_prev_prev = n < 2 ? gen_time_0 : _params->getGenTime(n-2);
 
-  if (n < 2) {
-    beta_prev_prev = 0.;
-    power_prev_prev = 0.;
-    gen_time_prev_prev = _params->getGenTime(0);
-  } else {
-    beta_prev_prev = _params->getDelayedFraction(j,n-2);
-    power_prev_prev = getPower(n-2);
-    gen_time_prev_prev = _params->getGenTime(n-2);
-  }
+  // contiguous blocks of the group values at the steps this one reads
+  const double* lambda    = _params->getDecayConstantsAt(n);
+  const double* beta      = _params->getDelayedFractionsAt(n);
+  const double* beta_prev = _params->getDelayedFractionsAt(n-1);
+  const double* conc_prev = _solution->getConcentrationsAt(n-1);
+
+  const double* beta_prev_prev = n < 2 ? nullptr :
+    _params->getDelayedFractionsAt(n-2);
+
+  for (precIndex j = 0; j < n_groups; j++) {
+    const auto lj    = lambda[j];
+    const auto coeff = getCoefficients(j, n);
 
-  return E(lj, dt) * getConcentration(j, n-1) +
-    1. / lj * _params->getGenTime(0) * getPower(n - 1) *
-    _params->getDelayedFraction(j,n-1) / _params->getGenTime(n - 1) *
-    omegaN1(lj, dt, gamma) +
-    1. / lj * _params->getGenTime(0) * power_prev_prev * beta_prev_prev /
-    gen_time_prev_prev * omegaN2(lj, dt, gamma);
+    const auto beta_pp = n < 2 ? 0. : beta_prev_prev[j];
+
+    omega[j] = gen_time_0 / gen_time * beta[j] / lj * coeff.omega_n;
+
+    zeta_hat[j] = coeff.E * conc_prev[j] +
+      1. / lj * gen_time_0 * power_prev * beta_prev[j] / gen_time_prev *
+      coeff.omega_n1 +
+      1. / lj * gen_time_0 * power_prev_prev * beta_pp /
+      gen_time_prev_prev * coeff.omega_n2;
+  }
 }
 
 const double Solver::computeA1(const timeIndex n) const {
-  using util::omegaN;
-
   // define local variables to avoid numerous function calls
   const auto lh    = _params->getLambdaH(n);
-  const auto dt    = computeDT(n);
-  const auto gamma = computeGamma(n);
+  const auto coeff = getCoefficients(_params->getNumPrecursors(), n);
 
-  return _params->getGammaD() * _params->getPowNorm(n) / lh *
-    omegaN(lh, dt, gamma);
+  return _params->getGammaD() * _params->getPowNorm(n) / lh * coeff.omega_n;
 }
 
 const double Solver::computeB1(const timeIndex n) const {
-  using util::k0, util::E, util::omegaN1, util::omegaN2;
-
   // define local variables to avoid numerous function calls
   const auto lh    = _params->getLambdaH(n);
-  const auto dt    = computeDT(n);
-  const auto gamma = computeGamma(n);
+  const auto coeff = getCoefficients(_params->getNumPrecursors(), n);
 
   // we have to set these values so we don't get an out of range vector
   const auto H_prev_prev = n < 2 ? 0. : _params->getPowNorm(n-2) * getPower(n-2);
 
-  return _params->getRhoImp(n) + E(lh, dt) * (getRho(n-1) -
-					      _params->getRhoImp(n-1)) -
-    1. / lh * getPower(0) * _params->getGammaD() *
-    _params->getEta() * k0(lh, dt) +
+  return _params->getRhoImp(n) + coeff.E * (getRho(n-1) -
+					    _params->getRhoImp(n-1)) -
+    1. / lh * _solution->getInitialPower() * _params->getGammaD() *
+    _params->getEta() * coeff.k0 +
     _params->getGammaD() / lh * (_params->getPowNorm(n-1) * getPower(n - 1) *
-				 omegaN1(lh, dt, gamma) +
-				 H_prev_prev * omegaN2(lh, dt, gamma));
+				 coeff.omega_n1 +
+				 H_prev_prev * coeff.omega_n2);
 }
 
-const double Solver::computePower(const timeIndex n, const double alpha) const {
+template <para::precIndex G>
+const double Solver::computePower(const timeIndex n,
+				  const double alpha,
+				  const double a1,
+				  const double b1,
+				  const double* omega,
+				  const double* zeta_hat) const {
+  const precIndex n_groups = G > 0 ? G : _params->getNumPrecursors();
   const auto dt = computeDT(n);
 
+  const double* lambda      = _params->getDecayConstantsAt(n);
+  const double* lambda_prev = _params->getDecayConstantsAt(n-1);
+  const double* conc_prev   = _solution->getConcentrationsAt(n-1);
+
   // accumulate the weighted sums
   double tau = 0.0, s_hat_d = 0.0, s_d_prev = 0.0;
-  for (precIndex j = 0; j < _params->getNumPrecursors(); j++) {
-    tau += _params->getDecayConstant(j,n) * computeOmega(j, n);
-    s_hat_d += _params->getDecayConstant(j,n) * computeZetaHat(j, n);
-    s_d_prev += _params->getDecayConstant(j,n-1) * getConcentration(j,n-1);
+  for (precIndex j = 0; j < n_groups; j++) {
+    tau += lambda[j] * omega[j];
+    s_hat_d += lambda[j] * zeta_hat[j];
+    s_d_prev += lambda_prev[j] * conc_prev[j];
   }
 
   // compute the quadratic formula coefficients
-  double a = _params->getTheta() * dt * computeA1(n) / _params->getGenTime(n);
-  double b = _params->getTheta() * dt * (((computeB1(n) - _params->getBetaEff(n))
+  double a = _params->getTheta() * dt * a1 / _params->getGenTime(n);
+  double b = _params->getTheta() * dt * (((b1 - _params->getBetaEff(n))
 					/ _params->getGenTime(n) - alpha) +
-				       tau / _params->getGenTime(0)) - 1;
-  double c = _params->getTheta() * dt / _params->getGenTime(0) * s_hat_d +
+				       tau / _params->getInitialGenTime()) - 1;
+  double c = _params->getTheta() * dt / _params->getInitialGenTime() * s_hat_d +
     exp(alpha * dt) * ((1 - _params->getTheta()) * dt *
 		       (((getRho(n - 1) - _params->getBetaEff(n - 1)) /
 			 _params->getGenTime(n - 1) -
 			 alpha) * getPower(n - 1) + s_d_prev /
-			_params->getGenTime(0)) +
+			_params->getInitialGenTime()) +
 		       getPower(n - 1));
 
-  // TODO: Add a quadratic formula util method to take care of this
   if (a < 0) {
-    return (-b - sqrt(b * b - 4 * a * c)) / (2 * a);
+    return util::powerRoot(a, b, c);
   } else if (a == 0) {
     return -c / b;
   } else {
-    throw;
+    throw std::runtime_error("The power equation has no root at step " +
+			     std::to_string(n));
   }
 }
 
-void Solver::step(const timeIndex n) {
+template <para::precIndex G>
+void Solver::stepGroups(const timeIndex n) {
+  const precIndex n_groups = G > 0 ? G : _params->getNumPrecursors();
+
+  // fixed group counts keep the scratch on the stack
+  std::array<double, G> omega_fixed, zeta_hat_fixed;
+  double* omega    = G > 0 ? omega_fixed.data()    : _omega.data();
+  double* zeta_hat = G > 0 ? zeta_hat_fixed.data() : _zeta_hat.data();
+
   // compute the transformation parameter
   double alpha = n > 1 ?
     1 / computeDT(n - 1) * log(getPower(n - 1) / getPower(n - 2)) : 0.0;
@@ -129,19 +161,91 @@ void Solver::step(const timeIndex n) {
   // set solution time at this time step
   _solution->setTime(n, _params->getTime(n));
 
+  // the group terms and feedback coefficients only depend on earlier steps,
+  // so they are evaluated once and reused for the power and the updates
+  computeGroupTerms<G>(n, omega, zeta_hat);
+  const double a1 = computeA1(n);
+  const double b1 = computeB1(n);
+
   // evaluate the power and normalization factor at this time step
-  _solution->setPower(n, computePower(n, alpha));
+  const double power = computePower<G>(n, alpha, a1, b1, omega, zeta_hat);
+  _solution->setPower(n, power);
   _solution->setPowNorm(n, _params->getPowNorm(n));
 
   // update the precursor concentrations
-  for (precIndex j = 0; j < _params->getNumPrecursors(); j++) {
-    _solution->setConcentration(j, n,
-				getPower(n) * computeOmega(j,n) +
-				computeZetaHat(j,n));
+  double* conc = _solution->getConcentrationsAt(n);
+  for (precIndex j = 0; j < n_groups; j++) {
+    conc[j] = power * omega[j] + zeta_hat[j];
   }
 
   // update the full power and reactivity vectors
-  _solution->setRho(n, computeA1(n) * getPower(n) + computeB1(n));
+  _solution->setRho(n, a1 * power + b1);
+}
+
+template void Solver::stepGroups<0>(const timeIndex n);
+template void Solver::stepGroups<6>(const timeIndex n);
+template void Solver::stepGroups<8>(const timeIndex n);
+
+template <para::precIndex G>
+void Solver::stepPromptJump(const timeIndex n) {
+  const precIndex n_groups = G > 0 ? G : _params->getNumPrecursors();
+
+  std::array<double, G> omega_fixed, zeta_hat_fixed;
+  double* omega    = G > 0 ? omega_fixed.data()    : _omega.data();
+  double* zeta_hat = G > 0 ? zeta_hat_fixed.data() : _zeta_hat.data();
+
+  computeGroupTerms<G>(n, omega, zeta_hat);
+  const double a1 = computeA1(n);
+  const double b1 = computeB1(n);
+
+  // the delayed source at n is tau * power + s_hat_d
+  const double* lambda = _params->getDecayConstantsAt(n);
+
+  double tau = 0.0, s_hat_d = 0.0;
+  for (precIndex j = 0; j < n_groups; j++) {
+    tau += lambda[j] * omega[j];
+    s_hat_d += lambda[j] * zeta_hat[j];
+  }
+
+  // 0 = (rho - beta) / gen_time * power + source / gen_time_0, with the
+  // reactivity rho = a1 * power + b1
+  const double gen_time   = _params->getGenTime(n);
+  const double gen_time_0 = _params->getInitialGenTime();
+
+  const double a = a1 / gen_time;
+  const double b = (b1 - _params->getBetaEff(n)) / gen_time + tau / gen_time_0;
+  const double c = s_hat_d / gen_time_0;
+
+  double power;
+
+  if (a < 0) {
+    power = util::powerRoot(a, b, c);
+  } else if (a == 0 && b < 0) {
+    power = -c / b;
+  } else {
+    // at or above prompt critical without feedback to bound the power
+    stepGroups<G>(n);
+    return;
+  }
+
+  _solution->setTime(n, _params->getTime(n));
+  _solution->setPower(n, power);
+  _solution->setPowNorm(n, _params->getPowNorm(n));
+
+  double* conc = _solution->getConcentrationsAt(n);
+  for (precIndex j = 0; j < n_groups; j++) {
+    conc[j] = power * omega[j] + zeta_hat[j];
+  }
+
+  _solution->setRho(n, a1 * power + b1);
+}
+
+template void Solver::stepPromptJump<0>(const timeIndex n);
+template void Solver::stepPromptJump<6>(const timeIndex n);
+template void Solver::stepPromptJump<8>(const timeIndex n);
+
+void Solver::step(const timeIndex n) {
+  stepGroups<0>(n);
 }
 
 void Solver::solve() {
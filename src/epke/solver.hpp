@@ -1,7 +1,10 @@
 #ifndef _EPKE_SOLVER_HEADER_
 #define _EPKE_SOLVER_HEADER_
 
+#include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "parareal/solver.hpp"
 #include "parareal/definitions.hpp"
@@ -29,12 +32,27 @@ namespace epke {
     // Power, reactivity and concentrations
     Output::ptr _solution;
 
-    // private methods
-    const double computeOmega(const precIndex j, const timeIndex n) const;
-
-    const double computeZetaHat(const precIndex j, const timeIndex n) const;
+    // Scratch space for the per-group terms of the current step
+    timeBins _omega;    // weight of the power at n in each concentration
+    timeBins _zeta_hat; // contribution of the history to each concentration
 
-    const double computePower(const timeIndex n, const double alpha) const;
+    // private methods
+    const Coefficients::Entry getCoefficients(const precIndex c,
+					      const timeIndex n) const;
+
+    // Evaluate omega and zeta-hat of every group at step n, once per step
+    template <precIndex G>
+    void computeGroupTerms(const timeIndex n,
+			   double* omega,
+			   double* zeta_hat) const;
+
+    template <precIndex G>
+    const double computePower(const timeIndex n,
+			      const double alpha,
+			      const double a1,
+			      const double b1,
+			      const double* omega,
+			      const double* zeta_hat) const;
 
     const double computeA1(const timeIndex n) const;
 
@@ -56,6 +74,17 @@ namespace epke {
       return _solution->getRho(n);
     }
 
+  protected:
+    // Advance one time step with G precursor groups known at compile time, or
+    // with the runtime number of groups when G is 0
+    template <precIndex G>
+    void stepGroups(const timeIndex n);
+
+    // Advance one time step under the prompt jump approximation, falling back
+    // to stepGroups when it has no positive power
+    template <precIndex G>
+    void stepPromptJump(const timeIndex n);
+
   public:
     Solver(Params::ptr parameters, Output::ptr solution);
 
@@ -69,12 +98,58 @@ namespace epke {
       baseReset(solution);
     }
 
+    // Reset the parameters too, e.g. to the parameters of a single window
+    void reset(Params::ptr parameters, Output::ptr solution) {
+      _params = parameters;
+      base::_params = parameters;
+      reset(solution);
+    }
+
     // Advance one time step
     void step(const timeIndex n) override;
 
     // Solve the epke problem
     void solve() override;
   }; // class Solver
+
+  // Solver specialized on the number of precursor groups, so the group loops
+  // have a constant trip count and the per-step scratch lives on the stack.
+  // Instantiated for the 6 and 8 group sets in solver.cpp.
+  template <para::precIndex G>
+  class FixedSolver : public Solver {
+  public:
+    using ptr = std::shared_ptr<FixedSolver<G>>;
+
+    FixedSolver(Params::ptr parameters, Output::ptr solution)
+      : Solver(parameters, solution) {
+      if (parameters->getNumPrecursors() != G) {
+	throw std::runtime_error("FixedSolver expects " + std::to_string(G) +
+				 " precursor groups but got " +
+				 std::to_string(parameters->getNumPrecursors()));
+      }
+    }
+
+    void step(const timeIndex n) override { stepGroups<G>(n); }
+  }; // class FixedSolver
+
+  // Cheaper coarse propagator for parareal. The prompt jump approximation
+  // drops the derivative of the power, so each step solves the balance of
+  // the prompt and delayed neutrons at the end of the step instead of
+  // integrating the power across it. That skips the exponential transform
+  // and the history terms of the power, while the precursor groups and the
+  // feedback are advanced as in Solver, so the full state is kept at every
+  // coarse boundary. G is 0 for the runtime number of groups, or one of the
+  // group counts of FixedSolver.
+  template <para::precIndex G>
+  class PromptJumpSolver : public Solver {
+  public:
+    using ptr = std::shared_ptr<PromptJumpSolver<G>>;
+
+    PromptJumpSolver(Params::ptr parameters, Output::ptr solution)
+      : Solver(parameters, solution) {}
+
+    void step(const timeIndex n) override { stepPromptJump<G>(n); }
+  }; // class PromptJumpSolver
 } // namespace epke
 
 #endif
@@ -1,10 +1,95 @@
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "parareal/batch.hpp"
 #include "parareal/input.hpp"
+#include "parareal/service.hpp"
+
+#ifdef PARA_USE_MPI
+#include <mpi.h>
+#endif
+
+// Answer framed inputs on stdin and stdout, or on the Unix socket given
+// after --serve, instead of running a single input file
+static void serve(int argc, char *argv[]) {
+  const char* tmpdir = std::getenv("TMPDIR");
+  Service service(std::string(tmpdir ? tmpdir : "/tmp") + "/epke-serve-" +
+		  std::to_string(::getpid()) + ".epkb");
+
+  if (argc > 2) {
+    service.listen(argv[2]);
+    return;
+  }
+
+  // stdout carries the responses, so the log goes to stderr
+  std::streambuf* log = std::cout.rdbuf(std::cerr.rdbuf());
+  service.serve(STDIN_FILENO, STDOUT_FILENO);
+  std::cout.rdbuf(log);
+}
+
+// Run the input files and manifests given after --batch together, on the
+// number of cores given by --cores or else every hardware thread, writing
+// the timing of each case to the file given by --report
+static int runBatch(int argc, char *argv[]) {
+  unsigned n_cores = std::thread::hardware_concurrency();
+  std::string report;
+  std::vector<std::string> paths;
+
+  for (int i = 2; i < argc; i++) {
+    const std::string arg = argv[i];
+
+    if (arg == "--cores" && i + 1 < argc) {
+      n_cores = std::stoi(argv[++i]);
+    } else if (arg == "--report" && i + 1 < argc) {
+      report = argv[++i];
+    } else if (arg.size() > 4 && arg.compare(arg.size() - 4, 4, ".xml") == 0) {
+      paths.push_back(arg);
+    } else {
+      for (const auto& path : Batch::loadManifest(arg)) { paths.push_back(path); }
+    }
+  }
+
+  Batch batch(paths, n_cores);
+  batch.run();
+
+  if (!report.empty()) {
+    std::cout << "Writing batch report to " << report << std::endl;
+    batch.writeReport(report);
+  }
+
+  return batch.getNumFailed() > 0 ? 1 : 0;
+}
 
 int main( int argc , char *argv[] ) {
+#ifdef PARA_USE_MPI
+  MPI_Init(&argc, &argv);
+#endif
+
+  int status = 0;
+
   // read the command line
-  if ( argc > 1 ) {
-    auto input = Input(argv[1]);
-    input.execute();
+  try {
+    if ( argc > 1 && std::string(argv[1]) == "--serve" ) {
+      serve(argc, argv);
+    } else if ( argc > 1 && std::string(argv[1]) == "--batch" ) {
+      status = runBatch(argc, argv);
+    } else if ( argc > 1 ) {
+      auto input = Input(argv[1]);
+      input.execute();
+    }
+  } catch (const std::exception& error) {
+    std::cout << error.what() << std::endl;
+    status = 1;
   }
-  return 0;
+
+#ifdef PARA_USE_MPI
+  MPI_Finalize();
+#endif
+  return status;
 }
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "parareal/batch.hpp"
+#include "pugi/pugixml.hpp"
+#include "utility/xml_writer.hpp"
+
+// Case run by the current thread, which prefixes its log lines
+static thread_local const std::string* case_label = nullptr;
+static thread_local std::string        case_line;
+
+// Writes the log one whole line at a time, so that the cases running at once
+// do not interleave their messages
+class CaseLog : public std::streambuf {
+private:
+  std::streambuf* _log;
+  std::mutex      _mutex;
+
+  void writeLine() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (case_label) {
+      _log->sputc('[');
+      _log->sputn(case_label->data(), case_label->size());
+      _log->sputn("] ", 2);
+    }
+    _log->sputn(case_line.data(), case_line.size());
+    case_line.clear();
+  }
+
+protected:
+  int overflow(const int c) override {
+    if (c == traits_type::eof()) { return traits_type::not_eof(c); }
+    case_line.push_back(c);
+    if (c == '\n') { writeLine(); }
+    return c;
+  }
+
+  std::streamsize xsputn(const char* data, const std::streamsize n) override {
+    for (std::streamsize i = 0; i < n; i++) { overflow(data[i]); }
+    return n;
+  }
+
+  int sync() override {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _log->pubsync();
+  }
+
+public:
+  CaseLog(std::streambuf* log) : _log(log) {}
+};
+
+Batch::Batch(const std::vector<std::string>& paths, const unsigned n_cores)
+  : _n_cores(std::max(n_cores, 1u)), _n_free(_n_cores) {
+  for (const auto& path : paths) {
+    Case c;
+    c.path = path;
+    _cases.push_back(c);
+  }
+}
+
+std::vector<std::string> Batch::loadManifest(const std::string& path) {
+  std::ifstream manifest(path);
+
+  if (!manifest) {
+    throw std::runtime_error("Could not open manifest " + path);
+  }
+
+  const std::size_t slash = path.find_last_of('/');
+  const std::string directory =
+    slash == std::string::npos ? "" : path.substr(0, slash + 1);
+
+  std::vector<std::string> paths;
+  std::string line;
+
+  while (std::getline(manifest, line)) {
+    line.erase(0, line.find_first_not_of(" \t"));
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+
+    if (line.empty() || line[0] == '#') { continue; }
+    paths.push_back(line[0] == '/' ? line : directory + line);
+  }
+
+  return paths;
+}
+
+const std::size_t Batch::getNumFailed() const {
+  return std::count_if(_cases.begin(), _cases.end(),
+		       [](const Case& c) { return c.failed; });
+}
+
+void Batch::acquire(const unsigned n) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _released.wait(lock, [&] { return _n_free >= n; });
+  _n_free -= n;
+}
+
+void Batch::release(const unsigned n) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _n_free += n;
+  }
+  _released.notify_all();
+}
+
+void Batch::run() {
+  using timer = std::chrono::steady_clock;
+
+  CaseLog log(std::cout.rdbuf());
+  std::streambuf* stdout_buffer = std::cout.rdbuf(&log);
+
+  std::cout << "Running " << _cases.size() << " cases on " << _n_cores
+	    << " cores" << std::endl;
+
+  const timer::time_point batch_start = timer::now();
+  std::vector<std::thread> running;
+
+  for (auto& c : _cases) {
+    case_label = &c.path;
+
+    // inputs are parsed here while earlier cases run
+    auto input_file = std::make_shared<pugi::xml_document>();
+    const pugi::xml_parse_result load_result = input_file->load_file(c.path.c_str());
+    const pugi::xml_node parareal_node = input_file->child("parareal");
+
+    if (!load_result || !parareal_node) {
+      c.failed = true;
+      c.error  = load_result ? "The input has no parareal node" : load_result.description();
+      std::cout << "Failed: " << c.error << std::endl;
+      continue;
+    }
+
+    if (std::string(parareal_node.attribute("backend").value()) == "mpi") {
+      c.failed = true;
+      c.error  = "The mpi backend does not run in a batch";
+      std::cout << "Failed: " << c.error << std::endl;
+      continue;
+    }
+
+    // ensembles and adaptive solves run on one thread
+    const bool serial = parareal_node.child("ensemble") ||
+      parareal_node.child("epke_input").attribute("adaptive").as_bool(false);
+    const int n_threads = serial ? 1 : parareal_node.attribute("n_threads").as_int(1);
+    c.n_threads = std::min<unsigned>(std::max(n_threads, 1), _n_cores);
+
+    acquire(c.n_threads);
+
+    running.emplace_back([this, &c, input_file]() {
+      case_label = &c.path;
+      const timer::time_point case_start = timer::now();
+
+      try {
+	Input::execute(*input_file, &_cache);
+      } catch (const std::exception& error) {
+	c.failed = true;
+	c.error  = error.what();
+      } catch (...) {
+	c.failed = true;
+	c.error  = "Unknown error";
+      }
+
+      const std::chrono::duration<double> duration = timer::now() - case_start;
+      c.wall_time = duration.count();
+
+      if (c.failed) {
+	std::cout << "Failed after " << c.wall_time << " s: " << c.error << std::endl;
+      } else {
+	std::cout << "Completed in " << c.wall_time << " s on " << c.n_threads
+		  << " threads" << std::endl;
+      }
+
+      release(c.n_threads);
+    });
+  }
+
+  case_label = nullptr;
+
+  for (auto& thread : running) { thread.join(); }
+
+  const std::chrono::duration<double> duration = timer::now() - batch_start;
+  _wall_time = duration.count();
+
+  std::cout << "Completed " << _cases.size() - getNumFailed() << " of "
+	    << _cases.size() << " cases in " << _wall_time << " s" << std::endl;
+
+  std::cout.rdbuf(stdout_buffer);
+}
+
+void Batch::writeReport(const std::string& path) const {
+  util::XMLWriter writer(path);
+
+  writer.open("batch");
+  writer.attribute("n_cases", _cases.size());
+  writer.attribute("n_failed", getNumFailed());
+  writer.attribute("n_cores", _n_cores);
+  writer.attribute("wall_time", _wall_time);
+
+  for (const auto& c : _cases) {
+    writer.open("case");
+    writer.attribute("path", c.path);
+    writer.attribute("n_threads", c.n_threads);
+    writer.attribute("wall_time", c.wall_time);
+    writer.attribute("status", c.failed ? "failed" : "completed");
+    if (c.failed) { writer.attribute("error", c.error); }
+    writer.close();
+  }
+
+  writer.close();
+  writer.finish();
+}
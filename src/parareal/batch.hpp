@@ -0,0 +1,60 @@
+#ifndef _PARAREAL_BATCH_HEADER_
+#define _PARAREAL_BATCH_HEADER_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "parareal/input.hpp"
+
+// Runs many independent input files on one node. Cases start in order as
+// soon as enough cores are free for the threads they ask for, the n_threads
+// of their parareal node, so the cases and their own worker threads never
+// hold more than the given number of cores between them. Cases with the
+// same parameters, grids or decay constants share them through the cache.
+class Batch {
+public:
+  struct Case {
+    std::string path;
+    unsigned    n_threads = 1;
+    double      wall_time = 0.; // from the start of the case to its outputs
+    bool        failed    = false;
+    std::string error;
+  };
+
+private:
+  const unsigned    _n_cores;
+  std::vector<Case> _cases;
+  Input::Cache      _cache;
+  double            _wall_time = 0.;
+
+  // cores not held by a running case
+  std::mutex              _mutex;
+  std::condition_variable _released;
+  unsigned                _n_free;
+
+  void acquire(const unsigned n);
+  void release(const unsigned n);
+
+public:
+  Batch(const std::vector<std::string>& paths, const unsigned n_cores);
+
+  // Input paths listed one per line, relative to the manifest. Blank lines
+  // and lines starting with # are skipped.
+  static std::vector<std::string> loadManifest(const std::string& path);
+
+  const std::vector<Case>& getCases() const { return _cases; }
+  const Input::Cache& getCache() const { return _cache; }
+  const double getWallTime() const { return _wall_time; }
+  const unsigned getNumCores() const { return _n_cores; }
+  const std::size_t getNumFailed() const;
+
+  // Run every case, reporting each as it completes
+  void run();
+
+  // Write the timing and status of every case to an xml document
+  void writeReport(const std::string& path) const;
+};
+
+#endif
@@ -1,29 +1,589 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "input.hpp"
 
 #include "parareal/parareal.hpp"
+#include "parareal/mpi_parareal.hpp"
+#include "parareal/mgrit.hpp"
+#include "parareal/output_spec.hpp"
+#include "epke/adaptive_solver.hpp"
+#include "epke/checkpoint.hpp"
+#include "epke/ensemble.hpp"
+#include "epke/mixed_solver.hpp"
 #include "epke/precursor.hpp"
 #include "epke/parameters.hpp"
 #include "epke/output.hpp"
 #include "epke/solver.hpp"
 #include "pugi/pugixml.hpp"
+#include "utility/binary_io.hpp"
 #include "utility/interpolate.hpp"
 #include "utility/load_data.hpp"
+#include "utility/profile.hpp"
+
+// Read the named series of a node, from its binary container when it has
+// one or else from the text of the child node, which may list only the
+// leading steps
+static timeBins loadSeries(const pugi::xml_node& node,
+			   const util::BinaryFile* binary,
+			   const std::string& name,
+			   const timeIndex n_steps) {
+  return binary ? binary->get(name, n_steps).toVector() :
+    util::loadHistoryData(node.child(name.c_str()), n_steps);
+}
+
+// Read the named parameter series of a node as loadSeries does, stored
+// compactly when it is constant or evenly spaced
+static util::Series loadParameter(const pugi::xml_node& node,
+				  const util::BinaryFile* binary,
+				  const std::string& name,
+				  const timeIndex n_steps) {
+  return binary ? util::Series::compact(binary->get(name, n_steps).toVector()) :
+    util::loadSeriesData(node.child(name.c_str()), n_steps);
+}
+
+// Open the binary container named by the file attribute of a node, if any
+static std::unique_ptr<util::BinaryFile> openBinary(const pugi::xml_node& node) {
+  if (!node.attribute("file")) { return nullptr; }
+  return std::make_unique<util::BinaryFile>(node.attribute("file").value());
+}
+
+// Outputs are binary when outpath has the binary extension or the node asks
+// for output_format="binary"
+static bool isBinaryOutput(const pugi::xml_node& node) {
+  return util::isBinaryPath(node.attribute("outpath").value()) ||
+    std::string(node.attribute("output_format").value()) == "binary";
+}
+
+// Create solver initial conditions from an epke_output node
+static epke::EPKEOutput::ptr loadOutput(const pugi::xml_node& precomp_node) {
+  const auto binary = openBinary(precomp_node);
+  timeIndex n_steps = precomp_node.attribute("n_steps")
+    .as_int(binary ? binary->get("time").size() : 0);
+
+  timeIndex n_start = precomp_node.attribute("n_start").as_int();
+  timeIndex n_stop  = precomp_node.attribute("n_stop").as_int();
+  timeBins time     = loadSeries(precomp_node, binary.get(), "time", n_steps);
+  timeBins power    = loadSeries(precomp_node, binary.get(), "power", n_steps);
+  timeBins pow_norm = loadSeries(precomp_node, binary.get(), "pow_norm", n_steps);
+  timeBins rho      = loadSeries(precomp_node, binary.get(), "rho", n_steps);
+  precBins<timeBins> concentrations;
+
+  if (binary) {
+    for (precIndex k = 0; binary->has("concentration_" + std::to_string(k)); k++) {
+      concentrations.push_back(
+	binary->get("concentration_" + std::to_string(k), n_steps).toVector());
+    }
+  } else {
+    concentrations =
+      util::loadZetas(precomp_node.child("concentrations"), n_steps);
+  }
+
+  return std::make_shared<epke::EPKEOutput>(n_start,
+					    n_stop,
+					    time,
+					    concentrations,
+					    power,
+					    pow_norm,
+					    rho);
+}
+
+// Read the number of threads of a parareal node, one unless it asks for more
+static para::paraIndex loadThreads(const pugi::xml_node& parareal_node) {
+  const int n_threads = parareal_node.attribute("n_threads").as_int(1);
+
+  if (n_threads < 1 || n_threads > 65535) {
+    throw std::runtime_error("Between 1 and 65535 threads are supported, not " +
+			     std::to_string(n_threads));
+  }
+
+  return n_threads;
+}
+
+// Read the values an output node asks to keep of the solution: every stride-th
+// step, or the solution interpolated to the times of its time child, of the
+// quantities it lists. Without an output node the whole solution is kept.
+static para::OutputSpec loadOutputSpec(const pugi::xml_node& output_node) {
+  para::OutputSpec spec;
+  if (!output_node) { return spec; }
+
+  spec.stride = output_node.attribute("stride").as_uint(1);
+  if (spec.stride == 0) {
+    throw std::runtime_error("The output stride must be at least 1");
+  }
+
+  if (output_node.child("time")) {
+    spec.times = util::loadVectorData(output_node.child("time"));
+    std::sort(spec.times.begin(), spec.times.end());
+  }
+
+  std::istringstream quantities(output_node.attribute("quantities").value());
+  for (std::string quantity; quantities >> quantity; ) {
+    if (quantity != "power" && quantity != "pow_norm" && quantity != "rho" &&
+	quantity != "concentrations") {
+      throw std::runtime_error("Unknown output quantity: " + quantity);
+    }
+    spec.quantities.push_back(quantity);
+  }
+
+  return spec;
+}
+
+// Write the output of a time-parallel solve, and its timing trace if asked
+template <typename TimeParallel>
+static void writeSolution(const pugi::xml_node& parareal_node,
+			  const TimeParallel& solver) {
+  // write the binary container or build the xml document
+  std::cout << "Writing output to " << solver.getOutpath() << std::endl;
+
+  {
+    UTIL_PROFILE_SCOPE("write_output");
+
+    if (isBinaryOutput(parareal_node)) {
+      solver.writeToBinary();
+    } else {
+      solver.writeToXML();
+    }
+  }
+
+  // every recorded phase as Chrome trace events
+  if (parareal_node.attribute("trace")) {
+#ifdef UTIL_PROFILE
+    const std::string trace_path = parareal_node.attribute("trace").value();
+    std::cout << "Writing timing trace to " << trace_path << std::endl;
+    util::Profiler::instance().writeChromeTrace(trace_path);
+#else
+    std::cout << "Timing traces require building with profile=1" << std::endl;
+#endif
+  }
+}
+
+// Step the input grid alone, as max_iterations="0" does, saving the solver
+// state every checkpoint_interval steps to the file named by checkpoint. When
+// restart names the checkpoints of a cached run, the solve resumes from the
+// last one before the parameters or initial conditions first differ, and only
+// that tail is written.
+template <typename Coarse>
+static void solveSerial(const pugi::xml_node& parareal_node,
+			typename Coarse::Params::ptr params,
+			typename Coarse::Output::ptr initial) {
+  using timer = std::chrono::steady_clock;
+
+  const std::string outpath = parareal_node.attribute("outpath").value();
+  const timeIndex interval =
+    parareal_node.attribute("checkpoint_interval").as_int(100);
+
+  epke::Checkpoint::ptr cached;
+  typename Coarse::Output::ptr solution = initial;
+
+  if (parareal_node.attribute("restart")) {
+    UTIL_PROFILE_SCOPE("restart");
+
+    cached = std::make_shared<epke::Checkpoint>(
+	       parareal_node.attribute("restart").value());
+
+    const timeIndex n_change = cached->findFirstChange(*params, *initial);
+    auto restart = cached->createRestart(*params, *initial, n_change);
+
+    if (restart) {
+      std::cout << "Resuming at step " << restart->getStartTimeIndex()
+		<< ", the inputs first change at step " << n_change << std::endl;
+      solution = restart;
+    } else {
+      std::cout << "No checkpoint before the inputs change at step " << n_change
+		<< ", solving from the start" << std::endl;
+      cached = nullptr;
+    }
+  }
+
+  Coarse solver(params, solution);
+
+  std::cout << "Solving..." << std::endl;
+
+  const timer::time_point clock_start = timer::now();
+  solver.solve();
+  const std::chrono::duration<double> duration = timer::now() - clock_start;
+  solution->setSolveTime(duration.count());
+
+  // the checkpoints need every step, so only the written output is recorded
+  const para::OutputSpec spec = loadOutputSpec(parareal_node.child("output"));
+  typename Coarse::Output::ptr output = solution;
+
+  if (!spec.isFull()) {
+    output = para::createRecord(solution);
+
+    // a resumed tail records from the step it resumed at
+    const timeIndex n_first = solution->getTimeOffset() == 0 ? 0 :
+      solution->getStartTimeIndex();
+    for (timeIndex n = n_first; n < solution->getNumTimeSteps(); n++) {
+      output->recordImpl(spec, *solution, n);
+    }
+  }
+
+  std::cout << "Writing output to " << outpath << std::endl;
+
+  {
+    UTIL_PROFILE_SCOPE("write_output");
+
+    if (isBinaryOutput(parareal_node)) {
+      util::BinaryWriter writer(outpath);
+      output->writeToBinary(writer);
+      writer.add("n_start", solution->getStartTimeIndex());
+      writer.write();
+    } else {
+      util::XMLWriter writer(outpath);
+      writer.open("parareal");
+      writer.attribute("solve_time", solution->getSolveTime());
+      writer.attribute("n_iterations", 0);
+      writer.attribute("n_start", solution->getStartTimeIndex());
+      output->writeToXML(writer);
+      writer.close();
+      writer.finish();
+    }
+  }
+
+  if (parareal_node.attribute("checkpoint")) {
+    UTIL_PROFILE_SCOPE("checkpoint");
+
+    const std::string path = parareal_node.attribute("checkpoint").value();
+    std::cout << "Writing checkpoints to " << path << std::endl;
+    epke::Checkpoint::write(path, *params, *solution, interval, cached.get());
+  }
+}
+
+// Build and run parareal with the given coarse and fine solver types
+template <typename Coarse, typename Fine>
+static void solveParareal(const pugi::xml_node& parareal_node,
+			  typename Coarse::Params::ptr coarse_params,
+			  typename Coarse::Output::ptr coarse_precomp,
+			  typename Fine::Params::ptr fine_params,
+			  typename Fine::Output::ptr fine_precomp) {
+  if (parareal_node.attribute("checkpoint") || parareal_node.attribute("restart")) {
+    if (parareal_node.attribute("max_iterations").as_int() != 0) {
+      throw std::runtime_error("Checkpoints and restarts need max_iterations=\"0\"");
+    }
+
+    solveSerial<Coarse>(parareal_node, coarse_params, coarse_precomp);
+    return;
+  }
+
+  typename Coarse::ptr coarse_solver =
+    std::make_shared<Coarse>(coarse_params, coarse_precomp);
+  typename Fine::ptr fine_solver =
+    std::make_shared<Fine>(fine_params, fine_precomp);
+
+  // Create the parareal solver
+  using Parareal = para::Parareal<Coarse, Fine>;
+
+  const std::string backend = parareal_node.attribute("backend").as_string("shared");
+  const std::string schedule = parareal_node.attribute("schedule").as_string("bulk");
+
+  if (schedule != "bulk" && schedule != "async") {
+    throw std::runtime_error("Unknown parareal schedule: " + schedule);
+  }
+
+  const para::OutputSpec spec = loadOutputSpec(parareal_node.child("output"));
+
+  std::unique_ptr<Parareal> parareal;
+
+  if (backend == "mpi" && !spec.isFull()) {
+    throw std::runtime_error("Output specs only run on the shared memory backend");
+  } else if (backend == "mpi" && schedule == "async") {
+    throw std::runtime_error("The async schedule only runs on the shared memory backend");
+  } else if (backend == "mpi") {
+#ifdef PARA_USE_MPI
+    parareal = std::make_unique<para::MPIParareal<Coarse, Fine>>(
+	     coarse_solver,
+	     fine_solver,
+	     fine_precomp,
+	     parareal_node.attribute("n_fine_per_coarse").as_int(),
+	     parareal_node.attribute("max_iterations").as_int(),
+	     parareal_node.attribute("outpath").value(),
+	     loadThreads(parareal_node),
+	     parareal_node.attribute("tolerance").as_double(0.),
+	     parareal_node.attribute("window_local").as_bool(true));
+#else
+    throw std::runtime_error("The mpi backend requires building with mpi=1");
+#endif
+  } else {
+    parareal = std::make_unique<Parareal>(
+	     coarse_solver,
+	     fine_solver,
+	     fine_precomp,
+	     parareal_node.attribute("n_fine_per_coarse").as_int(),
+	     parareal_node.attribute("max_iterations").as_int(),
+	     parareal_node.attribute("outpath").value(),
+	     loadThreads(parareal_node),
+	     parareal_node.attribute("tolerance").as_double(0.),
+	     parareal_node.attribute("window_local").as_bool(true),
+	     schedule == "async");
+  }
+
+  parareal->record(spec);
+
+  // fine_params then only hold the first window
+  if (std::string(parareal_node.attribute("fine_parameters").as_string("full"))
+      == "window") {
+    parareal->interpolateWindows(coarse_params, 0., coarse_params->getTime().back());
+  }
+
+  // Run the EPKE solver
+  std::cout << "Solving..." << std::endl;
+
+  parareal->solve();
+  std::cout << "Completed solve." << std::endl;
+
+  writeSolution(parareal_node, *parareal);
+}
+
+// Run MGRIT with the fine solver on every level
+template <typename Fine>
+static void solveMGRIT(const pugi::xml_node& parareal_node,
+		       typename Fine::Params::ptr fine_params,
+		       typename Fine::Output::ptr fine_precomp) {
+  const timeIndex n_fine_per_coarse =
+    parareal_node.attribute("n_fine_per_coarse").as_int();
+
+  const std::string relaxation =
+    parareal_node.attribute("relaxation").as_string("FCF");
+
+  if (relaxation != "F" && relaxation != "FCF") {
+    throw std::runtime_error("Unknown MGRIT relaxation: " + relaxation);
+  }
+
+  if (std::string(parareal_node.attribute("backend").as_string("shared"))
+      != "shared") {
+    throw std::runtime_error("MGRIT only runs on the shared memory backend");
+  }
+
+  if (std::string(parareal_node.attribute("fine_parameters").as_string("full"))
+      != "full") {
+    throw std::runtime_error("MGRIT needs the fine parameters of the whole grid");
+  }
+
+  if (parareal_node.attribute("checkpoint") || parareal_node.attribute("restart")) {
+    throw std::runtime_error("MGRIT does not write or restart from checkpoints");
+  }
+
+  if (parareal_node.child("output")) {
+    throw std::runtime_error("MGRIT writes the whole fine solution");
+  }
+
+  para::MGRIT<Fine> mgrit(
+	   fine_params,
+	   fine_precomp,
+	   parareal_node.attribute("coarsening").as_int(n_fine_per_coarse),
+	   parareal_node.attribute("max_levels").as_int(0),
+	   parareal_node.attribute("min_coarse").as_int(3),
+	   parareal_node.attribute("max_iterations").as_int(),
+	   parareal_node.attribute("outpath").value(),
+	   loadThreads(parareal_node),
+	   parareal_node.attribute("tolerance").as_double(0.),
+	   relaxation == "FCF");
+
+  std::cout << "Solving on " << mgrit.getNumLevels() << " levels ("
+	    << mgrit.getNumCoarsest() << " coarsest points)..." << std::endl;
+
+  mgrit.solve();
+  std::cout << "Completed solve in " << mgrit.getResiduals().size()
+	    << " iterations." << std::endl;
+
+  writeSolution(parareal_node, mgrit);
+}
+
+// Run parareal with the coarse propagator named by the coarse attribute,
+// "full" to step like the fine solver, "prompt_jump" for the cheaper steps
+// of PromptJump or "single" for the single precision steps of Single, or
+// MGRIT when method="mgrit"
+template <typename Fine, typename PromptJump, typename Single>
+static void solveTimeParallel(const pugi::xml_node& parareal_node,
+			      typename Fine::Params::ptr coarse_params,
+			      typename Fine::Output::ptr coarse_precomp,
+			      typename Fine::Params::ptr fine_params,
+			      typename Fine::Output::ptr fine_precomp) {
+  const std::string method = parareal_node.attribute("method").as_string("parareal");
+  const std::string coarse = parareal_node.attribute("coarse").as_string("full");
+
+  if (method == "mgrit") {
+    solveMGRIT<Fine>(parareal_node, fine_params, fine_precomp);
+  } else if (method != "parareal") {
+    throw std::runtime_error("Unknown time-parallel method: " + method);
+  } else if (coarse == "full") {
+    solveParareal<Fine, Fine>(
+	     parareal_node, coarse_params, coarse_precomp, fine_params, fine_precomp);
+  } else if (coarse == "prompt_jump") {
+    solveParareal<PromptJump, Fine>(
+	     parareal_node, coarse_params, coarse_precomp, fine_params, fine_precomp);
+  } else if (coarse == "single") {
+    solveParareal<Single, Fine>(
+	     parareal_node, coarse_params, coarse_precomp, fine_params, fine_precomp);
+  } else {
+    throw std::runtime_error("Unknown coarse propagator: " + coarse);
+  }
+}
+
+// Read the coarse parameters of an epke_input node, from xml or a binary
+// container
+static epke::EPKEParameters::ptr loadParameters(const pugi::xml_node& params_node) {
+  const auto binary = openBinary(params_node);
+  timeIndex n_steps = params_node.attribute("n_steps")
+    .as_int(binary ? binary->get("time").size() : 0);
+
+  util::Series time     = loadParameter(params_node, binary.get(), "time", n_steps);
+  util::Series rho_imp  = loadParameter(params_node, binary.get(), "rho_imp", n_steps);
+  util::Series gen_time = loadParameter(params_node, binary.get(), "gen_time", n_steps);
+  util::Series pow_norm = loadParameter(params_node, binary.get(), "pow_norm", n_steps);
+  util::Series beta_eff = loadParameter(params_node, binary.get(), "beta_eff", n_steps);
+  util::Series lambda_h = loadParameter(params_node, binary.get(), "lambda_h", n_steps);
+  double   theta    = params_node.attribute("theta").as_double();
+  double   gamma_d  = params_node.attribute("gamma_d").as_double();
+  double   eta      = params_node.attribute("eta").as_double();
+
+  // Create the precursors
+  const pugi::xml_node precs_node = params_node.child("precursors");
+  precBins<epke::Precursor::ptr> precursors;
+  util::Series lambda; util::Series beta;
+
+  if (binary) {
+    for (precIndex k = 0;
+	 binary->has("decay_constant_" + std::to_string(k)); k++) {
+      const std::string group = std::to_string(k);
+      lambda = loadParameter(params_node, binary.get(), "decay_constant_" + group, n_steps);
+      beta   = loadParameter(params_node, binary.get(), "delayed_fraction_" + group, n_steps);
+      precursors.push_back(std::make_shared<epke::Precursor>(lambda, beta));
+    }
+  }
+
+  for (const auto& prec_node : precs_node) {
+    lambda = util::loadSeriesData(prec_node.child("decay_constant"), n_steps);
+    beta   = util::loadSeriesData(prec_node.child("delayed_fraction"), n_steps);
+    precursors.push_back(std::make_shared<epke::Precursor>(lambda, beta));
+  }
+
+  // Create the coarse parameters object
+  return std::make_shared<epke::EPKEParameters>(time,
+						precursors,
+						rho_imp,
+						gen_time,
+						pow_norm,
+						beta_eff,
+						lambda_h,
+						theta,
+						gamma_d,
+						eta);
+}
+
+// Text of a node and of the binary container it names, so that equal
+// contents load equal parameters
+static std::string readNode(const pugi::xml_node& node) {
+  std::ostringstream content;
+  node.print(content, "", pugi::format_raw);
+
+  if (node.attribute("file")) {
+    std::ifstream file(node.attribute("file").value(), std::ios::binary);
+    content << file.rdbuf();
+  }
+
+  return content.str();
+}
+
+// Hash of what the coefficient table of params is built from: the time grid,
+// the decay constants and lambda_h
+static std::size_t hashDecay(const epke::EPKEParameters& params) {
+  std::size_t hash = params.getTimeOffset();
+  auto combine = [&hash](const double value) {
+    hash ^= std::hash<double>()(value) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+  };
+
+  const timeIndex n_first = params.getTimeOffset();
+  for (timeIndex n = n_first; n < params.getNumTimeSteps(); n++) {
+    combine(params.getTime(n));
+    combine(params.getLambdaH(n));
+    for (precIndex k = 0; k < params.getNumPrecursors(); k++) {
+      combine(params.getDecayConstant(k, n));
+    }
+  }
+
+  return hash;
+}
+
+static bool sameDecay(const epke::EPKEParameters& a, const epke::EPKEParameters& b) {
+  if (a.getTimeOffset() != b.getTimeOffset() ||
+      a.getNumTimeSteps() != b.getNumTimeSteps() ||
+      a.getNumPrecursors() != b.getNumPrecursors()) {
+    return false;
+  }
+
+  for (timeIndex n = a.getTimeOffset(); n < a.getNumTimeSteps(); n++) {
+    if (a.getTime(n) != b.getTime(n) || a.getLambdaH(n) != b.getLambdaH(n)) {
+      return false;
+    }
+    for (precIndex k = 0; k < a.getNumPrecursors(); k++) {
+      if (a.getDecayConstant(k, n) != b.getDecayConstant(k, n)) { return false; }
+    }
+  }
+
+  return true;
+}
+
+// Tabulate the coefficients of params, or take the table of cached parameters
+// with the same grid and decay constants, and keep them for later cases
+static void buildCoefficients(epke::EPKEParameters::ptr params, Input::Cache* cache) {
+  if (params->hasCoefficients()) { return; }
+
+  if (!cache) {
+    params->buildCoefficients();
+    return;
+  }
+
+  const std::size_t hash = hashDecay(*params);
+
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    const auto cached = cache->coefficients.find(
+      hash, [&](const epke::EPKEParameters::ptr& other) {
+	return sameDecay(*other, *params);
+      });
+
+    if (cached) {
+      params->shareCoefficients(**cached);
+      return;
+    }
+  }
+
+  params->buildCoefficients();
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->coefficients.insert(hash, params, cache->capacity);
+}
 
 void Input::execute() {
   pugi::xml_document input_file;
-  pugi::xml_parse_result load_result =
-      input_file.load_file(input_file_name.c_str());
+  pugi::xml_parse_result load_result;
+  {
+    UTIL_PROFILE_SCOPE("parse_xml");
+    load_result = input_file.load_file(input_file_name.c_str());
+  }
 
   if (!load_result) {
-    std::cout << load_result.description() << std::endl;
-    throw;
+    throw std::runtime_error(load_result.description());
   }
 
   std::cout << "Reading input file: " << input_file_name << std::endl;
 
+  execute(input_file);
+}
+
+void Input::execute(const pugi::xml_document& input_file, Cache* cache) {
   using Coarse = epke::Solver;
   using Fine   = epke::Solver;
 
@@ -37,128 +597,223 @@ void Input::execute() {
   Fine::Params::ptr fine_params;
   Fine::Output::ptr fine_precomp;
 
+  const pugi::xml_node params_node = parareal_node.child("epke_input");
+
+  // Every solve but the adaptive one tabulates the exponential coefficients
+  // of the coarse parameters, unless asked not to
+  const bool build_coefficients =
+    params_node.attribute("cache_coefficients").as_bool(true) &&
+    (parareal_node.child("ensemble") ||
+     !params_node.attribute("adaptive").as_bool(false));
+
+  std::string params_content;
+  std::size_t params_hash = 0;
+  bool        cached_coarse = false;
+
+  // cached entries only count when their content is the same, not just
+  // its hash
+  auto sameContent = [&params_content](const Loaded& loaded) {
+    return loaded.content == params_content;
+  };
+
   {
-    // Create the coarse parameters from xml
-    const pugi::xml_node params_node = parareal_node.child("epke_input");
-    timeIndex n_steps = params_node.attribute("n_steps").as_int();
-
-    timeBins time     = loadVectorData(params_node.child("time"), n_steps);
-    timeBins rho_imp  = loadVectorData(params_node.child("rho_imp"), n_steps);
-    timeBins gen_time = loadVectorData(params_node.child("gen_time"), n_steps);
-    timeBins pow_norm = loadVectorData(params_node.child("pow_norm"), n_steps);
-    timeBins beta_eff = loadVectorData(params_node.child("beta_eff"), n_steps);
-    timeBins lambda_h = loadVectorData(params_node.child("lambda_h"), n_steps);
-    double   theta    = params_node.attribute("theta").as_double();
-    double   gamma_d  = params_node.attribute("gamma_d").as_double();
-    double   eta      = params_node.attribute("eta").as_double();
-
-    // Create the precursors
-    const pugi::xml_node precs_node = params_node.child("precursors");
-    precBins<epke::Precursor::ptr> precursors;
-    timeBins lambda; timeBins beta;
-
-    for (const auto& prec_node : precs_node) {
-      lambda = loadVectorData(prec_node.child("decay_constant"), n_steps);
-      beta   = loadVectorData(prec_node.child("delayed_fraction"), n_steps);
-      precursors.push_back(std::make_shared<epke::Precursor>(lambda, beta));
+    UTIL_PROFILE_SCOPE("load_input");
+
+    if (cache) {
+      params_content = readNode(params_node);
+      params_hash = std::hash<std::string>()(params_content);
+      std::lock_guard<std::mutex> lock(cache->mutex);
+      const Loaded* cached = cache->coarse_params.find(params_hash, sameContent);
+      if (cached) {
+	coarse_params = cached->params;
+	cached_coarse = true;
+      }
     }
 
-    // Create the coarse parameters object
-    coarse_params = std::make_shared<Coarse::Params>(time,
-						     precursors,
-						     rho_imp,
-						     gen_time,
-						     pow_norm,
-						     beta_eff,
-						     lambda_h,
-						     theta,
-						     gamma_d,
-						     eta);
+    if (!coarse_params) {
+      coarse_params = loadParameters(params_node);
+    }
   }
 
-  {
-    // Create the coarse solver initial conditions from xml
-    const pugi::xml_node precomp_node = parareal_node.child("epke_output");
-    timeIndex n_steps = precomp_node.attribute("n_steps").as_int();
-
-    timeIndex n_start = precomp_node.attribute("n_start").as_int();
-    timeIndex n_stop  = precomp_node.attribute("n_stop").as_int();
-    timeBins time     = loadVectorData(precomp_node.child("time"), n_steps);
-    timeBins power    = loadVectorData(precomp_node.child("power"), n_steps);
-    timeBins pow_norm = loadVectorData(precomp_node.child("pow_norm"), n_steps);
-    timeBins rho      = loadVectorData(precomp_node.child("rho"), n_steps);
-    precBins<timeBins> concentrations =
-      util::loadZetas(precomp_node.child("concentrations"), n_steps);
+  // cached parameters are complete, so other cases only ever read them
+  if (build_coefficients) {
+    UTIL_PROFILE_SCOPE("build_coefficients");
+    buildCoefficients(coarse_params, cache);
+  }
 
-    coarse_precomp = std::make_shared<Coarse::Output>(n_start,
-						      n_stop,
-						      time,
-						      concentrations,
-						      power,
-						      pow_norm,
-						      rho);
+  if (cache && !cached_coarse) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    cache->coarse_params.insert(params_hash, {params_content, coarse_params},
+				cache->capacity);
   }
 
-  Coarse::ptr coarse_solver =
-    std::make_shared<Coarse>(coarse_params, coarse_precomp);
+  // Create the coarse solver initial conditions
+  coarse_precomp = loadOutput(parareal_node.child("epke_output"));
+
+  // Solve a set of perturbed scenarios on the input grid instead of parareal
+  const pugi::xml_node ensemble_node = parareal_node.child("ensemble");
+
+  // the adaptive solver has its own output_time
+  if (parareal_node.child("output") &&
+      (ensemble_node || params_node.attribute("adaptive").as_bool(false))) {
+    throw std::runtime_error("Output specs only apply to parareal and serial solves");
+  }
+
+  if (ensemble_node) {
+    std::vector<epke::Ensemble::Perturbation> perturbations;
+
+    // scenarios from a binary perturbation set come before the listed ones
+    if (ensemble_node.attribute("file")) {
+      perturbations = epke::Ensemble::loadPerturbations(
+	ensemble_node.attribute("file").value());
+    }
+
+    for (const auto& scenario_node : ensemble_node.children("scenario")) {
+      perturbations.push_back({scenario_node.attribute("rho_imp").as_double(1.),
+			       scenario_node.attribute("gamma_d").as_double(1.),
+			       scenario_node.attribute("beta_eff").as_double(1.),
+			       scenario_node.attribute("gen_time").as_double(1.)});
+    }
+
+    epke::Ensemble ensemble(coarse_params,
+			    coarse_precomp,
+			    perturbations,
+			    ensemble_node.attribute("outpath").value());
+
+    std::cout << "Solving " << ensemble.getNumScenarios() << " scenarios..."
+	      << std::endl;
+
+    ensemble.solve();
+    std::cout << "Completed solve." << std::endl;
+
+    std::cout << "Writing output to " << ensemble.getOutpath() << std::endl;
+
+    if (isBinaryOutput(ensemble_node)) {
+      ensemble.writeToBinary();
+    } else {
+      ensemble.writeToXML();
+    }
+    return;
+  }
+
+  // Solve on a time grid adapted to the local error instead of parareal
+  if (params_node.attribute("adaptive").as_bool(false)) {
+    epke::AdaptiveSolver::Tolerances tolerances;
+    tolerances.rtol = params_node.attribute("rtol").as_double(tolerances.rtol);
+    tolerances.atol = params_node.attribute("atol").as_double(tolerances.atol);
+    tolerances.dt_min = params_node.attribute("dt_min").as_double(0.);
+    tolerances.dt_max = params_node.attribute("dt_max").as_double(0.);
+    tolerances.dt_initial = params_node.attribute("dt_initial").as_double(0.);
+
+    // the solution is written on the adaptive grid unless output times are
+    // listed, or adaptive_output="input" asks for the input grid
+    timeBins output_time;
+
+    if (params_node.child("output_time")) {
+      output_time = loadVectorData(params_node.child("output_time"));
+    } else if (std::string(params_node.attribute("adaptive_output").value())
+	       == "input") {
+      output_time = coarse_params->getTime().toVector();
+    }
+
+    epke::AdaptiveSolver solver(coarse_params,
+				coarse_precomp,
+				tolerances,
+				parareal_node.attribute("outpath").value(),
+				output_time);
+
+    std::cout << "Solving..." << std::endl;
+
+    solver.solve();
+    std::cout << "Completed solve in " << solver.getNumTimeSteps()
+	      << " steps (" << solver.getNumRejected() << " rejected)."
+	      << std::endl;
+
+    std::cout << "Writing output to " << solver.getOutpath() << std::endl;
+
+    if (isBinaryOutput(parareal_node)) {
+      solver.writeToBinary();
+    } else {
+      solver.writeToXML();
+    }
+    return;
+  }
 
   // Create fine time
   timeIndex n_fine_per_coarse =
     parareal_node.attribute("n_fine_per_coarse").as_int();
   timeIndex n_fine =
-    (coarse_solver->getNumTimeSteps() - 1) * n_fine_per_coarse + 1;
-  timeBins fine_time =
-    util::linspace(0., coarse_solver->getTime().back(), n_fine);
+    (coarse_precomp->getNumTimeSteps() - 1) * n_fine_per_coarse + 1;
+  const util::Series fine_time =
+    util::Series::uniform(0., coarse_params->getTime().back(), n_fine);
 
-  {
-    // Create the fine parameters
-    fine_params = para::interpolate(coarse_params, fine_time);
-  }
+  // fine_parameters="window" interpolates the fine parameters window by
+  // window during the solve, so only the first window is created here
+  const std::string fine_parameters =
+    parareal_node.attribute("fine_parameters").as_string("full");
 
-  {
-    // Create the fine solver initial conditions from xml
-    const pugi::xml_node precomp_node = parareal_node.child("epke_output");
-    timeIndex n_steps = precomp_node.attribute("n_steps").as_int();
-
-    timeIndex n_start = precomp_node.attribute("n_start").as_int();
-    timeIndex n_stop  = precomp_node.attribute("n_stop").as_int();
-    timeBins time     = loadVectorData(precomp_node.child("time"), n_steps);
-    timeBins power    = loadVectorData(precomp_node.child("power"), n_steps);
-    timeBins pow_norm = loadVectorData(precomp_node.child("pow_norm"), n_steps);
-    timeBins rho      = loadVectorData(precomp_node.child("rho"), n_steps);
-    precBins<timeBins> concentrations =
-      util::loadZetas(precomp_node.child("concentrations"), n_steps);
+  if (fine_parameters != "full" && fine_parameters != "window") {
+    throw std::runtime_error("Unknown fine parameters: " + fine_parameters);
+  }
 
-    fine_precomp = std::make_shared<Fine::Output>(n_start,
-						  n_stop,
-						  time,
-						  concentrations,
-						  power,
-						  pow_norm,
-						  rho);
+  // the windows of fine_parameters="window" are not kept, as the solve
+  // replaces them
+  const bool cache_fine = cache && fine_parameters == "full";
+  bool       cached_fine = false;
 
-    fine_precomp->resize(n_fine);
+  if (cache_fine) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    const Loaded* cached = cache->fine_params.find({params_hash, n_fine}, sameContent);
+    if (cached) {
+      fine_params = cached->params;
+      cached_fine = true;
+    }
   }
 
-  Fine::ptr fine_solver = std::make_shared<Fine>(fine_params, fine_precomp);
+  if (!fine_params) {
+    UTIL_PROFILE_SCOPE("interpolate");
 
-  // Create the parareal solver
-  para::Parareal<Coarse, Fine>
-    parareal(coarse_solver,
-	     fine_solver,
-	     fine_precomp,
-	     parareal_node.attribute("n_fine_per_coarse").as_int(),
-	     parareal_node.attribute("max_iterations").as_int(),
-	     parareal_node.attribute("outpath").value());
+    // Create the fine parameters
+    fine_params = fine_parameters == "full" ?
+      para::interpolate(coarse_params, fine_time) :
+      para::interpolateWindow(coarse_params, 0., coarse_params->getTime().back(),
+			      n_fine, 0, std::min(n_fine, n_fine_per_coarse + 1));
+  }
 
-  // Run the EPKE solver
-  std::cout << "Solving..." << std::endl;
+  // Tabulate the exponential coefficients once for every sweep and window
+  if (build_coefficients) {
+    UTIL_PROFILE_SCOPE("build_coefficients");
+    buildCoefficients(fine_params, cache_fine ? cache : nullptr);
+  }
 
-  parareal.solve();
-  std::cout << "Completed solve." << std::endl;
+  if (cache_fine && !cached_fine) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    cache->fine_params.insert({params_hash, n_fine}, {params_content, fine_params},
+			      cache->capacity);
+  }
 
-  // build the xml document
-  std::cout << "Writing output to " << parareal.getOutpath() << std::endl;
-  pugi::xml_document doc;
-  parareal.writeToXML(doc);
+  {
+    // Create the fine solver initial conditions, on the whole fine grid unless
+    // the solution is recorded window by window
+    fine_precomp = loadOutput(parareal_node.child("epke_output"));
+    if (loadOutputSpec(parareal_node.child("output")).isFull()) {
+      fine_precomp->resize(n_fine);
+    }
+  }
+  // Dispatch to a fine solver specialized on the number of precursor groups
+  switch (coarse_params->getNumPrecursors()) {
+  case 6:
+    solveTimeParallel<epke::FixedSolver<6>, epke::PromptJumpSolver<6>,
+		      epke::MixedSolver<float, 6>>(
+	     parareal_node, coarse_params, coarse_precomp, fine_params, fine_precomp);
+    break;
+  case 8:
+    solveTimeParallel<epke::FixedSolver<8>, epke::PromptJumpSolver<8>,
+		      epke::MixedSolver<float, 8>>(
+	     parareal_node, coarse_params, coarse_precomp, fine_params, fine_precomp);
+    break;
+  default:
+    solveTimeParallel<Fine, epke::PromptJumpSolver<0>, epke::MixedSolver<float, 0>>(
+	     parareal_node, coarse_params, coarse_precomp, fine_params, fine_precomp);
+  }
 }
@@ -2,10 +2,81 @@
 #define _PARAREAL_INPUT_HEADER_
 
 #include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "pugi/pugixml.hpp"
 
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <string>
 
 class Input {
+public:
+  // Entries of a cache by a hash key, in the order they were added. Equal
+  // keys may hold different values, which find tells apart with a match.
+  // Past capacity entries the oldest one is dropped.
+  template <typename Key, typename Value>
+  class Store {
+  private:
+    using Map = std::multimap<Key, Value>;
+
+    Map _entries;
+    std::deque<typename Map::iterator> _order;
+
+  public:
+    const std::size_t size() const { return _entries.size(); }
+
+    typename Map::const_iterator begin() const { return _entries.begin(); }
+    typename Map::const_iterator end() const { return _entries.end(); }
+
+    // The value under key that match accepts, or null
+    template <typename Match>
+    const Value* find(const Key& key, Match match) const {
+      const auto range = _entries.equal_range(key);
+      for (auto it = range.first; it != range.second; it++) {
+	if (match(it->second)) { return &it->second; }
+      }
+      return nullptr;
+    }
+
+    void insert(const Key& key, const Value& value, const std::size_t capacity) {
+      _order.push_back(_entries.emplace(key, value));
+
+      while (_order.size() > capacity) {
+	_entries.erase(_order.front());
+	_order.pop_front();
+      }
+    }
+  };
+
+  // Parameters and the content of the input they were read from
+  struct Loaded {
+    std::string               content;
+    epke::EPKEParameters::ptr params;
+  };
+
+  // Parameters kept between the inputs of a service or batch. The coarse
+  // parameters are keyed by the content hash of their epke_input node and
+  // binary container, the fine parameters of the whole grid by that hash and
+  // the number of fine steps, and a hit is only taken when the content is
+  // the same. Parameters with the same grid and decay constants share one
+  // coefficient table. Cached parameters are never changed, so cases running
+  // at the same time can share them.
+  struct Cache {
+    std::mutex mutex; // held while the maps are read or changed
+
+    // Entries kept in each map, the oldest dropped first
+    std::size_t capacity = 64;
+
+    Store<std::size_t, Loaded> coarse_params;
+    Store<std::pair<std::size_t, para::timeIndex>, Loaded> fine_params;
+
+    // Parameters holding each table, by the hash of their grid and decay
+    // constants
+    Store<std::size_t, epke::EPKEParameters::ptr> coefficients;
+  };
+
 private:
   std::string input_file_name;
 
@@ -13,6 +84,10 @@ public:
   Input(std::string input_file_name) : input_file_name(input_file_name) {}
 
   void execute();
+
+  // Run a parsed input document, reading parameters from the cache when it
+  // holds them and adding the ones it does not
+  static void execute(const pugi::xml_document& input_file, Cache* cache = nullptr);
 };
 
 #endif
@@ -0,0 +1,161 @@
+#ifndef _PARAREAL_MGRIT_HEADER_
+#define _PARAREAL_MGRIT_HEADER_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+#include "parareal/thread_pool.hpp"
+#include "parareal/solver_output.hpp"
+#include "parareal/solver_parameters.hpp"
+
+namespace para {
+
+  // Multigrid reduction in time. The finest level is the fine time grid, and
+  // every coarser level keeps each coarsening-th point (the C-points) of the
+  // level below, the others being F-points. A V-cycle relaxes each level
+  // with F-relaxation (step through the F-points from each C-point) or FCF
+  // relaxation (then update the C-points and redo the F-points), restricts
+  // the residual at the C-points to the next level as a full approximation
+  // scheme (FAS) forcing, and corrects the C-points with the coarse solution.
+  // The coarsest level is solved with serial steps, so the sequential part
+  // is only its handful of points. Every interval of F-points and every
+  // C-point is stepped on its own slice of the level, so they are run on the
+  // thread pool. Two levels with F-relaxation and a coarsening of
+  // n_fine_per_coarse are parareal with the fine solver on both grids.
+  template <typename Fine>
+  class MGRIT {
+  public:
+    template <typename T>
+    using precBins  = para::precBins<T>;
+    using timeBins  = para::timeBins;
+    using timeIndex = para::timeIndex;
+    using precIndex = para::precIndex;
+    using paraIndex = para::paraIndex;
+    using Output    = typename Fine::Output;
+    using Params    = typename Fine::Params;
+
+  private:
+    struct Level {
+      typename Params::ptr params;
+      typename Output::ptr solution;
+
+      // One solver per worker, stepping the slices of this level
+      std::vector<typename Fine::ptr> solvers;
+
+      // FAS forcing at each point, packed states (empty on the finest level)
+      timeBins forcing;
+
+      // Points before n_start are initial conditions and never stepped
+      timeIndex n_start;
+    };
+
+    // Output path
+    std::string _outpath;
+
+    // Levels from the finest to the coarsest
+    std::vector<Level> _levels;
+
+    // Number of points of a level per point of the next coarser level
+    const timeIndex _coarsening;
+
+    // Max number of V-cycles
+    const paraIndex _max_iterations;
+
+    // Tolerance on the residual at the C-points of the finest level
+    const double _tolerance;
+
+    // FCF instead of F relaxation
+    const bool _fcf;
+
+    // Pool of worker threads for the slices
+    std::unique_ptr<ThreadPool> _pool;
+
+    // Size of a packed state, and a packed state of scratch per worker
+    std::size_t           _state_size;
+    std::vector<timeBins> _states;
+
+    // Largest C-point residual of each V-cycle
+    std::vector<double> _residuals;
+
+    double _solve_time = 0.;
+
+    const timeIndex getNumPoints(const paraIndex l) const {
+      return _levels[l].solution->getNumTimeSteps();
+    }
+
+    // Take step n of a slice on worker w and add the forcing of level l
+    void stepForced(const paraIndex l,
+		    const paraIndex w,
+		    typename Output::ptr slice,
+		    const timeIndex n);
+
+    // Step from each C-point of level l through the F-points after it
+    void relaxF(const paraIndex l);
+
+    // Step to every C-point of level l from the F-point before it, on slices
+    // that are returned instead of written to the level
+    std::vector<typename Output::ptr> stepC(const paraIndex l);
+
+    // Write the C-point states of slices returned by stepC to level l
+    void commitC(const paraIndex l,
+		 const std::vector<typename Output::ptr>& slices);
+
+    // Largest jump between the C-points of level l and the slices of stepC
+    double computeResidual(const paraIndex l,
+			   const std::vector<typename Output::ptr>& slices) const;
+
+    // Inject level l into level l+1 and set the FAS forcing of level l+1 from
+    // the C-point steps of level l
+    void restrict(const paraIndex l,
+		  const std::vector<typename Output::ptr>& slices);
+
+    // Copy the corrected points of level l+1 to the C-points of level l
+    void correct(const paraIndex l);
+
+    // V-cycle from level l, returning the finest level residual when l is 0
+    double cycle(const paraIndex l);
+
+  public:
+    MGRIT(typename Params::ptr       params,
+	  typename Output::ptr       initial,
+	  const    timeIndex         coarsening,
+	  const    paraIndex         max_levels,
+	  const    timeIndex         min_coarse,
+	  const    paraIndex         max_iterations,
+	  const    std::string       outpath,
+	  const    paraIndex         n_threads = 1,
+	  const    double            tolerance = 0.,
+	  const    bool              fcf = true);
+
+    // Get outpath
+    std::string getOutpath() const { return _outpath; }
+
+    // Get the number of levels, the finest one included
+    const paraIndex getNumLevels() const { return _levels.size(); }
+
+    // Get the number of points of the coarsest level
+    const timeIndex getNumCoarsest() const { return getNumPoints(_levels.size() - 1); }
+
+    // Get the residual of each V-cycle that was run
+    const std::vector<double>& getResiduals() const { return _residuals; }
+
+    // Get the solution on the finest level
+    typename Output::ptr getSolution() const { return _levels.front().solution; }
+
+    // Solve
+    void solve();
+
+    // Stream the solution and residuals to an xml document at outpath
+    void writeToXML() const;
+
+    // Write the solution and residuals to a binary container at outpath
+    void writeToBinary() const;
+  };
+
+} // namespace para
+
+#include "parareal/mgrit.t.hpp"
+
+#endif
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "utility/binary_io.hpp"
+#include "utility/profile.hpp"
+#include "utility/xml_writer.hpp"
+
+template <typename Fine>
+para::MGRIT<Fine>::MGRIT(typename Params::ptr params,
+			 typename Output::ptr initial,
+			 const timeIndex      coarsening,
+			 const paraIndex      max_levels,
+			 const timeIndex      min_coarse,
+			 const paraIndex      max_iterations,
+			 const std::string    outpath,
+			 const paraIndex      n_threads,
+			 const double         tolerance,
+			 const bool           fcf)
+  : _outpath(outpath),
+    _coarsening(coarsening),
+    _max_iterations(max_iterations),
+    _tolerance(tolerance),
+    _fcf(fcf),
+    _pool(std::make_unique<ThreadPool>(n_threads)),
+    _state_size(initial->getStateSize()),
+    _states(_pool->getNumThreads(), timeBins(initial->getStateSize())) {
+  if (coarsening < 2) {
+    throw std::runtime_error("MGRIT needs a coarsening factor of at least 2");
+  }
+
+  const timeIndex n_start = initial->getStartTimeIndex();
+  const timeIndex n_steps = initial->getNumTimeSteps();
+
+  if (n_start == 0 || n_start >= n_steps) {
+    throw std::runtime_error("MGRIT needs an initial condition and a step to take");
+  }
+
+  // Start every point from the last initial state
+  timeBins& state = _states.front();
+  initial->packState(n_start - 1, state.data());
+
+  for (timeIndex n = n_start; n < n_steps; n++) {
+    initial->setTime(n, params->getTime(n));
+    initial->unpackState(n, state.data());
+  }
+
+  _levels.push_back({params, initial, {}, {}, n_start});
+
+  // Coarsen while the next level keeps at least min_coarse points
+  while (max_levels == 0 || _levels.size() < max_levels) {
+    const Level&    fine     = _levels.back();
+    const timeIndex n_fine   = fine.solution->getNumTimeSteps();
+    const timeIndex n_coarse = (n_fine - 1) / coarsening + 1;
+
+    if (n_coarse < std::max<timeIndex>(min_coarse, 2)) { break; }
+
+    timeBins time(n_coarse);
+    for (timeIndex j = 0; j < n_coarse; j++) {
+      time[j] = fine.params->getTime(j * coarsening);
+    }
+
+    Level coarse;
+    coarse.params = para::interpolate(fine.params, time);
+    if (fine.params->hasCoefficients()) { coarse.params->buildCoefficients(); }
+
+    coarse.solution = fine.solution->coarsen(time, coarsening);
+    coarse.forcing.assign(n_coarse * _state_size, 0.);
+    coarse.n_start = (fine.n_start + coarsening - 1) / coarsening;
+
+    _levels.push_back(coarse);
+  }
+
+  for (Level& level : _levels) {
+    for (paraIndex w = 0; w < _pool->getNumThreads(); w++) {
+      level.solvers.push_back(std::make_shared<Fine>(level.params, level.solution));
+    }
+  }
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::stepForced(const paraIndex l,
+				   const paraIndex w,
+				   typename Output::ptr slice,
+				   const timeIndex n) {
+  _levels[l].solvers[w]->step(n);
+
+  if (_levels[l].forcing.empty()) { return; }
+
+  timeBins& state = _states[w];
+  const double* forcing = _levels[l].forcing.data() + n * _state_size;
+
+  slice->packState(n, state.data());
+  for (std::size_t i = 0; i < _state_size; i++) { state[i] += forcing[i]; }
+  slice->unpackState(n, state.data());
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::relaxF(const paraIndex l) {
+  UTIL_PROFILE_SCOPE("relax_f");
+
+  Level& level = _levels[l];
+  const timeIndex n_steps     = getNumPoints(l);
+  const timeIndex n_intervals = (n_steps - 1) / _coarsening + 1;
+
+  // The first step of an interval reads the last F-point of the one before,
+  // so every interval is solved before any is written back
+  std::vector<typename Output::ptr> slices(n_intervals);
+
+  auto range = [&](const timeIndex j) {
+    const timeIndex start = std::max(j * _coarsening + 1, level.n_start);
+    const timeIndex stop  = std::min((j + 1) * _coarsening, n_steps);
+    return std::make_pair(start, std::max(start, stop));
+  };
+
+  _pool->parallelFor(0, n_intervals, [&](const paraIndex w, const timeIndex j) {
+    const auto r = range(j);
+    if (r.first == r.second) { return; }
+
+    slices[j] = createSlice(level.solution, r.first, r.second, 2);
+    level.solvers[w]->reset(slices[j]);
+
+    for (timeIndex n = r.first; n < r.second; n++) {
+      stepForced(l, w, slices[j], n);
+    }
+  });
+
+  _pool->parallelFor(0, n_intervals, [&](const paraIndex, const timeIndex j) {
+    const auto r = range(j);
+    for (timeIndex n = r.first; n < r.second; n++) {
+      updateCoarse(n, slices[j], level.solution);
+    }
+  });
+}
+
+template <typename Fine>
+std::vector<typename para::MGRIT<Fine>::Output::ptr>
+para::MGRIT<Fine>::stepC(const paraIndex l) {
+  UTIL_PROFILE_SCOPE("relax_c");
+
+  Level& level = _levels[l];
+  const timeIndex n_steps  = getNumPoints(l);
+  const timeIndex n_coarse = (n_steps - 1) / _coarsening + 1;
+
+  // indexed by the C-point on the next level, empty for initial conditions
+  std::vector<typename Output::ptr> slices(n_coarse);
+
+  _pool->parallelFor(0, n_coarse, [&](const paraIndex w, const timeIndex j) {
+    const timeIndex n = j * _coarsening;
+    if (n < level.n_start) { return; }
+
+    slices[j] = createSlice(level.solution, n, n + 1, 2);
+    level.solvers[w]->reset(slices[j]);
+    stepForced(l, w, slices[j], n);
+  });
+
+  return slices;
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::commitC(const paraIndex l,
+				const std::vector<typename Output::ptr>& slices) {
+  for (timeIndex j = 0; j < slices.size(); j++) {
+    if (slices[j]) { updateCoarse(j * _coarsening, slices[j], _levels[l].solution); }
+  }
+}
+
+template <typename Fine>
+double para::MGRIT<Fine>::computeResidual(const paraIndex l,
+					  const std::vector<typename Output::ptr>& slices) const {
+  double residual = 0.;
+
+  for (timeIndex j = 0; j < slices.size(); j++) {
+    if (slices[j]) {
+      residual = std::max(residual,
+			  slices[j]->computeJump(j * _coarsening,
+						 _levels[l].solution));
+    }
+  }
+
+  return residual;
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::restrict(const paraIndex l,
+				 const std::vector<typename Output::ptr>& slices) {
+  UTIL_PROFILE_SCOPE("restrict");
+
+  Level& fine   = _levels[l];
+  Level& coarse = _levels[l + 1];
+  const timeIndex n_coarse = getNumPoints(l + 1);
+
+  // inject the C-points, which the coarse steps read as their history
+  _pool->parallelFor(0, n_coarse, [&](const paraIndex w, const timeIndex j) {
+    fine.solution->packState(j * _coarsening, _states[w].data());
+    coarse.solution->unpackState(j, _states[w].data());
+  });
+
+  // The FAS forcing makes the coarse level reproduce the fine C-point steps
+  // at the injected solution: g_c = (Phi(u) + g)_C - Phi_c(u_C)
+  _pool->parallelFor(0, n_coarse, [&](const paraIndex w, const timeIndex j) {
+    double* forcing = coarse.forcing.data() + j * _state_size;
+
+    if (!slices[j]) {
+      std::fill_n(forcing, _state_size, 0.);
+      return;
+    }
+
+    auto slice = createSlice(coarse.solution, j, j + 1, 2);
+    coarse.solvers[w]->reset(slice);
+    coarse.solvers[w]->step(j);
+
+    timeBins& state = _states[w];
+
+    slices[j]->packState(j * _coarsening, forcing);
+    slice->packState(j, state.data());
+    for (std::size_t i = 0; i < _state_size; i++) { forcing[i] -= state[i]; }
+  });
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::correct(const paraIndex l) {
+  Level& fine   = _levels[l];
+  Level& coarse = _levels[l + 1];
+
+  _pool->parallelFor(coarse.n_start, getNumPoints(l + 1),
+		     [&](const paraIndex w, const timeIndex j) {
+		       coarse.solution->packState(j, _states[w].data());
+		       fine.solution->unpackState(j * _coarsening, _states[w].data());
+		     });
+}
+
+template <typename Fine>
+double para::MGRIT<Fine>::cycle(const paraIndex l) {
+  Level& level = _levels[l];
+
+  // the coarsest level is solved exactly, step after step
+  if (static_cast<std::size_t>(l) + 1 == _levels.size()) {
+    UTIL_PROFILE_SCOPE("coarsest");
+
+    level.solvers.front()->reset(level.solution);
+    for (timeIndex n = level.n_start; n < getNumPoints(l); n++) {
+      stepForced(l, 0, level.solution, n);
+    }
+    return 0.;
+  }
+
+  relaxF(l);
+
+  if (_fcf) {
+    commitC(l, stepC(l));
+    relaxF(l);
+  }
+
+  // the C-point steps give both the residual and the coarse forcing
+  const auto slices = stepC(l);
+  const double residual = l == 0 ? computeResidual(l, slices) : 0.;
+
+  restrict(l, slices);
+  cycle(l + 1);
+  correct(l);
+
+  // the coarser level reads every point of this one, so its F-points follow
+  // the corrected C-points; on the finest level the next cycle does this
+  if (l > 0) { relaxF(l); }
+
+  return residual;
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::solve() {
+  using timer = std::chrono::steady_clock;
+
+  const timer::time_point clock_start = timer::now();
+
+  _residuals.clear();
+
+  if (_max_iterations == 0) {
+    // serial steps on the finest level, for reference
+    Level& level = _levels.front();
+    level.solvers.front()->reset(level.solution);
+    for (timeIndex n = level.n_start; n < getNumPoints(0); n++) {
+      level.solvers.front()->step(n);
+    }
+  } else {
+    for (paraIndex k = 0; k < _max_iterations; k++) {
+      UTIL_PROFILE_ITERATION(k);
+
+      _residuals.push_back(cycle(0));
+
+      if (_residuals.back() <= _tolerance) { break; }
+    }
+
+    UTIL_PROFILE_ITERATION(-1);
+
+    // step the F-points from the last corrected C-points
+    relaxF(0);
+  }
+
+  const std::chrono::duration<double> duration = timer::now() - clock_start;
+  _solve_time = duration.count();
+  getSolution()->setSolveTime(_solve_time);
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::writeToXML() const {
+  util::XMLWriter writer(_outpath);
+
+  writer.open("mgrit");
+  writer.attribute("solve_time", _solve_time);
+  writer.attribute("n_iterations", _residuals.size());
+  writer.attribute("n_levels", _levels.size());
+  writer.attribute("coarsening", _coarsening);
+  writer.attribute("n_coarsest", getNumCoarsest());
+
+  getSolution()->writeToXML(writer);
+
+  writer.open("residuals");
+  writer.attribute("tolerance", _tolerance);
+  writer.values(_residuals);
+  writer.close();
+
+#ifdef UTIL_PROFILE
+  util::Profiler::instance().writeToXML(writer);
+#endif
+
+  writer.close();
+  writer.finish();
+}
+
+template <typename Fine>
+void para::MGRIT<Fine>::writeToBinary() const {
+  util::BinaryWriter writer(_outpath);
+
+  getSolution()->writeToBinary(writer);
+
+  writer.add("residuals", _residuals);
+  writer.add("tolerance", _tolerance);
+
+  writer.write();
+}
@@ -0,0 +1,88 @@
+#ifndef _PARAREAL_MPI_PARAREAL_HEADER_
+#define _PARAREAL_MPI_PARAREAL_HEADER_
+
+#ifdef PARA_USE_MPI
+
+#include <mpi.h>
+
+#include "parareal/parareal.hpp"
+
+namespace para {
+
+  // Distributed-memory parareal. Each rank owns a contiguous block of coarse
+  // windows and solves them locally. Ranks only exchange the states at the
+  // boundaries of their blocks, and the coarse correction is pipelined: rank
+  // r+1 starts correcting as soon as the boundary states from rank r arrive,
+  // while rank r moves on to the fine solves of the next iteration.
+  template <typename Coarse, typename Fine>
+  class MPIParareal : public Parareal<Coarse, Fine> {
+  public:
+    using Base      = Parareal<Coarse, Fine>;
+    using timeBins  = typename Base::timeBins;
+    using timeIndex = typename Base::timeIndex;
+    using paraIndex = typename Base::paraIndex;
+    using Output    = typename Base::Output;
+
+  private:
+    MPI_Comm _comm;
+
+    int _rank;
+
+    int _n_ranks;
+
+    // Coarse windows [_w_start, _w_stop) owned by this rank
+    timeIndex _w_start;
+    timeIndex _w_stop;
+
+    // Send the boundary states of this block to the next rank
+    void sendBoundary(const timeIndex n) const;
+
+    // Receive the boundary states of the previous block from the previous rank
+    void receiveBoundary(const timeIndex n);
+
+    // Gather the fine solution of every rank into the global output on rank 0
+    void gatherGlobalOutput();
+
+  public:
+    MPIParareal(typename Coarse::ptr       coarse_solver,
+		typename Fine::ptr         fine_solver,
+		typename Fine::Output::ptr global_output,
+		const    timeIndex         n_fine_per_coarse,
+		const    paraIndex         max_iterations,
+		const    std::string       outpath,
+		const    paraIndex         n_threads = 1,
+		const    double            tolerance = 0.,
+		const    bool              window_local = true,
+		MPI_Comm                   comm = MPI_COMM_WORLD);
+
+    const int getRank() const { return _rank; }
+
+    const int getNumRanks() const { return _n_ranks; }
+
+    const timeIndex getStartWindow() const { return _w_start; }
+
+    const timeIndex getStopWindow() const { return _w_stop; }
+
+    // Largest boundary jump over the coarse points of every rank
+    double computeResidual(const paraIndex k) override;
+
+    // Update the coarse points owned by this rank with a parareal iteration
+    void update(const paraIndex k) override;
+
+    // Solve
+    void solve() override;
+
+    // Write the xml document on rank 0
+    void writeToXML() const override;
+
+    // Write the binary container on rank 0
+    void writeToBinary() const override;
+  };
+
+} // namespace para
+
+#include "parareal/mpi_parareal.t.hpp"
+
+#endif // PARA_USE_MPI
+
+#endif
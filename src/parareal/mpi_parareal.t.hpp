@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "utility/profile.hpp"
+
+using namespace para;
+
+template <typename Coarse, typename Fine>
+MPIParareal<Coarse, Fine>::MPIParareal(typename Coarse::ptr       coarse_solver,
+				       typename Fine::ptr         fine_solver,
+				       typename Fine::Output::ptr global_output,
+				       const    timeIndex         n_fine_per_coarse,
+				       const    paraIndex         max_iterations,
+				       const    std::string       outpath,
+				       const    paraIndex         n_threads,
+				       const    double            tolerance,
+				       const    bool              window_local,
+				       MPI_Comm                   comm)
+  : Base(coarse_solver,
+	 fine_solver,
+	 global_output,
+	 n_fine_per_coarse,
+	 max_iterations,
+	 outpath,
+	 n_threads,
+	 tolerance,
+	 window_local),
+    _comm(comm) {
+  MPI_Comm_rank(_comm, &_rank);
+  MPI_Comm_size(_comm, &_n_ranks);
+
+  const std::uint64_t n_windows = coarse_solver->getNumTimeSteps() - 1;
+
+  if (n_windows < static_cast<std::uint64_t>(_n_ranks)) {
+    std::cerr << "Cannot distribute " << n_windows << " coarse windows over "
+	      << _n_ranks << " ranks." << std::endl;
+    MPI_Abort(_comm, 1);
+  }
+
+  // split the windows into contiguous, nearly equal blocks
+  _w_start = n_windows * _rank / _n_ranks;
+  _w_stop  = n_windows * (_rank + 1) / _n_ranks;
+
+  // windows owned by other ranks are never solved here, so fill in their
+  // times up front for the written output
+  for (timeIndex n = 0; n < global_output->getNumTimeSteps(); n++) {
+    global_output->setTime(n, fine_solver->getTime(n));
+  }
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::sendBoundary(const timeIndex n) const {
+  auto coarse = this->_coarse_solver->getSolution();
+  const std::size_t state_size = coarse->getStateSize();
+
+  // the coarse step at n+1 reads the states at n and n-1
+  std::vector<double> buf(2 * state_size);
+  coarse->packState(n - 1, buf.data());
+  coarse->packState(n, buf.data() + state_size);
+
+  MPI_Send(buf.data(), buf.size(), MPI_DOUBLE, _rank + 1, 0, _comm);
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::receiveBoundary(const timeIndex n) {
+  auto coarse = this->_coarse_solver->getSolution();
+  const std::size_t state_size = coarse->getStateSize();
+
+  std::vector<double> buf(2 * state_size);
+  MPI_Recv(buf.data(), buf.size(), MPI_DOUBLE, _rank - 1, 0, _comm,
+	   MPI_STATUS_IGNORE);
+
+  coarse->unpackState(n - 1, buf.data());
+  coarse->unpackState(n, buf.data() + state_size);
+}
+
+template <typename Coarse, typename Fine>
+double MPIParareal<Coarse, Fine>::computeResidual(const paraIndex k) {
+  UTIL_PROFILE_SCOPE("coarsen");
+
+  auto coarse_solver = this->_coarse_solver;
+
+  this->_global_output->coarsen(coarse_solver->getTime(),
+				this->_n_fine_per_coarse,
+				*this->_fine_coarsened);
+
+  double residual = 0.;
+
+  // only the boundaries at the end of the local windows are known here
+  for (timeIndex n = _w_start + 1; n <= _w_stop; n++) {
+    residual = std::max(residual,
+			this->_fine_coarsened->computeJump(n,
+							   coarse_solver->getSolution()));
+  }
+
+  MPI_Allreduce(MPI_IN_PLACE, &residual, 1, MPI_DOUBLE, MPI_MAX, _comm);
+
+  return residual;
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::update(const paraIndex k) {
+  UTIL_PROFILE_SCOPE("update");
+
+  auto coarse_solver = this->_coarse_solver;
+
+  // wait for the corrected states at the start of this block
+  if (_rank > 0) {
+    receiveBoundary(_w_start);
+  }
+
+  // the first k+1 coarse points are exact after iteration k and stay frozen
+  for (timeIndex n = std::max<timeIndex>(_w_start, k) + 1; n <= _w_stop; n++) {
+    coarse_solver->step(n);
+
+    // update new coarse solution
+    updateCoarse(n, coarse_solver->getSolution(), this->_new_coarse);
+
+    // make parareal adjustments
+    updateParareal(n,
+		   coarse_solver->getSolution(),
+		   this->_new_coarse,
+		   this->_fine_coarsened,
+		   this->_old_coarse);
+  }
+
+  // let the next rank start its correction
+  if (_rank < _n_ranks - 1) {
+    sendBoundary(_w_stop);
+  }
+
+  // Swap the old and new coarse solutions
+  std::swap(this->_new_coarse, this->_old_coarse);
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::gatherGlobalOutput() {
+  UTIL_PROFILE_SCOPE("gather");
+
+  const auto global     = this->_global_output;
+  const auto nf         = this->_n_fine_per_coarse;
+  const int  state_size = global->getStateSize();
+
+  // fine indices solved by this rank
+  const timeIndex n_start = _w_start * nf + 1;
+  const timeIndex n_stop  = _w_stop * nf + 1;
+
+  std::vector<double> send((n_stop - n_start) * state_size);
+  for (timeIndex n = n_start; n < n_stop; n++) {
+    global->packState(n, send.data() + (n - n_start) * state_size);
+  }
+
+  std::vector<int> counts, displs;
+  std::vector<double> recv;
+
+  if (_rank == 0) {
+    const std::uint64_t n_windows = this->_coarse_solver->getNumTimeSteps() - 1;
+
+    for (int r = 0; r < _n_ranks; r++) {
+      const timeIndex w_start = n_windows * r / _n_ranks;
+      const timeIndex w_stop  = n_windows * (r + 1) / _n_ranks;
+      counts.push_back((w_stop - w_start) * nf * state_size);
+      displs.push_back(w_start * nf * state_size);
+    }
+
+    recv.resize(n_windows * nf * state_size);
+  }
+
+  MPI_Gatherv(send.data(), send.size(), MPI_DOUBLE,
+	      recv.data(), counts.data(), displs.data(), MPI_DOUBLE,
+	      0, _comm);
+
+  if (_rank == 0) {
+    for (timeIndex n = 1; n < global->getNumTimeSteps(); n++) {
+      global->unpackState(n, recv.data() + (n - 1) * state_size);
+    }
+  }
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::solve() {
+  using timer = std::chrono::steady_clock;
+
+  timer::time_point clock_start;
+  timer::time_point clock_stop;
+  std::chrono::duration<double> duration;
+
+  // Start the chrono timer
+  MPI_Barrier(_comm);
+  clock_start = timer::now();
+
+  if (this->_max_iterations != 0) {
+    // Every rank runs the (cheap) coarse propagator over the whole transient
+    this->runCoarseSolver();
+
+    for (paraIndex k = 0; k < this->_max_iterations; k++) {
+      UTIL_PROFILE_ITERATION(k);
+
+      // solve the windows owned by this rank that are not yet exact
+      this->runFineSolvers(std::min<timeIndex>(std::max<timeIndex>(_w_start, k),
+					       _w_stop),
+			   _w_stop);
+
+      // every rank sees the same global residual, so they all stop together
+      this->_residuals.push_back(computeResidual(k));
+
+      if (this->_residuals.back() <= this->_tolerance ||
+	  k + 1 == this->_max_iterations) {
+	break;
+      }
+
+      update(k);
+    }
+
+    UTIL_PROFILE_ITERATION(-1);
+    gatherGlobalOutput();
+  }
+  else {
+    this->runCoarseSolver();
+    this->_global_output = this->_coarse_solver->getSolution();
+  }
+
+  clock_stop = timer::now();
+
+  duration = clock_stop - clock_start;
+
+  // set solve time
+  this->_global_output->setSolveTime(duration.count());
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::writeToXML() const {
+  if (_rank == 0) {
+    Base::writeToXML();
+  }
+}
+
+template <typename Coarse, typename Fine>
+void MPIParareal<Coarse, Fine>::writeToBinary() const {
+  if (_rank == 0) {
+    Base::writeToBinary();
+  }
+}
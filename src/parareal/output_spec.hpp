@@ -0,0 +1,38 @@
+#ifndef _PARAREAL_OUTPUT_SPEC_HEADER_
+#define _PARAREAL_OUTPUT_SPEC_HEADER_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+
+namespace para {
+
+  // Time steps and quantities an output keeps of a solve. Every stride-th
+  // time step is kept, or the solution is linearly interpolated to the
+  // listed times when there are any, and only the named quantities are
+  // stored. The default keeps every step of every quantity.
+  struct OutputSpec {
+    timeIndex stride = 1;
+
+    // Times to interpolate to, in increasing order
+    timeBins times;
+
+    // Names of the kept quantities, empty to keep them all
+    std::vector<std::string> quantities;
+
+    const bool isFull() const {
+      return stride == 1 && times.empty() && quantities.empty();
+    }
+
+    const bool keeps(const std::string& quantity) const {
+      return quantities.empty() ||
+	std::find(quantities.begin(), quantities.end(), quantity) !=
+	quantities.end();
+    }
+  }; // struct OutputSpec
+
+} // namespace para
+
+#endif
@@ -2,8 +2,14 @@
 #define _PARAREAL_PARAREAL_HEADER_
 
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
 
 #include "parareal/definitions.hpp"
+#include "parareal/output_spec.hpp"
+#include "parareal/thread_pool.hpp"
+#include "parareal/task_graph.hpp"
 #include "parareal/solver_output.hpp"
 #include "parareal/solver_parameters.hpp"
 
@@ -21,7 +27,7 @@ namespace para {
     using Output    = typename Coarse::Output;
     using Params    = typename Coarse::Params;
 
-  private:
+  protected:
     // Output path
     std::string _outpath;
 
@@ -34,8 +40,14 @@ namespace para {
     // Coarse solver
     typename Coarse::ptr _coarse_solver;
 
-    // Fine solver
-    typename Fine::ptr _fine_solver;
+    // Fine solvers, one per worker thread
+    std::vector<typename Fine::ptr> _fine_solvers;
+
+    // Pool of worker threads for the fine solves
+    std::unique_ptr<ThreadPool> _pool;
+
+    // Window solved by each worker, refilled in place for every window
+    std::vector<typename Output::ptr> _window_buffers;
 
     // Number of fine time steps per coarse time step
     const timeIndex _n_fine_per_coarse;
@@ -49,21 +61,97 @@ namespace para {
     // Result from the fine solvers
     typename Output::ptr _fine_coarsened;
 
+    // Tolerance on the jumps at the coarse boundaries (0 disables the test)
+    const double _tolerance;
+
+    // Largest boundary jump after each parareal iteration
+    std::vector<double> _residuals;
+
+    // Give the fine solvers only their window and the history it reads,
+    // instead of the full history from t = 0
+    const bool _window_local;
+
+    // Parameters the fine parameters of each window are interpolated from, on
+    // the fine grid from _fine_start to _fine_end, or null when the fine
+    // solvers hold the parameters of the whole fine grid
+    typename Fine::Params::ptr _window_source;
+    double _fine_start = 0.;
+    double _fine_end   = 0.;
+
+    // Fine parameters of each window, interpolated and tabulated the first
+    // time the window is solved and reused by every later iteration
+    std::vector<typename Fine::Params::ptr> _window_params;
+    std::unique_ptr<std::once_flag[]>       _window_params_built;
+
+    // Run the coarse corrections and fine windows as a task graph, each one
+    // started as soon as the values it reads are ready, instead of in bulk
+    // synchronous iterations
+    const bool _asynchronous;
+
+    // Values kept of the fine solution, see record()
+    OutputSpec _spec;
+
+    // Values spec keeps of the fine solution of each window, from the last
+    // time it was solved
+    std::vector<typename Output::ptr> _records;
+
+    // Final state of each recorded window, on its way to _fine_coarsened
+    std::vector<std::vector<double>> _record_states;
+
+    // Solve the fine window n on worker w from the given coarse solution, in
+    // buffer once it holds a window
+    void solveWindow(const paraIndex w,
+		     const timeIndex n,
+		     typename Output::ptr coarse_solution,
+		     typename Output::ptr& buffer);
+
+    // Solve with the task graph, see _asynchronous
+    void solveAsynchronous();
+
+    // Record the values spec keeps of window n, and copy its final step to
+    // the fine solution at coarse boundary n+1
+    void recordWindow(const timeIndex n, typename Output::ptr window);
+
   public:
     Parareal(typename Coarse::ptr       coarse_solver,
 	     typename Fine::ptr         fine_solver,
 	     typename Fine::Output::ptr global_output,
 	     const    timeIndex         n_fine_per_coarse,
 	     const    paraIndex         max_iterations,
-	     const    std::string       outpath)
-      : _coarse_solver(coarse_solver),
-	_fine_solver(fine_solver),
-	_n_fine_per_coarse(n_fine_per_coarse),
-	_max_iterations(max_iterations),
-	_outpath(outpath),
+	     const    std::string       outpath,
+	     const    paraIndex         n_threads = 1,
+	     const    double            tolerance = 0.,
+	     const    bool              window_local = true,
+	     const    bool              asynchronous = false)
+      : _outpath(outpath),
 	_global_output(global_output),
+	_max_iterations(max_iterations),
+	_coarse_solver(coarse_solver),
+	_fine_solvers(1, fine_solver),
+	_pool(std::make_unique<ThreadPool>(n_threads)),
+	_window_buffers(_pool->getNumThreads()),
+	_n_fine_per_coarse(n_fine_per_coarse),
 	_old_coarse(std::make_shared<Output>(*_coarse_solver->getSolution())),
-	_new_coarse(std::make_shared<Output>(*_coarse_solver->getSolution())) {}
+	_new_coarse(std::make_shared<Output>(*_coarse_solver->getSolution())),
+	_fine_coarsened(std::make_shared<Output>(*_coarse_solver->getSolution())),
+	_tolerance(tolerance),
+	_window_local(window_local),
+	_asynchronous(asynchronous) {
+      // Each worker gets its own copy of the fine solver so that the windows
+      // can be solved concurrently
+      for (paraIndex w = 1; w < _pool->getNumThreads(); w++) {
+	_fine_solvers.push_back(std::make_shared<Fine>(*fine_solver));
+      }
+
+      // Windows after the first are the largest, so their buffers never grow
+      if (_window_local && _coarse_solver->getNumTimeSteps() > 2) {
+	for (auto& buffer : _window_buffers) {
+	  buffer = createWindow(_coarse_solver->getSolution(), 1, n_fine_per_coarse);
+	}
+      }
+    }
+
+    virtual ~Parareal() = default;
 
     // Generate the vector of fine time steps given the coarse time steps
     timeBins generateFineTime(const timeIndex n) const;
@@ -71,23 +159,71 @@ namespace para {
     // Solve the coarse propagator
     void runCoarseSolver();
 
-    // Solve the fine solver at coarse time index n
-    void runFineSolver(const timeIndex n);
+    // Solve the fine solver of worker w at coarse time index n
+    void runFineSolver(const paraIndex w, const timeIndex n);
 
-    // Update the solution with a parareal iteration
-    void update(const paraIndex k);
+    // Solve the fine solvers of coarse windows [n_start, n_stop) on the pool
+    void runFineSolvers(const timeIndex n_start, const timeIndex n_stop);
 
-     // Assemble global output from vector of fine solver output
-    void assembleGlobalOutput();
+    // Coarsen the fine solution and compute the largest relative jump between
+    // the fine and corrected coarse solutions at the coarse boundaries
+    virtual double computeResidual(const paraIndex k);
+
+    // Update the solution with a parareal iteration
+    virtual void update(const paraIndex k);
+
+    // Copy the fine solution of window n into the global output, or record
+    // it when an output spec is set
+    void assembleWindow(const timeIndex n, typename Output::ptr window);
+
+    // Interpolate the fine parameters window by window from params, instead
+    // of giving the fine solvers parameters for the whole fine grid. The fine
+    // grid has the points of the global output evenly spaced from t_start to
+    // t_end, and exponential coefficients are tabulated for each window when
+    // params has them. The fine solves must be window local, or every window
+    // would hold parameters from t = 0.
+    void interpolateWindows(typename Fine::Params::ptr params,
+			    const double t_start,
+			    const double t_end) {
+      if (!_window_local) {
+	throw std::runtime_error("Window fine parameters need window local fine solves");
+      }
+
+      const timeIndex n_windows = _coarse_solver->getNumTimeSteps() - 1;
+
+      _window_source = params;
+      _fine_start    = t_start;
+      _fine_end      = t_end;
+      _window_params.assign(n_windows, nullptr);
+      _window_params_built = std::make_unique<std::once_flag[]>(n_windows);
+    }
+
+    // Keep only the values spec selects of the fine solution, recorded
+    // window by window as the windows are solved, instead of assembling every
+    // fine step into the global output. The global output then needs no more
+    // than its initial conditions, and holds the record after the solve.
+    void record(const OutputSpec& spec) { _spec = spec; }
 
     // Get outpath
     std::string getOutpath() const { return _outpath; }
 
+    // Get the solution, on the fine grid after any parareal iteration
+    typename Output::ptr getSolution() const { return _global_output; }
+
+    // Get the boundary residual of each parareal iteration that was run
+    const std::vector<double>& getResiduals() const { return _residuals; }
+
+    // Get the number of worker threads
+    const paraIndex getNumThreads() const { return _pool->getNumThreads(); }
+
     // Solve
-    void solve();
+    virtual void solve();
+
+    // Stream the global output and residuals to an xml document at outpath
+    virtual void writeToXML() const;
 
-    // Build xml output doc
-    void writeToXML(pugi::xml_document& doc) const;
+    // Write the global output and residuals to a binary container at outpath
+    virtual void writeToBinary() const;
   };
 
 } // namespace para
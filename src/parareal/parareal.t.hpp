@@ -1,10 +1,12 @@
-#include <iomanip>
-#include <sstream>
-#include <fstream>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <mutex>
 
+#include "utility/binary_io.hpp"
 #include "utility/interpolate.hpp"
-#include "pugi/pugixml.hpp"
+#include "utility/profile.hpp"
+#include "utility/xml_writer.hpp"
 
 using namespace para;
 
@@ -17,6 +19,8 @@ timeBins Parareal<Coarse, Fine>::generateFineTime(const timeIndex n) const {
 
 template <typename Coarse, typename Fine>
 void Parareal<Coarse, Fine>::runCoarseSolver() {
+  UTIL_PROFILE_SCOPE("coarse_sweep");
+
   // Run the coarse solver
   _coarse_solver->solve();
 
@@ -27,28 +31,101 @@ void Parareal<Coarse, Fine>::runCoarseSolver() {
 }
 
 template <typename Coarse, typename Fine>
-void Parareal<Coarse, Fine>::runFineSolver(const timeIndex n) {
-  timeBins fine_time = generateFineTime(n);
+void Parareal<Coarse, Fine>::solveWindow(const paraIndex w,
+					 const timeIndex n,
+					 typename Output::ptr coarse_solution,
+					 typename Output::ptr& buffer) {
+  typename Fine::ptr fine_solver = _fine_solvers.at(w);
 
   // TODO: Move these to input.cpp and use global output to generate new precomp
   // Interpolate the precomputed values for the fine solver
-  typename Output::ptr fine_precomp =
-    createPrecomputed(_coarse_solver->getSolution(), n,	_n_fine_per_coarse);
+  typename Output::ptr fine_precomp;
+  {
+    UTIL_PROFILE_SCOPE("create_precomputed");
+    fine_precomp = _window_local ?
+      createWindow(coarse_solution, n, _n_fine_per_coarse, buffer) :
+      createPrecomputed(coarse_solution, n, _n_fine_per_coarse, buffer);
+  }
+
+  if (_window_source) {
+    // the window has the same steps in every iteration, and asynchronous
+    // iterations may solve it at the same time
+    std::call_once(_window_params_built[n], [&]() {
+      UTIL_PROFILE_SCOPE("interpolate_window");
+
+      auto fine_params = interpolateWindow(_window_source,
+					   _fine_start,
+					   _fine_end,
+					   (_coarse_solver->getNumTimeSteps() - 1) *
+					   _n_fine_per_coarse + 1,
+					   fine_precomp->getTimeOffset(),
+					   fine_precomp->getNumTimeSteps());
+
+      if (_window_source->hasCoefficients()) { fine_params->buildCoefficients(); }
+      _window_params[n] = fine_params;
+    });
+
+    fine_solver->reset(_window_params[n], fine_precomp);
+  } else {
+    fine_solver->reset(fine_precomp);
+  }
 
-  _fine_solver->reset(fine_precomp);
-  _fine_solver->solve();
+  {
+    UTIL_PROFILE_SCOPE("fine_solve");
+    fine_solver->solve();
+  }
 
-  assembleGlobalOutput();
+  UTIL_PROFILE_COUNT("fine_steps", fine_solver->getStopTimeIndex() -
+		     fine_solver->getStartTimeIndex());
 }
 
 template <typename Coarse, typename Fine>
-void Parareal<Coarse, Fine>::update(const paraIndex k) {
-  _fine_coarsened = _global_output->coarsen(_coarse_solver->getTime());
+void Parareal<Coarse, Fine>::runFineSolver(const paraIndex w, const timeIndex n) {
+  solveWindow(w, n, _coarse_solver->getSolution(), _window_buffers[w]);
+
+  UTIL_PROFILE_SCOPE("assemble");
+  assembleWindow(n, _fine_solvers.at(w)->getSolution());
+}
+
+template <typename Coarse, typename Fine>
+void Parareal<Coarse, Fine>::runFineSolvers(const timeIndex n_start,
+					    const timeIndex n_stop) {
+  // The windows only read the coarse solution and write disjoint ranges of the
+  // global output, so they can be handed out to the workers in any order
+  _pool->parallelFor(n_start, n_stop,
+		     [this](const paraIndex w, const timeIndex n) {
+		       runFineSolver(w, n);
+		     });
+}
 
-  double err = 0.;
+template <typename Coarse, typename Fine>
+double Parareal<Coarse, Fine>::computeResidual(const paraIndex) {
+  UTIL_PROFILE_SCOPE("coarsen");
+
+  // recorded windows copy their boundary values as they are solved
+  if (_spec.isFull()) {
+    _global_output->coarsen(_coarse_solver->getTime(), _n_fine_per_coarse,
+			    *_fine_coarsened);
+  }
+
+  double residual = 0.;
 
-  // set initial conditions for the power and reactivity vectors
+  // the corrected coarse solution holds the initial value of each window
   for (timeIndex n = 1; n < _coarse_solver->getNumTimeSteps(); n++) {
+    residual = std::max(residual,
+			_fine_coarsened->computeJump(n,
+						     _coarse_solver->getSolution()));
+  }
+
+  return residual;
+}
+
+template <typename Coarse, typename Fine>
+void Parareal<Coarse, Fine>::update(const paraIndex k) {
+  UTIL_PROFILE_SCOPE("update");
+
+  // the first k+1 coarse points are exact after iteration k and stay frozen
+  for (timeIndex n = k + 1; n < _coarse_solver->getNumTimeSteps(); n++) {
     _coarse_solver->step(n);
 
     // update new coarse solution
@@ -60,29 +137,225 @@ void Parareal<Coarse, Fine>::update(const paraIndex k) {
 		   _new_coarse,
 		   _fine_coarsened,
 		   _old_coarse);
-
-    // compute error for convergence
-    //err += fabs(_new_coarse->getPower(n) -
-    //_old_coarse->getPower(n)) / _coarse_solver.getNumTimeSteps();
   }
 
-  //std::cout << "err: " << err << std::endl;
-
   // Swap the old and new coarse solutions
   std::swap(_new_coarse, _old_coarse);
 }
 
 template <typename Coarse, typename Fine>
-void Parareal<Coarse, Fine>::assembleGlobalOutput() {
-  for (timeIndex n_fine = _fine_solver->getStartTimeIndex();
-       n_fine < _fine_solver->getStopTimeIndex(); n_fine++) {
-    updateCoarse(n_fine, _fine_solver->getSolution(), _global_output);
+void Parareal<Coarse, Fine>::assembleWindow(const timeIndex n,
+					    typename Output::ptr window) {
+  if (!_spec.isFull()) {
+    recordWindow(n, window);
+    return;
+  }
+
+  for (timeIndex n_fine = window->getStartTimeIndex();
+       n_fine < window->getStopTimeIndex(); n_fine++) {
+    updateCoarse(n_fine, window, _global_output);
+  }
+}
+
+template <typename Coarse, typename Fine>
+void Parareal<Coarse, Fine>::recordWindow(const timeIndex n,
+					  typename Output::ptr window) {
+  // the record of an earlier solve of the window is refilled in place
+  typename Output::ptr& record = _records.at(n);
+  if (record) {
+    record->resize(0);
+  } else {
+    record = createRecord(window);
+  }
+
+  // the first window also records the initial conditions
+  const timeIndex n_first = n == 0 ? 0 : window->getStartTimeIndex();
+  const timeIndex n_last  = window->getStopTimeIndex() - 1;
+
+  for (timeIndex n_fine = n_first; n_fine <= n_last; n_fine++) {
+    record->recordImpl(_spec, *window, n_fine);
   }
+
+  // windows end on distinct coarse boundaries, so they can be copied
+  // concurrently through their own buffers
+  std::vector<double>& state = _record_states.at(n);
+  state.resize(window->getStateSize());
+  window->packState(n_last, state.data());
+  _fine_coarsened->unpackState(n + 1, state.data());
+  _fine_coarsened->setTime(n + 1, window->getTime(n_last));
+}
+
+template <typename Coarse, typename Fine>
+void Parareal<Coarse, Fine>::solveAsynchronous() {
+  using id = TaskGraph::id;
+
+  const timeIndex n_steps   = _coarse_solver->getNumTimeSteps();
+  const timeIndex n_windows = n_steps - 1;
+  const timeIndex n_start   = _coarse_solver->getStartTimeIndex();
+  const paraIndex n_iter    = _max_iterations;
+  const id        none      = -1;
+
+  // Iterations run concurrently, so each one keeps its own corrected coarse
+  // solution, coarse predictions, fine values at the coarse boundaries and
+  // coarse solver. The first iteration is the coarse sweep, whose
+  // predictions are its solution.
+  std::vector<typename Output::ptr> corrected(n_iter);
+  std::vector<typename Output::ptr> predicted(n_iter);
+  std::vector<typename Output::ptr> fine_ends(n_iter);
+  std::vector<typename Coarse::ptr> coarse_solvers(n_iter);
+
+  for (paraIndex k = 0; k < n_iter; k++) {
+    corrected[k] = std::make_shared<Output>(*_coarse_solver->getSolution());
+    predicted[k] = std::make_shared<Output>(*_coarse_solver->getSolution());
+    fine_ends[k] = std::make_shared<Output>(*_coarse_solver->getSolution());
+    coarse_solvers[k] = std::make_shared<Coarse>(*_coarse_solver);
+    coarse_solvers[k]->reset(corrected[k]);
+  }
+
+  // Fine solution of each window at each iteration, kept until the
+  // iteration is known not to be the last one for that window and then
+  // handed to a later window to refill
+  std::vector<std::vector<typename Output::ptr>> windows(
+    n_iter, std::vector<typename Output::ptr>(n_windows));
+
+  std::vector<typename Output::ptr> spare;
+  std::mutex spare_mutex;
+  spare.reserve(n_windows);
+
+  std::vector<timeBins> states(_pool->getNumThreads(),
+			       timeBins(_global_output->getStateSize()));
+
+  // Once an iteration converges, the tasks of later ones are skipped
+  _residuals.assign(n_iter, 0.);
+  std::atomic<paraIndex> last(n_iter);
+
+  auto skipped = [&](const paraIndex k) { return k > last.load(); };
+
+  TaskGraph graph;
+
+  std::vector<std::vector<id>> coarse_tasks(n_iter, std::vector<id>(n_steps, none));
+  std::vector<std::vector<id>> fine_tasks(n_iter, std::vector<id>(n_windows, none));
+  std::vector<id> residual_tasks(n_iter, none);
+
+  // Coarse step n of iteration k, corrected with the fine solution of the
+  // iteration before. The first k points are exact and copied over.
+  for (paraIndex k = 0; k < n_iter; k++) {
+    const timeIndex n_first = k == 0 ? n_start : k;
+
+    for (timeIndex n = n_first; n < n_steps; n++) {
+      coarse_tasks[k][n] = graph.add([&, k, n](const paraIndex) {
+	  if (skipped(k)) { return; }
+
+	  UTIL_PROFILE_SCOPE("update");
+
+	  if (k > 0 && n == k) {
+	    for (timeIndex i = 0; i < k; i++) {
+	      updateCoarse(i, corrected[k-1], corrected[k]);
+	    }
+	  }
+
+	  coarse_solvers[k]->step(n);
+	  updateCoarse(n, corrected[k], predicted[k]);
+
+	  if (k > 0) {
+	    updateParareal(n, corrected[k], predicted[k], fine_ends[k-1],
+			   predicted[k-1]);
+	  }
+	}, {0, k, n});
+
+      if (n > n_first) { graph.depend(coarse_tasks[k][n], coarse_tasks[k][n-1]); }
+      if (k > 0 && coarse_tasks[k-1][n] != none) {
+	graph.depend(coarse_tasks[k][n], coarse_tasks[k-1][n]);
+      }
+    }
+  }
+
+  // Fine window n of iteration k, from the corrected coarse solution at n
+  for (paraIndex k = 0; k < n_iter; k++) {
+    for (timeIndex n = std::min<timeIndex>(k, n_windows); n < n_windows; n++) {
+      fine_tasks[k][n] = graph.add([&, k, n](const paraIndex w) {
+	  if (skipped(k)) { return; }
+
+	  {
+	    std::lock_guard<std::mutex> lock(spare_mutex);
+	    if (!spare.empty()) {
+	      windows[k][n] = std::move(spare.back());
+	      spare.pop_back();
+	    }
+	  }
+
+	  solveWindow(w, n, corrected[k], windows[k][n]);
+
+	  // keep the fine value at the end of the window for the correction
+	  const timeIndex n_end = (n + 1) * _n_fine_per_coarse;
+	  windows[k][n]->packState(n_end, states[w].data());
+	  fine_ends[k]->unpackState(n + 1, states[w].data());
+	}, {1, k, n});
+
+      if (coarse_tasks[k][n] != none) {
+	graph.depend(fine_tasks[k][n], coarse_tasks[k][n]);
+      }
+
+      // the correction at n+1 of the next iteration reads the end of window n
+      if (k + 1 < n_iter) {
+	graph.depend(coarse_tasks[k+1][n+1], fine_tasks[k][n]);
+      }
+    }
+  }
+
+  // Residual of iteration k, once its windows and coarse solution are done.
+  // Window n was last solved at iteration min(n, k).
+  for (paraIndex k = 0; k < n_iter; k++) {
+    residual_tasks[k] = graph.add([&, k](const paraIndex) {
+	if (skipped(k)) { return; }
+
+	UTIL_PROFILE_SCOPE("coarsen");
+
+	double residual = 0.;
+	for (timeIndex n = 1; n < n_steps; n++) {
+	  const paraIndex j = std::min<paraIndex>(n - 1, k);
+	  residual = std::max(residual,
+			      fine_ends[j]->computeJump(n, corrected[k]));
+	}
+	_residuals[k] = residual;
+
+	if (residual <= _tolerance || k + 1 == n_iter) {
+	  last = k;
+	  return;
+	}
+
+	// the windows of this iteration are rerun by the next one
+	std::lock_guard<std::mutex> lock(spare_mutex);
+	for (timeIndex n = k + 1; n < n_windows; n++) {
+	  spare.push_back(std::move(windows[k][n]));
+	}
+      }, {0, k, n_steps});
+
+    for (timeIndex n = std::min<timeIndex>(k, n_windows); n < n_windows; n++) {
+      graph.depend(residual_tasks[k], fine_tasks[k][n]);
+    }
+    if (coarse_tasks[k][n_windows] != none) {
+      graph.depend(residual_tasks[k], coarse_tasks[k][n_windows]);
+    }
+    if (k > 0) { graph.depend(residual_tasks[k], residual_tasks[k-1]); }
+  }
+
+  graph.run(*_pool);
+
+  // Assemble the windows of the last iteration into the global output
+  _residuals.resize(last + 1);
+
+  UTIL_PROFILE_SCOPE("assemble");
+  for (timeIndex n = 0; n < n_windows; n++) {
+    assembleWindow(n, windows[std::min<timeIndex>(n, last)][n]);
+  }
+
+  _coarse_solver->reset(corrected[last]);
 }
 
 template <typename Coarse, typename Fine>
 void Parareal<Coarse, Fine>::solve() {
-  using timer = std::chrono::system_clock;
+  using timer = std::chrono::steady_clock;
   using namespace std::chrono_literals;
 
   timer::time_point clock_start;
@@ -92,25 +365,69 @@ void Parareal<Coarse, Fine>::solve() {
   // Start the chrono timer
   clock_start = timer::now();
 
-  if (_max_iterations != 0) {
+  // sized once, so the iterations do not reallocate it
+  _residuals.reserve(_max_iterations);
+
+  if (!_spec.isFull()) {
+    _records.assign(_coarse_solver->getNumTimeSteps() - 1, nullptr);
+    _record_states.resize(_records.size());
+  }
+
+  if (_max_iterations != 0 && _asynchronous) {
+    solveAsynchronous();
+  }
+  else if (_max_iterations != 0) {
     // Run the coarse propagator
     runCoarseSolver();
 
+    const timeIndex n_windows = _coarse_solver->getNumTimeSteps() - 1;
+
     for (paraIndex k = 0; k < _max_iterations; k++) {
-      // loop over each index of the precomputed values (in parallel)
-      for (timeIndex n = 0; n < _coarse_solver->getNumTimeSteps() - 1; n++) {
-	runFineSolver(n);
+      UTIL_PROFILE_ITERATION(k);
+
+      // loop over each index of the precomputed values (in parallel), skipping
+      // the leading windows whose initial values are already exact
+      runFineSolvers(std::min<timeIndex>(k, n_windows), n_windows);
+
+      // Stop once the fine solution is continuous at every coarse boundary
+      _residuals.push_back(computeResidual(k));
+
+      if (_residuals.back() <= _tolerance || k + 1 == _max_iterations) {
+	break;
       }
 
       // Update the coarse solution
       update(k);
     }
+
+    UTIL_PROFILE_ITERATION(-1);
   }
   else {
     runCoarseSolver();
     _global_output = _coarse_solver->getSolution();
   }
 
+  // gather the records of the windows in order, or record the coarse
+  // solution when no window was solved
+  if (!_spec.isFull()) {
+    UTIL_PROFILE_SCOPE("assemble");
+
+    auto solution = createRecord(_global_output);
+
+    if (_max_iterations == 0) {
+      for (timeIndex n = 0; n < _global_output->getNumTimeSteps(); n++) {
+	solution->recordImpl(_spec, *_global_output, n);
+      }
+    }
+
+    for (const auto& record : _records) {
+      if (record) { solution->appendImpl(*record); }
+    }
+
+    _global_output = solution;
+    _records.clear();
+  }
+
   clock_stop = timer::now();
 
   duration = clock_stop - clock_start;
@@ -120,15 +437,40 @@ void Parareal<Coarse, Fine>::solve() {
 }
 
 template <typename Coarse, typename Fine>
-void Parareal<Coarse, Fine>::writeToXML(pugi::xml_document& doc) const {
-  std::ofstream out(_outpath);
+void Parareal<Coarse, Fine>::writeToXML() const {
+  util::XMLWriter writer(_outpath);
 
-  // Create teh root level node
-  doc.append_child("parareal");
+  // Create the root level node
+  writer.open("parareal");
+  writer.attribute("solve_time", _global_output->getSolveTime());
+  writer.attribute("n_iterations", _residuals.size());
 
   // Write to xml
-  _global_output->writeToXML(doc);
+  _global_output->writeToXML(writer);
+
+  // Record the convergence history of the parareal iterations
+  writer.open("residuals");
+  writer.attribute("tolerance", _tolerance);
+  writer.values(_residuals);
+  writer.close();
+
+#ifdef UTIL_PROFILE
+  util::Profiler::instance().writeToXML(writer);
+#endif
+
+  writer.close();
+  writer.finish();
+}
+
+template <typename Coarse, typename Fine>
+void Parareal<Coarse, Fine>::writeToBinary() const {
+  util::BinaryWriter writer(_outpath);
+
+  _global_output->writeToBinary(writer);
+
+  // Record the convergence history of the parareal iterations
+  writer.add("residuals", _residuals);
+  writer.add("tolerance", _tolerance);
 
-  // Save xml document
-  doc.save(out);
+  writer.write();
 }
@@ -0,0 +1,152 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "parareal/service.hpp"
+#include "pugi/pugixml.hpp"
+
+// Read exactly size bytes, false at the end of the input
+static bool readAll(const int fd, char* data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::read(fd, data, size);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool writeAll(const int fd, const char* data, std::size_t size) {
+  while (size > 0) {
+    const ssize_t n = ::write(fd, data, size);
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n <= 0) { return false; }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool writeResponse(const int fd,
+			  const std::uint64_t status,
+			  const std::string& payload) {
+  const std::uint64_t header[2] = {status, payload.size()};
+  return writeAll(fd, reinterpret_cast<const char*>(header), sizeof(header)) &&
+    writeAll(fd, payload.data(), payload.size());
+}
+
+Service::Service(const std::string& scratch_path) : _scratch_path(scratch_path) {}
+
+std::string Service::solve(const std::string& document) {
+  pugi::xml_document input_file;
+  const pugi::xml_parse_result load_result =
+    input_file.load_buffer(document.data(), document.size());
+
+  if (!load_result) {
+    throw std::runtime_error(load_result.description());
+  }
+
+  pugi::xml_node parareal_node = input_file.child("parareal");
+  if (!parareal_node) {
+    throw std::runtime_error("The input has no parareal node");
+  }
+
+  // every output goes to the scratch container
+  for (pugi::xml_node node : {parareal_node, parareal_node.child("ensemble")}) {
+    if (!node) { continue; }
+    if (!node.attribute("outpath"))       { node.append_attribute("outpath"); }
+    if (!node.attribute("output_format")) { node.append_attribute("output_format"); }
+    node.attribute("outpath").set_value(_scratch_path.c_str());
+    node.attribute("output_format").set_value("binary");
+  }
+
+  std::remove(_scratch_path.c_str());
+  Input::execute(input_file, &_cache);
+
+  std::ifstream output(_scratch_path, std::ios::binary);
+  if (!output) {
+    throw std::runtime_error("The input wrote no output");
+  }
+
+  std::ostringstream container;
+  container << output.rdbuf();
+  std::remove(_scratch_path.c_str());
+
+  return container.str();
+}
+
+bool Service::serve(const int in_fd, const int out_fd) {
+  // a client that goes away ends its connection, not the service
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::uint64_t length;
+  std::string   document;
+
+  while (readAll(in_fd, reinterpret_cast<char*>(&length), sizeof(length))) {
+    if (length == 0) { return true; }
+
+    document.resize(length);
+    if (!readAll(in_fd, &document[0], length)) { break; }
+
+    std::uint64_t status = 0;
+    std::string   payload;
+
+    try {
+      payload = solve(document);
+    } catch (const std::exception& error) {
+      status  = 1;
+      payload = error.what();
+      std::cout << "Request failed: " << payload << std::endl;
+    }
+
+    if (!writeResponse(out_fd, status, payload)) { break; }
+  }
+
+  return false;
+}
+
+void Service::listen(const std::string& socket_path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path " + socket_path + " is too long");
+  }
+  socket_path.copy(address.sun_path, socket_path.size());
+
+  const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ::unlink(socket_path.c_str());
+
+  if (server < 0 ||
+      ::bind(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+      ::listen(server, 8) < 0) {
+    throw std::runtime_error("Could not listen on " + socket_path);
+  }
+
+  std::cout << "Listening on " << socket_path << std::endl;
+
+  bool stopped = false;
+  while (!stopped) {
+    const int client = ::accept(server, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) { continue; }
+      std::cout << "Could not accept a connection on " << socket_path << std::endl;
+      break;
+    }
+
+    stopped = serve(client, client);
+    ::close(client);
+  }
+
+  ::close(server);
+  ::unlink(socket_path.c_str());
+}
@@ -0,0 +1,44 @@
+#ifndef _PARAREAL_SERVICE_HEADER_
+#define _PARAREAL_SERVICE_HEADER_
+
+#include <cstdint>
+#include <string>
+
+#include "parareal/input.hpp"
+
+// Long-running solver that answers a stream of inputs, keeping the parsed
+// and interpolated parameters of every case it has seen. Requests and
+// responses are framed as
+//
+//   request    uint64_t length, then length bytes of an input document
+//   response   uint64_t status, 0 on success
+//              uint64_t length, then length bytes of the binary container
+//              of the output, or of the error message on failure
+//
+// all little-endian. A request of length zero stops the service. Every
+// output of a request is written to the binary container returned, whatever
+// its outpath says.
+class Service {
+private:
+  Input::Cache _cache;
+  std::string  _scratch_path; // where the outputs are written and read back
+
+public:
+  Service(const std::string& scratch_path);
+
+  const Input::Cache& getCache() const { return _cache; }
+  Input::Cache& getCache() { return _cache; }
+
+  // Solve an input document, returning the binary container of its output
+  std::string solve(const std::string& document);
+
+  // Answer requests read from in_fd on out_fd until the end of the input or
+  // a stop request, returning whether it was stopped
+  bool serve(const int in_fd, const int out_fd);
+
+  // Accept connections on a Unix socket, answering one at a time until a
+  // stop request
+  void listen(const std::string& socket_path);
+};
+
+#endif
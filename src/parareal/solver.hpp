@@ -36,7 +36,7 @@ namespace para {
       return _params->getTime(n);
     }
 
-    const timeBins& getTime() const {
+    const util::Series& getTime() const {
       return _params->getTime();
     }
 
@@ -2,11 +2,14 @@
 #define _PARAREAL_SOLVER_OUTPUT_HEADER_
 
 #include <memory>
+#include <string>
 
 #include "parareal/definitions.hpp"
+#include "parareal/output_spec.hpp"
 
-namespace pugi {
-  class xml_document;
+namespace util {
+  class BinaryWriter;
+  class XMLWriter;
 }
 
 namespace para {
@@ -27,6 +30,9 @@ protected:
   // Index to stop solve
   timeIndex _n_stop;
 
+  // Time index of the first stored value (nonzero for window-local outputs)
+  timeIndex _n_offset;
+
   double _solve_time;
 
 public:
@@ -34,36 +40,70 @@ public:
   SolverOutput(const timeIndex num_time_steps,
 	       const timeIndex n_start,
 	       const timeIndex n_stop)
-    : _time(num_time_steps, 0.), _n_start(n_start), _n_stop(n_stop) {}
+    : _time(num_time_steps, 0.),
+      _n_start(n_start),
+      _n_stop(n_stop),
+      _n_offset(0) {}
 
   // Construct from data vectors
   SolverOutput(const timeBins& time,
 	       const timeIndex n_start,
-	       const timeIndex n_stop)
-    : _time(time), _n_start(n_start), _n_stop(n_stop) {}
+	       const timeIndex n_stop,
+	       const timeIndex n_offset = 0)
+    : _time(time), _n_start(n_start), _n_stop(n_stop), _n_offset(n_offset) {}
 
   // Getters
-  const timeIndex getNumTimeSteps() const { return _time.size(); }
+  const timeIndex getNumTimeSteps() const { return _n_offset + _time.size(); }
+
+  const timeIndex getTimeOffset() const { return _n_offset; }
 
   const timeIndex getStartTimeIndex() const { return _n_start; }
 
   const timeIndex getStopTimeIndex() const { return _n_stop; }
 
-  const double getTime(const timeIndex n) const { return _time[n]; }
+  const double getTime(const timeIndex n) const {
+    return _time[n - _n_offset];
+  }
+  const timeBins& getTime() const { return _time; }
 
   // Set solve time
   void setSolveTime(double solve_time) { _solve_time = solve_time; }
+  const double getSolveTime() const { return _solve_time; }
 
   // Set the time at index n
-  void setTime(const timeIndex n, const double val) { _time[n] = val; }
+  void setTime(const timeIndex n, const double val) {
+    _time[n - _n_offset] = val;
+  }
 
   // Create output object with truncated precomputed values from coarse solver
   virtual SolverOutput::ptr
   createPrecomputedImpl(const timeIndex n,
 			const timeIndex n_fine_per_coarse) const = 0;
 
-  // Create output object with only information from the coarse time steps
-  //virtual SolverOutput::ptr coarsenImpl(const timeBins& coarse_time) const = 0;
+  // Create output object holding only the fine window after coarse index n and
+  // the history values the fine solver reads before it
+  virtual SolverOutput::ptr
+  createWindowImpl(const timeIndex n,
+		   const timeIndex n_fine_per_coarse) const = 0;
+
+  // Fill precomp, an output of the same type, with the values that
+  // createPrecomputedImpl would create, reusing its storage
+  virtual void fillPrecomputedImpl(const timeIndex n,
+				   const timeIndex n_fine_per_coarse,
+				   SolverOutput& precomp) const = 0;
+
+  // Fill window, an output of the same type, with the values that
+  // createWindowImpl would create, reusing its storage
+  virtual void fillWindowImpl(const timeIndex n,
+			      const timeIndex n_fine_per_coarse,
+			      SolverOutput& window) const = 0;
+
+  // Create output object holding steps [n_start, n_stop) of this output and
+  // the n_history steps before them, on the same time grid
+  virtual SolverOutput::ptr
+  createSliceImpl(const timeIndex n_start,
+		  const timeIndex n_stop,
+		  const timeIndex n_history) const = 0;
 
   // Resize the number of time steps
   virtual void resize(const timeIndex n_steps) = 0;
@@ -77,8 +117,35 @@ public:
 				  ptr fine_coarsened,
 				  ptr old_coarse) = 0;
 
+  // Create an empty output of the same type to record steps into
+  virtual SolverOutput::ptr createRecordImpl() const = 0;
+
+  // Append the values spec keeps of step n of source, an output of the same
+  // type, to this record. Steps are recorded in order, and the times of spec
+  // after step n-1 up to step n are interpolated from the two steps.
+  virtual void recordImpl(const OutputSpec& spec,
+			  const SolverOutput& source,
+			  const timeIndex n) = 0;
+
+  // Append the steps of another record of the same spec
+  virtual void appendImpl(const SolverOutput& record) = 0;
+
+  // Number of values packed to describe the state at a single time step
+  virtual const std::size_t getStateSize() const = 0;
+
+  // Pack the state at time index n into a contiguous buffer
+  virtual void packState(const timeIndex n, double* buf) const = 0;
+
+  // Unpack the state at time index n from a contiguous buffer
+  virtual void unpackState(const timeIndex n, const double* buf) = 0;
+
   // Write the output to an xml document
-  virtual void writeToXML(pugi::xml_document& doc) const = 0;
+  // Stream the stored series as an xml element
+  virtual void writeToXML(util::XMLWriter& writer) const = 0;
+
+  // Add the stored series to a binary container, with names after prefix
+  virtual void writeToBinary(util::BinaryWriter& writer,
+			     const std::string& prefix = "") const = 0;
 };
 
   template<typename T>
@@ -91,9 +158,55 @@ public:
   }
 
   template<typename T>
-  std::shared_ptr<T> coarsen(std::shared_ptr<T> fine_output,
-			     const timeBins& coarse_time) {
-    return std::static_pointer_cast<T>(fine_output->coarsenImpl(coarse_time));
+  std::shared_ptr<T> createWindow(std::shared_ptr<T> precomp,
+				  const timeIndex n,
+				  const timeIndex n_fine_per_coarse) {
+    return std::static_pointer_cast<T>(
+	       precomp->createWindowImpl(n,
+					 n_fine_per_coarse));
+  }
+
+  // Create the precomputed values into buffer, which is allocated on the first
+  // call and refilled in place on the later ones
+  template<typename T>
+  std::shared_ptr<T> createPrecomputed(std::shared_ptr<T> precomp,
+				       const timeIndex n,
+				       const timeIndex n_fine_per_coarse,
+				       std::shared_ptr<T>& buffer) {
+    if (buffer) {
+      precomp->fillPrecomputedImpl(n, n_fine_per_coarse, *buffer);
+    } else {
+      buffer = createPrecomputed(precomp, n, n_fine_per_coarse);
+    }
+    return buffer;
+  }
+
+  // Create the window into buffer, as createPrecomputed does
+  template<typename T>
+  std::shared_ptr<T> createWindow(std::shared_ptr<T> precomp,
+				  const timeIndex n,
+				  const timeIndex n_fine_per_coarse,
+				  std::shared_ptr<T>& buffer) {
+    if (buffer) {
+      precomp->fillWindowImpl(n, n_fine_per_coarse, *buffer);
+    } else {
+      buffer = createWindow(precomp, n, n_fine_per_coarse);
+    }
+    return buffer;
+  }
+
+  template<typename T>
+  std::shared_ptr<T> createSlice(std::shared_ptr<T> output,
+				 const timeIndex n_start,
+				 const timeIndex n_stop,
+				 const timeIndex n_history) {
+    return std::static_pointer_cast<T>(
+	       output->createSliceImpl(n_start, n_stop, n_history));
+  }
+
+  template<typename T>
+  std::shared_ptr<T> createRecord(std::shared_ptr<T> output) {
+    return std::static_pointer_cast<T>(output->createRecordImpl());
   }
 
   template<typename T>
@@ -3,11 +3,14 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include "parareal/definitions.hpp"
+#include "utility/series.hpp"
 
-namespace pugi {
-  class xml_document;
+namespace util {
+  class BinaryWriter;
+  class XMLWriter;
 }
 
 namespace para {
@@ -20,29 +23,71 @@ public:
   using ptr       = std::shared_ptr<SolverParameters>;
 
 protected:
-  const timeBins _time; // time points
+  const util::Series _time; // time points
+
+  // Time index of the first stored value (nonzero for window parameters)
+  const timeIndex _n_offset;
 
 public:
-  SolverParameters(const timeBins& time) : _time(time) {}
+  SolverParameters(const util::Series& time, const timeIndex n_offset = 0)
+    : _time(time), _n_offset(n_offset) {}
 
-  // Getters
+  // Getters take global time indices, shifted by the offset
   virtual const precIndex getNumPrecursors() const = 0;
-  const timeIndex getNumTimeSteps()    const { return _time.size(); }
-  const double    getTime(timeIndex n) const { return _time.at(n);  }
-  const timeBins& getTime()            const { return _time;        }
+  const timeIndex getNumTimeSteps()    const { return _n_offset + _time.size(); }
+  const timeIndex getTimeOffset()      const { return _n_offset; }
+  const double    getTime(timeIndex n) const { return _time.at(n - _n_offset); }
+  const util::Series& getTime()        const { return _time; }
+
+  // Time step size ending at index n (the first step size at n = 0)
+  const double computeDT(const timeIndex n) const {
+    return n > 0 ? getTime(n) - getTime(n-1) : getTime(n+1) - getTime(n);
+  }
+
+  // Ratio of the previous to the current time step size
+  const double computeGamma(const timeIndex n) const {
+    return n < 2 ? 1.0 : computeDT(n-1) / computeDT(n);
+  }
 
   virtual SolverParameters::ptr
-  interpolateImpl(const timeBins& fine_time) const = 0;
+  interpolateImpl(const util::Series& fine_time) const = 0;
 
-  virtual void writeToXML(pugi::xml_document& doc) const = 0;
+  // Interpolate the parameters of steps [n_offset, n_stop) of the fine grid
+  // of n_fine evenly spaced points from t_start to t_end, the window of
+  // interpolateImpl on that grid without the steps outside of it
+  virtual SolverParameters::ptr
+  interpolateWindowImpl(const double    t_start,
+			const double    t_end,
+			const timeIndex n_fine,
+			const timeIndex n_offset,
+			const timeIndex n_stop) const = 0;
+
+  // Stream the stored series as an xml element
+  virtual void writeToXML(util::XMLWriter& writer) const = 0;
+
+  // Add the time series to a binary container, with names after prefix
+  virtual void writeToBinary(util::BinaryWriter& writer,
+			     const std::string& prefix = "") const = 0;
 };
 
   template<typename T>
   std::shared_ptr<T> interpolate(std::shared_ptr<T> params,
-				 const timeBins& fine_time) {
+				 const util::Series& fine_time) {
     return std::static_pointer_cast<T>(params->interpolateImpl(fine_time));
   }
 
+  template<typename T>
+  std::shared_ptr<T> interpolateWindow(std::shared_ptr<T> params,
+				       const double    t_start,
+				       const double    t_end,
+				       const timeIndex n_fine,
+				       const timeIndex n_offset,
+				       const timeIndex n_stop) {
+    return std::static_pointer_cast<T>(
+	       params->interpolateWindowImpl(t_start, t_end, n_fine,
+					     n_offset, n_stop));
+  }
+
 } // namespace para
 
 #endif
@@ -0,0 +1,128 @@
+#ifndef _PARAREAL_TASK_GRAPH_HEADER_
+#define _PARAREAL_TASK_GRAPH_HEADER_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+#include "parareal/thread_pool.hpp"
+
+namespace para {
+
+  // Tasks with dependencies, run on the workers of a thread pool. A task is
+  // started as soon as every task it depends on has finished, so there are
+  // no barriers between the stages of the work. Among the tasks that are
+  // ready, the one with the lowest priority value is started first.
+  class TaskGraph {
+  public:
+    using paraIndex = para::paraIndex;
+    using id        = std::size_t;
+    using priority  = std::tuple<std::size_t, std::size_t, std::size_t>;
+    using task      = std::function<void(const paraIndex)>;
+
+  private:
+    struct Node {
+      task             run;
+      priority         rank;
+      std::vector<id>  successors;
+      std::size_t      n_dependencies = 0;
+    };
+
+    std::vector<Node> _nodes;
+
+    // Scheduling state of a run
+    std::mutex              _mutex;
+    std::condition_variable _ready_changed;
+    std::vector<std::size_t> _remaining;
+    std::size_t             _n_finished = 0;
+
+    // First exception thrown by a task, after which no task is started
+    std::exception_ptr _error;
+
+    using entry = std::pair<priority, id>;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> _ready;
+
+    // Run ready tasks until every task of the graph has finished, or one of
+    // them has thrown
+    void work(const paraIndex worker) {
+      std::unique_lock<std::mutex> lock(_mutex);
+
+      while (true) {
+	_ready_changed.wait(lock, [&] {
+	    return _error || !_ready.empty() || _n_finished == _nodes.size();
+	  });
+
+	if (_error || _ready.empty()) { return; }
+
+	const id next = _ready.top().second;
+	_ready.pop();
+
+	lock.unlock();
+	try {
+	  _nodes[next].run(worker);
+	} catch (...) {
+	  lock.lock();
+	  if (!_error) { _error = std::current_exception(); }
+	  _ready_changed.notify_all();
+	  return;
+	}
+	lock.lock();
+
+	_n_finished++;
+
+	for (const id successor : _nodes[next].successors) {
+	  if (--_remaining[successor] == 0) {
+	    _ready.push({_nodes[successor].rank, successor});
+	  }
+	}
+
+	_ready_changed.notify_all();
+      }
+    }
+
+  public:
+    // Add a task, returning its id for the dependencies
+    id add(const task& run, const priority& rank) {
+      _nodes.push_back({run, rank, {}, 0});
+      return _nodes.size() - 1;
+    }
+
+    // Run task after task on
+    void depend(const id task, const id on) {
+      _nodes[on].successors.push_back(task);
+      _nodes[task].n_dependencies++;
+    }
+
+    const std::size_t getNumTasks() const { return _nodes.size(); }
+
+    // Run every task on the workers of pool and wait for them to finish. If
+    // a task throws, the tasks not yet started are skipped and its exception
+    // is rethrown once the running ones have finished.
+    void run(ThreadPool& pool) {
+      _remaining.resize(_nodes.size());
+      _n_finished = 0;
+      _error      = nullptr;
+      _ready      = decltype(_ready)();
+
+      for (id i = 0; i < _nodes.size(); i++) {
+	_remaining[i] = _nodes[i].n_dependencies;
+	if (_remaining[i] == 0) { _ready.push({_nodes[i].rank, i}); }
+      }
+
+      pool.parallelFor(0, pool.getNumThreads(),
+		       [this](const paraIndex worker, const timeIndex) {
+			 work(worker);
+		       });
+
+      if (_error) { std::rethrow_exception(_error); }
+    }
+  }; // class TaskGraph
+
+} // namespace para
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef _PARAREAL_THREAD_POOL_HEADER_
+#define _PARAREAL_THREAD_POOL_HEADER_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "parareal/definitions.hpp"
+
+namespace para {
+
+  // Fixed-size pool of worker threads. Work items are handed out one index
+  // at a time so windows of uneven cost are balanced across the workers.
+  class ThreadPool {
+  public:
+    using timeIndex = para::timeIndex;
+    using paraIndex = para::paraIndex;
+    using task      = std::function<void(const paraIndex, const timeIndex)>;
+
+  private:
+    std::vector<std::thread> _workers;
+
+    std::mutex              _mutex;
+    std::condition_variable _work_ready;
+    std::condition_variable _work_done;
+
+    // Current batch of work
+    const task*            _task = nullptr;
+    std::atomic<timeIndex> _next;
+    timeIndex              _stop       = 0;
+    paraIndex              _n_busy     = 0;
+    std::size_t            _generation = 0;
+    bool                   _shutdown   = false;
+
+    // First exception thrown by the current batch
+    std::exception_ptr _error;
+
+    // Pull indices from the current batch until it is exhausted. A throwing
+    // item skips the rest of the batch and its exception is kept for
+    // parallelFor to rethrow.
+    void drain(const paraIndex worker) {
+      for (timeIndex i = _next++; i < _stop; i = _next++) {
+	try {
+	  (*_task)(worker, i);
+	} catch (...) {
+	  std::lock_guard<std::mutex> lock(_mutex);
+	  if (!_error) { _error = std::current_exception(); }
+	  _next = _stop;
+	}
+      }
+    }
+
+    void work(const paraIndex worker) {
+      std::size_t generation = 0;
+
+      while (true) {
+	{
+	  std::unique_lock<std::mutex> lock(_mutex);
+	  _work_ready.wait(lock, [&] {
+	      return _shutdown || _generation != generation;
+	    });
+
+	  if (_shutdown) { return; }
+
+	  generation = _generation;
+	}
+
+	drain(worker);
+
+	{
+	  std::lock_guard<std::mutex> lock(_mutex);
+	  if (--_n_busy == 0) { _work_done.notify_one(); }
+	}
+      }
+    }
+
+  public:
+    // The calling thread acts as worker 0, so n_threads - 1 threads are spawned
+    ThreadPool(const paraIndex n_threads) : _next(0) {
+      if (n_threads < 1) {
+	throw std::runtime_error("A thread pool needs at least 1 thread");
+      }
+
+      for (paraIndex w = 1; w < n_threads; w++) {
+	_workers.emplace_back(&ThreadPool::work, this, w);
+      }
+    }
+
+    ~ThreadPool() {
+      {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_shutdown = true;
+      }
+      _work_ready.notify_all();
+
+      for (auto& worker : _workers) { worker.join(); }
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    const paraIndex getNumThreads() const { return _workers.size() + 1; }
+
+    // Call f(worker, i) for every i in [start, stop) and wait for completion.
+    // If f throws, the remaining indices are skipped and the first exception
+    // is rethrown once every worker is done with the batch.
+    void parallelFor(const timeIndex start, const timeIndex stop, const task& f) {
+      if (start >= stop) { return; }
+
+      {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_task   = &f;
+	_next   = start;
+	_stop   = stop;
+	_n_busy = _workers.size();
+	_generation++;
+      }
+      _work_ready.notify_all();
+
+      drain(0);
+
+      std::unique_lock<std::mutex> lock(_mutex);
+      _work_done.wait(lock, [&] { return _n_busy == 0; });
+      _task = nullptr;
+
+      if (_error) {
+	std::exception_ptr error = nullptr;
+	std::swap(error, _error);
+	lock.unlock();
+	std::rethrow_exception(error);
+      }
+    }
+  }; // class ThreadPool
+
+} // namespace para
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef _UTILITY_BINARY_IO_HEADER_
+#define _UTILITY_BINARY_IO_HEADER_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utility/series.hpp"
+
+// Binary container for named double arrays. The layout is
+//
+//   char     magic[8]           "EPKEBIN1"
+//   uint64_t n_arrays
+//   n_arrays entries of
+//     char     name[48]         zero padded
+//     uint64_t offset           bytes from the start of the file
+//     uint64_t size             number of doubles
+//   contiguous little-endian double arrays
+//
+// Every offset is a multiple of 8, so the arrays can be used in place from a
+// memory map of the file.
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+	      "the binary container is little-endian");
+
+namespace util {
+
+constexpr char        binary_magic[8]   = {'E','P','K','E','B','I','N','1'};
+constexpr std::size_t binary_name_size  = 48;
+constexpr std::size_t binary_entry_size = binary_name_size + 16;
+constexpr char        binary_extension[] = ".epkb";
+
+// Outputs and inputs whose path ends in the binary extension use the
+// container instead of xml
+inline bool isBinaryPath(const std::string& path) {
+  const std::size_t n = sizeof(binary_extension) - 1;
+  return path.size() >= n && path.compare(path.size() - n, n, binary_extension) == 0;
+}
+
+// Read-only view of a contiguous array owned elsewhere
+class ArrayView {
+private:
+  const double* _data;
+  std::size_t   _size;
+
+public:
+  ArrayView(const double* data = nullptr, const std::size_t size = 0)
+    : _data(data), _size(size) {}
+
+  const double* data() const { return _data; }
+  const std::size_t size() const { return _size; }
+  const double operator[](const std::size_t i) const { return _data[i]; }
+  const double* begin() const { return _data; }
+  const double* end() const { return _data + _size; }
+
+  std::vector<double> toVector() const { return {begin(), end()}; }
+};
+
+// Collects arrays and writes them straight from the caller's buffers. The
+// buffers must stay alive until write() is called.
+class BinaryWriter {
+private:
+  struct Entry {
+    std::string   name;
+    const double* data;
+    std::size_t   size;
+    std::size_t   stride;
+    std::vector<double> storage; // values without a buffer of the caller
+  };
+
+  std::string        _path;
+  std::vector<Entry> _entries;
+
+public:
+  BinaryWriter(const std::string& path) : _path(path) {}
+
+  // Add an array of size values read every stride doubles from data
+  void add(const std::string& name,
+	   const double* data,
+	   const std::size_t size,
+	   const std::size_t stride = 1) {
+    if (name.size() >= binary_name_size) {
+      throw std::runtime_error("Array name " + name +
+			       " is too long for the binary format");
+    }
+    _entries.push_back({name, data, size, stride, {}});
+  }
+
+  void add(const std::string& name, const std::vector<double>& data) {
+    add(name, data.data(), data.size());
+  }
+
+  // Add a series, straight from its storage unless it is a uniform grid
+  void add(const std::string& name, const Series& series) {
+    if (series.data()) {
+      add(name, series.data(), series.size(), series.stride());
+      return;
+    }
+    add(name, nullptr, series.size());
+    _entries.back().storage = series.toVector();
+  }
+
+  // Add a single value, which is stored as an array of length one
+  void add(const std::string& name, const double value) {
+    add(name, nullptr, 1);
+    _entries.back().storage.assign(1, value);
+  }
+
+  void write() const {
+    std::ofstream out(_path, std::ios::binary);
+
+    if (!out) {
+      throw std::runtime_error("Could not open " + _path + " for writing");
+    }
+
+    const std::uint64_t n_arrays = _entries.size();
+    out.write(binary_magic, sizeof(binary_magic));
+    out.write(reinterpret_cast<const char*>(&n_arrays), sizeof(n_arrays));
+
+    std::uint64_t offset = sizeof(binary_magic) + sizeof(n_arrays) +
+      n_arrays * binary_entry_size;
+
+    for (const auto& entry : _entries) {
+      char name[binary_name_size] = {};
+      std::memcpy(name, entry.name.data(), entry.name.size());
+
+      const std::uint64_t size = entry.size;
+      out.write(name, binary_name_size);
+      out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+      out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+
+      offset += size * sizeof(double);
+    }
+
+    // strided arrays are gathered through a small buffer
+    std::vector<double> buffer;
+
+    for (const auto& entry : _entries) {
+      const double* data = entry.data ? entry.data : entry.storage.data();
+
+      if (entry.stride == 1) {
+	out.write(reinterpret_cast<const char*>(data),
+		  entry.size * sizeof(double));
+	continue;
+      }
+
+      buffer.resize(std::min<std::size_t>(entry.size, 4096));
+
+      for (std::size_t i = 0; i < entry.size; i += buffer.size()) {
+	const std::size_t n = std::min(buffer.size(), entry.size - i);
+	for (std::size_t j = 0; j < n; j++) {
+	  buffer[j] = data[(i + j) * entry.stride];
+	}
+	out.write(reinterpret_cast<const char*>(buffer.data()),
+		  n * sizeof(double));
+      }
+    }
+
+    // the last of the data only reaches the file when the stream is closed
+    out.close();
+
+    if (!out) {
+      throw std::runtime_error("Failed to write " + _path);
+    }
+  }
+};
+
+// Memory map of a binary container. The views it hands out point into the
+// map and are valid for the lifetime of the object.
+class BinaryFile {
+private:
+  std::string _path;
+  void*       _map    = MAP_FAILED;
+  std::size_t _length = 0;
+
+  std::map<std::string, ArrayView> _arrays;
+
+  [[noreturn]] void fail(const std::string& message) const {
+    throw std::runtime_error(_path + ": " + message);
+  }
+
+  // Unmap the file before failing, as the destructor does not run when the
+  // constructor throws
+  [[noreturn]] void failMapped(const std::string& message) {
+    munmap(_map, _length);
+    _map = MAP_FAILED;
+    fail(message);
+  }
+
+public:
+  BinaryFile(const std::string& path) : _path(path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) { fail("could not open binary file"); }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) { close(fd); fail("could not stat binary file"); }
+    _length = info.st_size;
+
+    if (_length > 0) {
+      _map = mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+
+    if (_map == MAP_FAILED) { fail("could not map binary file"); }
+
+    const char* base = static_cast<const char*>(_map);
+    std::uint64_t n_arrays;
+
+    if (_length < sizeof(binary_magic) + sizeof(n_arrays) ||
+	std::memcmp(base, binary_magic, sizeof(binary_magic)) != 0) {
+      failMapped("not an epke binary file");
+    }
+
+    std::memcpy(&n_arrays, base + sizeof(binary_magic), sizeof(n_arrays));
+    const char* entry = base + sizeof(binary_magic) + sizeof(n_arrays);
+
+    if (n_arrays > (_length - (entry - base)) / binary_entry_size) {
+      failMapped("truncated array table");
+    }
+
+    for (std::uint64_t i = 0; i < n_arrays; i++, entry += binary_entry_size) {
+      std::uint64_t offset, size;
+      std::memcpy(&offset, entry + binary_name_size, sizeof(offset));
+      std::memcpy(&size, entry + binary_name_size + 8, sizeof(size));
+
+      if (offset % sizeof(double) != 0 || offset > _length ||
+	  size > (_length - offset) / sizeof(double)) {
+	failMapped("array outside of the file");
+      }
+
+      const std::string name(entry, strnlen(entry, binary_name_size));
+      _arrays[name] = ArrayView(reinterpret_cast<const double*>(base + offset),
+				size);
+    }
+  }
+
+  ~BinaryFile() {
+    if (_map != MAP_FAILED) { munmap(_map, _length); }
+  }
+
+  BinaryFile(const BinaryFile&) = delete;
+  BinaryFile& operator=(const BinaryFile&) = delete;
+
+  bool has(const std::string& name) const { return _arrays.count(name) > 0; }
+
+  const ArrayView get(const std::string& name) const {
+    const auto it = _arrays.find(name);
+    if (it == _arrays.end()) { fail("missing array " + name); }
+    return it->second;
+  }
+
+  // Array of exactly n_steps values
+  const ArrayView get(const std::string& name, const std::size_t n_steps) const {
+    const ArrayView view = get(name);
+    if (view.size() != n_steps) {
+      fail("array " + name + " has " + std::to_string(view.size()) +
+	   " values, expected " + std::to_string(n_steps));
+    }
+    return view;
+  }
+};
+
+} // namespace util
+
+#endif
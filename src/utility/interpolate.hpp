@@ -1,9 +1,14 @@
 #ifndef _UTILITY_INTERPOLATE_HEADER_
 #define _UTILITY_INTERPOLATE_HEADER_
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <vector>
 
+#include "utility/series.hpp"
+#include "utility/simd.hpp"
+
 namespace util {
 
 inline const double interpolate(const std::vector<double> &x,
@@ -35,31 +40,143 @@ inline const double interpolate(const std::vector<double> &x,
    return ya + t * ( x_val - a );
 }
 
+// Linear interpolation of many series that share one x and one set of query
+// points. The intervals holding the queries are located once: with a cursor
+// carried from one query to the next, so sorted queries cost O(N + M), or by
+// direct index computation when x is evenly spaced. Every value is computed
+// with the same interval and arithmetic as the scalar interpolate.
+class Interpolation {
+private:
+  std::vector<std::size_t> _index; // lower point of the interval
+  std::vector<double>      _dx;    // x_new - x[i]
+  std::vector<double>      _h;     // x[i+1] - x[i]
+  bool                     _single_point;
+
+  // x is close enough to evenly spaced for the index guess to land within a
+  // point or two of the interval
+  template <typename X>
+  static bool isUniform(const X& x) {
+    const std::size_t size = x.size();
+    const double h = (x.back() - x.front()) / (size - 1);
+
+    if (!(h > 0.)) { return false; }
+
+    for (std::size_t i = 1; i < size; i++) {
+      if (std::abs(x[i] - x[i-1] - h) > 1e-6 * h) { return false; }
+    }
+
+    return true;
+  }
+
+public:
+  // Interpolation from the points x to x_new, given as vectors or series
+  template <typename X, typename XNew>
+  Interpolation(const X& x, const XNew& x_new)
+    : _index(x_new.size(), 0),
+      _dx(x_new.size(), 0.),
+      _h(x_new.size(), 1.),
+      _single_point(x.size() == 1) {
+    if (_single_point) { return; }
+
+    const std::size_t last = x.size() - 2;
+    const bool uniform = isUniform(x);
+    const double inv_h = (x.size() - 1) / (x.back() - x.front());
+
+    std::size_t i = 0;
+
+    for (std::size_t j = 0; j < x_new.size(); j++) {
+      const double x_val = x_new[j];
+
+      if (x_val >= x[last]) {
+	i = last;
+      }
+      else {
+	if (uniform) {
+	  const double guess = (x_val - x.front()) * inv_h;
+	  i = guess > 0. ? std::min(static_cast<std::size_t>(guess), last) : 0;
+	}
+
+	// the first interval whose upper point is not below x_val
+	while (i > 0 && x_val <= x[i]) { i--; }
+	while (i < last && x_val > x[i+1]) { i++; }
+      }
+
+      _index[j] = i;
+      _dx[j]    = x_val - x[i];
+      _h[j]     = x[i+1] - x[i];
+    }
+  }
+
+  const std::size_t size() const { return _index.size(); }
+
+  // Interpolated values of a series y given on x, written to the size()
+  // values at y_new, stride apart. Any indexable series works, e.g. a vector
+  // or a strided view into a time-major array.
+  template <typename Y>
+  void operator()(const Y& y, double* y_new,
+		  const std::size_t stride = 1) const {
+    if (_single_point) {
+      for (std::size_t j = 0; j < _index.size(); j++) { y_new[j * stride] = y[0]; }
+      return;
+    }
+
+    for (std::size_t j = 0; j < _index.size(); j++) {
+      const double ya = y[_index[j]], yb = y[_index[j] + 1];
+      const double t = ( yb - ya ) / _h[j];
+      y_new[j * stride] = ya + t * _dx[j];
+    }
+  }
+
+  template <typename Y>
+  std::vector<double> operator()(const Y& y) const {
+    std::vector<double> y_new(_index.size());
+    (*this)(y, y_new.data());
+    return y_new;
+  }
+
+  // Interpolated series, which stays a single value when y is constant
+  Series operator()(const Series& y) const {
+    if (y.isConstant()) { return Series::constant(y[0], _index.size()); }
+
+    std::vector<double> y_new(_index.size());
+    (*this)(y, y_new.data());
+    return Series(std::move(y_new));
+  }
+};
+
 inline const std::vector<double> interpolate(const std::vector<double> &x,
 					     const std::vector<double> &y,
 					     const std::vector<double> &x_new) {
-  std::vector<double> y_new;
+  return Interpolation(x, x_new)(y);
+}
 
-  for (const auto& x_val : x_new) {
-    y_new.push_back(interpolate(x,y,x_val));
-  }
+// Interpolate every series in ys, all given on x, onto x_new
+inline const std::vector<std::vector<double>>
+interpolate(const std::vector<double> &x,
+	    const std::vector<std::vector<double>> &ys,
+	    const std::vector<double> &x_new) {
+  const Interpolation interpolation(x, x_new);
 
-  return y_new;
+  std::vector<std::vector<double>> ys_new;
+  for (const auto& y : ys) { ys_new.push_back(interpolation(y)); }
+
+  return ys_new;
 }
 
+// Fill linspaced with n_steps evenly spaced values, reusing its storage
 template<typename T>
-std::vector<double> linspace(T start_in, T end_in, int n_steps) {
-  std::vector<double> linspaced;
+void linspace(T start_in, T end_in, int n_steps, std::vector<double>& linspaced) {
+  linspaced.clear();
 
   double start = static_cast<double>(start_in);
   double end = static_cast<double>(end_in);
   double num = static_cast<double>(n_steps);
 
-  if (num == 0) { return linspaced; }
+  if (num == 0) { return; }
   if (num == 1)
     {
       linspaced.push_back(start);
-      return linspaced;
+      return;
     }
 
   double delta = (end - start) / (num - 1);
@@ -69,25 +186,63 @@ std::vector<double> linspace(T start_in, T end_in, int n_steps) {
       linspaced.push_back(start + delta * i);
     }
   linspaced.push_back(end);
+}
 
+template<typename T>
+std::vector<double> linspace(T start_in, T end_in, int n_steps) {
+  std::vector<double> linspaced;
+  linspace(start_in, end_in, n_steps, linspaced);
   return linspaced;
-
 }
 
+  // Below this lambda * dt the closed forms of k1 and k2 lose most of their
+  // digits to cancellation, so k0, k1 and k2 are evaluated from their series
+  constexpr double small_lambda_dt = 0.5;
+
+  // 1 / m! for m = 0, ..., 18, every factorial being exact in double precision
+  constexpr double inv_factorial[19] = {
+    1., 1., 1. / 2., 1. / 6., 1. / 24., 1. / 120., 1. / 720., 1. / 5040.,
+    1. / 40320., 1. / 362880., 1. / 3628800., 1. / 39916800.,
+    1. / 479001600., 1. / 6227020800., 1. / 87178291200.,
+    1. / 1307674368000., 1. / 20922789888000., 1. / 355687428096000.,
+    1. / 6402373705728000.};
+
+  // k1(x) = sum_{m>=1} (-1)^(m+1) x^m / (m+1)!, truncated past double precision
+  // for x < small_lambda_dt
+  template <typename T>
+  inline T k1Series(const T x) {
+    T p = inv_factorial[17];
+    for (int m = 16; m >= 2; m--) { p = T(inv_factorial[m]) - x * p; }
+    return x * p;
+  }
+
+  // k2(x) = sum_{m>=1} (-1)^(m+1) 2 x^m / (m+2)!
+  template <typename T>
+  inline T k2Series(const T x) {
+    T p = 2. * inv_factorial[18];
+    for (int m = 17; m >= 3; m--) { p = T(2. * inv_factorial[m]) - x * p; }
+    return x * p;
+  }
+
   inline double E(const double lambda, const double delta_t) {
     return exp(-lambda * delta_t);
   }
 
   inline double k0(const double lambda, const double delta_t) {
-    return 1. - E(lambda, delta_t);
+    const double x = lambda * delta_t;
+    return x < small_lambda_dt ? x * (1. - k1Series(x)) : 1. - E(lambda, delta_t);
   }
 
   inline double k1(const double lambda, const double delta_t) {
-    return 1. - k0(lambda, delta_t) / (lambda * delta_t);
+    const double x = lambda * delta_t;
+    return x < small_lambda_dt ? k1Series(x) :
+      1. - k0(lambda, delta_t) / (lambda * delta_t);
   }
 
   inline double k2(const double lambda, const double delta_t) {
-    return 1. - 2. * k1(lambda, delta_t) / (lambda * delta_t);
+    const double x = lambda * delta_t;
+    return x < small_lambda_dt ? k2Series(x) :
+      1. - 2. * k1(lambda, delta_t) / (lambda * delta_t);
   }
 
   inline double omega0(const double lambda, const double delta_t) {
@@ -113,6 +268,79 @@ std::vector<double> linspace(T start_in, T end_in, int n_steps) {
     return (k2(lambda, delta_t) - k1(lambda, delta_t)) / ((1 + gamma) * gamma);
   }
 
+  // The root (-b - sqrt(b^2 - 4ac)) / (2a) of a x^2 + b x + c = 0 for a < 0,
+  // the power at the end of a step. With a * dt small the discriminant is
+  // within rounding of b^2, and for b < 0 the difference -b - sqrt(..)
+  // cancels to nothing; it is then evaluated as the equal 2c / (-b + sqrt(..)).
+  template <typename T>
+  inline T powerRoot(const T a, const T b, const T c) {
+    const T sqrt_disc = std::sqrt(b * b - 4 * a * c);
+    return b < 0 ? 2 * c / (-b + sqrt_disc) : (-b - sqrt_disc) / (2 * a);
+  }
+
+  // Output arrays of exponentialWeights, one entry per decay constant
+  struct ExponentialWeights {
+    double* E;
+    double* k0;
+    double* k1;
+    double* k2;
+    double* omega_n;
+    double* omega_n1;
+    double* omega_n2;
+  };
+
+  // Evaluate every exponential coefficient of n decay constants sharing one
+  // dt and gamma. The k-chain is computed once per constant, and full packs of
+  // constants go through the vector path when one is enabled in simd.hpp. The
+  // scalar loop reproduces the functions above exactly, but the vector path
+  // only to a few ulp, its exp being a polynomial, so coefficient tables of
+  // vector builds differ from the uncached coefficients by rounding.
+  inline void exponentialWeights(const double* lambda,
+				 const std::size_t n,
+				 const double delta_t,
+				 const double gamma,
+				 const ExponentialWeights& out) {
+    std::size_t i = 0;
+
+#ifdef UTIL_SIMD_ENABLED
+    using simd::Pack;
+
+    const Pack dt = delta_t, g = gamma, one = 1., small = small_lambda_dt;
+
+    for (; i + Pack::width <= n; i += Pack::width) {
+      const Pack x = simd::load(lambda + i) * dt;
+
+      const Pack E  = simd::exp(0. - x);
+      const Pack s1 = k1Series(x);
+      const Pack k0 = simd::selectLess(x, small, x * (one - s1), one - E);
+      const Pack k1 = simd::selectLess(x, small, s1, one - k0 / x);
+      const Pack k2 = simd::selectLess(x, small, k2Series(x),
+				       one - Pack(2.) * k1 / x);
+
+      simd::store(out.E + i, E);
+      simd::store(out.k0 + i, k0);
+      simd::store(out.k1 + i, k1);
+      simd::store(out.k2 + i, k2);
+      simd::store(out.omega_n + i, (k2 + g * k1) / (one + g));
+      simd::store(out.omega_n1 + i, k0 - (k2 + (g - one) * k1) / g);
+      simd::store(out.omega_n2 + i, (k2 - k1) / ((one + g) * g));
+    }
+#endif
+
+    for (; i < n; i++) {
+      const double k1_i = k1(lambda[i], delta_t);
+      const double k2_i = k2(lambda[i], delta_t);
+
+      out.E[i]        = E(lambda[i], delta_t);
+      out.k0[i]       = k0(lambda[i], delta_t);
+      out.k1[i]       = k1_i;
+      out.k2[i]       = k2_i;
+      out.omega_n[i]  = (k2_i + gamma * k1_i) / (1 + gamma);
+      out.omega_n1[i] = out.k0[i] - (k2_i + (gamma - 1) * k1_i) / gamma;
+      out.omega_n2[i] = (k2_i - k1_i) / ((1 + gamma) * gamma);
+    }
+  }
+
 } // namespace util
 
 #endif
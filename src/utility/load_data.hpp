@@ -1,45 +1,178 @@
 #ifndef _UTILITY_LOAD_DATA_HEADER_
 #define _UTILITY_LOAD_DATA_HEADER_
 
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "pugi/pugixml.hpp"
 #include "parareal/definitions.hpp"
+#include "utility/series.hpp"
 
 namespace util {
 
+// Arrays with at least this many values per thread are parsed in parallel
+constexpr std::size_t parallel_parse_size = 1 << 16;
+
+inline bool isSpace(const char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Number of whitespace separated tokens in [begin, end)
+inline std::size_t countTokens(const char* begin, const char* end) {
+  std::size_t count = 0;
+  bool in_token = false;
+
+  for (const char* c = begin; c != end; c++) {
+    const bool space = isSpace(*c);
+    count += !space && !in_token;
+    in_token = !space;
+  }
+
+  return count;
+}
+
+// Parse the tokens of [begin, end) into out, which has room for all of them
+inline void parseTokens(const char* begin, const char* end, double* out,
+			const std::string& context) {
+  const char* c = begin;
+
+  while (true) {
+    while (c != end && isSpace(*c)) { c++; }
+    if (c == end) { return; }
+
+    // from_chars does not take the leading plus sign streams accept
+    const char* token = c;
+    if (*c == '+') { c++; }
+
+    const auto result = std::from_chars(c, end, *out);
+    const char* token_end = result.ptr;
+
+    if (result.ec != std::errc() || (token_end != end && !isSpace(*token_end))) {
+      while (token_end != end && !isSpace(*token_end)) { token_end++; }
+      throw std::runtime_error("Invalid value '" + std::string(token, token_end) +
+			       "' in " + context);
+    }
+
+    c = token_end;
+    out++;
+  }
+}
+
+// Parse whitespace separated doubles. The tokens are counted first so the
+// result is allocated once, and long arrays are split at whitespace into
+// chunks that are parsed concurrently. n_threads = 0 picks the number of
+// hardware threads.
+inline std::vector<double> parseValues(const char* begin,
+				       const char* end,
+				       const std::string& context,
+				       std::size_t n_threads = 0) {
+  if (n_threads == 0) {
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  const std::size_t n_bytes = end - begin;
+  n_threads = std::max<std::size_t>(1, std::min(n_threads, n_bytes / parallel_parse_size));
+
+  // chunk boundaries, moved forward past the token they land in
+  std::vector<const char*> bounds(n_threads + 1, end);
+  bounds[0] = begin;
+
+  for (std::size_t t = 1; t < n_threads; t++) {
+    const char* c = std::max(bounds[t-1], begin + n_bytes * t / n_threads);
+    while (c != end && !isSpace(*c)) { c++; }
+    bounds[t] = c;
+  }
+
+  std::vector<std::size_t> offsets(n_threads + 1, 0);
+  for (std::size_t t = 0; t < n_threads; t++) {
+    offsets[t+1] = offsets[t] + countTokens(bounds[t], bounds[t+1]);
+  }
+
+  std::vector<double> result(offsets.back());
+
+  // errors of each chunk, rethrown once every thread has joined
+  std::vector<std::exception_ptr> errors(n_threads);
+
+  auto parse = [&](const std::size_t t) {
+    try {
+      parseTokens(bounds[t], bounds[t+1], result.data() + offsets[t], context);
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < n_threads; t++) { threads.emplace_back(parse, t); }
+  parse(0);
+  for (auto& thread : threads) { thread.join(); }
+
+  for (const auto& error : errors) {
+    if (error) { std::rethrow_exception(error); }
+  }
+
+  return result;
+}
+
+inline std::vector<double> parseValues(const pugi::xml_node& node) {
+  const char* text = node.text().get();
+  return parseValues(text, text + std::strlen(text),
+		     "<" + std::string(node.name()) + ">");
+}
+
+// Error for a node holding size values where n_steps are expected
+inline std::runtime_error sizeError(const pugi::xml_node& node,
+				    const std::size_t size,
+				    const para::timeIndex n_steps) {
+  return std::runtime_error("<" + std::string(node.name()) + "> has " +
+			    std::to_string(size) + " values but n_steps is " +
+			    std::to_string(n_steps));
+}
+
 inline const para::timeBins
 loadVectorData(const pugi::xml_node& node, const para::timeIndex n_steps) {
-  para::timeBins result;
-
   // check to see if parameter is constant in time
-  double value = node.attribute("value").as_double();
-
-  if (value) {
-    result = para::timeBins(n_steps, value);
-  } else {
-    result = para::timeBins(n_steps, 0.);
-    std::istringstream iss(node.text().get());
-    para::timeIndex n = 0;
-    for (double s; iss >> s;) {
-      result[n] = s;
-      n++;
-    }
+  if (node.attribute("value")) {
+    return para::timeBins(n_steps, node.attribute("value").as_double());
   }
 
+  para::timeBins result = parseValues(node);
+  if (result.size() != n_steps) { throw sizeError(node, result.size(), n_steps); }
+
   return result;
 }
 
+// Load the leading steps of a history, such as the precomputed steps of
+// initial conditions. The steps past the listed values are zero.
 inline const para::timeBins
-loadVectorData(const pugi::xml_node& node) {
-  para::timeBins result;
+loadHistoryData(const pugi::xml_node& node, const para::timeIndex n_steps) {
+  para::timeBins result = parseValues(node);
+  if (result.size() > n_steps) { throw sizeError(node, result.size(), n_steps); }
+  result.resize(n_steps, 0.);
 
-  std::istringstream iss(node.text().get());
-  for (double s; iss >> s;) {
-    result.push_back(s);
+  return result;
+}
+
+// Load a parameter series, kept as a single value when the node gives one or
+// its values are all equal, and as a grid when they are evenly spaced
+inline const Series
+loadSeriesData(const pugi::xml_node& node, const para::timeIndex n_steps) {
+  if (node.attribute("value")) {
+    return Series::constant(node.attribute("value").as_double(), n_steps);
   }
 
-  return result;
+  return Series::compact(loadVectorData(node, n_steps));
+}
+
+inline const para::timeBins
+loadVectorData(const pugi::xml_node& node) {
+  return parseValues(node);
 }
 
 inline const para::precBins<para::timeBins>
@@ -48,16 +181,7 @@ loadZetas(const pugi::xml_node& histories_node, const para::timeIndex n_steps) {
   para::precBins<para::timeBins> concentration_histories;
 
   for (auto history_node : histories_node.children()) {
-    para::timeBins concentration_history(n_steps, 0.);
-
-    para::timeIndex n = 0;
-    std::istringstream iss(history_node.text().get());
-    for (double s; iss >> s;) {
-      concentration_history[n] = s;
-      n++;
-    }
-
-    concentration_histories.push_back(concentration_history);
+    concentration_histories.push_back(loadHistoryData(history_node, n_steps));
   }
 
   return concentration_histories;
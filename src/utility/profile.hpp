@@ -0,0 +1,217 @@
+#ifndef _UTILITY_PROFILE_HEADER_
+#define _UTILITY_PROFILE_HEADER_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "utility/xml_writer.hpp"
+
+// Instrumentation of the solve phases. Build with `make profile=1` (which
+// defines UTIL_PROFILE) to record them; otherwise the macros below expand to
+// nothing and the hot paths carry no timing code. Names must be string
+// literals, since only their pointers are stored.
+#ifdef UTIL_PROFILE
+#define UTIL_PROFILE_JOIN_(a, b) a##b
+#define UTIL_PROFILE_JOIN(a, b) UTIL_PROFILE_JOIN_(a, b)
+#define UTIL_PROFILE_SCOPE(name) \
+  util::ScopedTimer UTIL_PROFILE_JOIN(util_profile_scope_, __LINE__)(name)
+#define UTIL_PROFILE_COUNT(name, value) \
+  util::Profiler::instance().count(name, value)
+#define UTIL_PROFILE_ITERATION(k) \
+  util::Profiler::instance().setIteration(k)
+#else
+#define UTIL_PROFILE_SCOPE(name) ((void)0)
+#define UTIL_PROFILE_COUNT(name, value) ((void)0)
+#define UTIL_PROFILE_ITERATION(k) ((void)0)
+#endif
+
+namespace util {
+
+// Collects timed phases and counters from every thread. Each thread appends
+// to its own buffer, so recording takes no lock; the buffers are read once
+// the threads are idle, when the report is written.
+class Profiler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  struct Event {
+    const char*  name;
+    int          iteration; // parareal iteration, or -1 outside of them
+    std::int64_t start;     // ns since the profiler was created
+    std::int64_t duration;  // ns, 0 for counters
+    double       value;     // counter increment, 0 for timed phases
+  };
+
+private:
+  struct Thread {
+    int                id;
+    std::vector<Event> events;
+  };
+
+  const clock::time_point              _origin = clock::now();
+  std::atomic<int>                     _iteration{-1};
+  std::mutex                           _mutex;
+  std::vector<std::unique_ptr<Thread>> _threads;
+
+  // Buffer of the calling thread, registered on first use. Threads are
+  // numbered in that order, so the thread solving the coarse sweep is 0.
+  Thread& local() {
+    thread_local Thread* thread = nullptr;
+
+    if (!thread) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _threads.push_back(std::make_unique<Thread>());
+      _threads.back()->id = _threads.size() - 1;
+      thread = _threads.back().get();
+    }
+
+    return *thread;
+  }
+
+  // Time, calls and counter totals of each phase
+  struct Total {
+    std::size_t  calls = 0;
+    std::int64_t time  = 0;
+    double       value = 0.;
+  };
+
+  template <typename Key>
+  using Totals = std::map<Key, Total>;
+
+  void add(Total& total, const Event& event) const {
+    total.calls++;
+    total.time  += event.duration;
+    total.value += event.value;
+  }
+
+  void attributes(XMLWriter& writer, const Total& total) const {
+    writer.attribute("calls", total.calls);
+    writer.attribute("time", total.time * 1e-9);
+    if (total.value != 0.) { writer.attribute("count", total.value); }
+  }
+
+  Profiler() = default;
+
+public:
+  static Profiler& instance() {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  std::int64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	     clock::now() - _origin).count();
+  }
+
+  void setIteration(const int k) { _iteration = k; }
+
+  void record(const char* name, const std::int64_t start, const std::int64_t stop) {
+    local().events.push_back({name, _iteration, start, stop - start, 0.});
+  }
+
+  void count(const char* name, const double value) {
+    local().events.push_back({name, _iteration, now(), 0, value});
+  }
+
+  // Totals of every phase, then per iteration and thread
+  void writeToXML(XMLWriter& writer) const {
+    Totals<std::string> totals;
+    Totals<std::tuple<std::string, int, int>> phases;
+
+    for (const auto& thread : _threads) {
+      for (const auto& event : thread->events) {
+	add(totals[event.name], event);
+	add(phases[{event.name, event.iteration, thread->id}], event);
+      }
+    }
+
+    writer.open("timing");
+    writer.attribute("n_threads", _threads.size());
+
+    for (const auto& total : totals) {
+      writer.open("total");
+      writer.attribute("name", total.first);
+      attributes(writer, total.second);
+      writer.close();
+    }
+
+    for (const auto& phase : phases) {
+      writer.open("phase");
+      writer.attribute("name", std::get<0>(phase.first));
+      writer.attribute("iteration", std::get<1>(phase.first));
+      writer.attribute("thread", std::get<2>(phase.first));
+      attributes(writer, phase.second);
+      writer.close();
+    }
+
+    writer.close();
+  }
+
+  // Complete events of the Chrome trace-event format, which chrome://tracing
+  // and Perfetto display as one track per thread
+  void writeChromeTrace(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+
+    if (!file) {
+      throw std::runtime_error("Could not open " + path + " for writing");
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    const char* separator = "\n";
+
+    for (const auto& thread : _threads) {
+      for (const auto& event : thread->events) {
+	if (event.duration > 0 || event.value == 0.) {
+	  std::fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, "
+		       "\"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, "
+		       "\"args\": {\"iteration\": %d}}",
+		       separator, event.name, thread->id, event.start * 1e-3,
+		       event.duration * 1e-3, event.iteration);
+	} else {
+	  std::fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 0, "
+		       "\"tid\": %d, \"ts\": %.3f, \"args\": {\"value\": %.17g}}",
+		       separator, event.name, thread->id, event.start * 1e-3,
+		       event.value);
+	}
+	separator = ",\n";
+      }
+    }
+
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+  }
+};
+
+// Records the time from its construction to the end of the scope
+class ScopedTimer {
+private:
+  const char*  _name;
+  std::int64_t _start;
+
+public:
+  ScopedTimer(const char* name)
+    : _name(name), _start(Profiler::instance().now()) {}
+
+  ~ScopedTimer() {
+    Profiler& profiler = Profiler::instance();
+    profiler.record(_name, _start, profiler.now());
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+} // namespace util
+
+#endif
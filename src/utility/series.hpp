@@ -0,0 +1,188 @@
+#ifndef _UTILITY_SERIES_HEADER_
+#define _UTILITY_SERIES_HEADER_
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Series of values indexed by time step, read like a vector but stored as a
+// single value when constant in time, as the end points of an evenly spaced
+// grid, or as the table of every value otherwise. Grid points are evaluated
+// exactly as linspace evaluates them.
+class Series {
+public:
+  enum class Kind { constant, uniform, tabulated };
+
+  // Random access iterator over the values, for the standard algorithms
+  class const_iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = double;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const double*;
+    using reference         = double;
+
+  private:
+    const Series*  _series;
+    difference_type _n;
+
+  public:
+    const_iterator(const Series* series, const difference_type n)
+      : _series(series), _n(n) {}
+
+    double operator*() const { return (*_series)[_n]; }
+    double operator[](const difference_type i) const { return (*_series)[_n + i]; }
+
+    const_iterator& operator++() { _n++; return *this; }
+    const_iterator& operator--() { _n--; return *this; }
+    const_iterator  operator++(int) { auto it = *this; _n++; return it; }
+    const_iterator  operator--(int) { auto it = *this; _n--; return it; }
+
+    const_iterator& operator+=(const difference_type i) { _n += i; return *this; }
+    const_iterator& operator-=(const difference_type i) { _n -= i; return *this; }
+
+    const_iterator operator+(const difference_type i) const {
+      return const_iterator(_series, _n + i);
+    }
+    const_iterator operator-(const difference_type i) const {
+      return const_iterator(_series, _n - i);
+    }
+    difference_type operator-(const const_iterator& other) const {
+      return _n - other._n;
+    }
+
+    bool operator==(const const_iterator& other) const { return _n == other._n; }
+    bool operator!=(const const_iterator& other) const { return _n != other._n; }
+    bool operator<(const const_iterator& other)  const { return _n < other._n; }
+    bool operator>(const const_iterator& other)  const { return _n > other._n; }
+    bool operator<=(const const_iterator& other) const { return _n <= other._n; }
+    bool operator>=(const const_iterator& other) const { return _n >= other._n; }
+  };
+
+private:
+  Kind        _kind;
+  std::size_t _size;
+
+  // the constant value, or the end points and spacing of the grid
+  double _start = 0.;
+  double _end   = 0.;
+  double _delta = 0.;
+
+  // grid index of the first value, nonzero for windows of a grid, and of the
+  // end point
+  std::size_t _n_first = 0;
+  std::size_t _n_last  = 0;
+
+  std::vector<double> _values;
+
+  Series(const Kind kind, const std::size_t size) : _kind(kind), _size(size) {}
+
+  const double point(const std::size_t n) const {
+    return n == _n_last ? _end : _start + _delta * n;
+  }
+
+public:
+  // Tabulated values
+  Series(std::vector<double> values = {})
+    : _kind(Kind::tabulated), _size(values.size()), _values(std::move(values)) {}
+
+  static Series constant(const double value, const std::size_t size) {
+    Series series(Kind::constant, size);
+    series._start = value;
+    return series;
+  }
+
+  // The size points of linspace(start, end, size)
+  static Series uniform(const double start, const double end,
+			const std::size_t size) {
+    if (size < 2) { return Series(std::vector<double>(size, start)); }
+
+    Series series(Kind::uniform, size);
+    series._start  = start;
+    series._end    = end;
+    series._delta  = (end - start) / (size - 1.);
+    series._n_last = size - 1;
+    return series;
+  }
+
+  // The most compact series holding exactly the given values
+  static Series compact(std::vector<double> values) {
+    const std::size_t size = values.size();
+    if (size == 0) { return Series(); }
+
+    bool constant = true;
+    for (std::size_t n = 1; n < size && constant; n++) {
+      constant = values[n] == values[0];
+    }
+    if (constant) { return Series::constant(values[0], size); }
+
+    Series grid = uniform(values.front(), values.back(), size);
+    for (std::size_t n = 0; n < size; n++) {
+      if (grid[n] != values[n]) { return Series(std::move(values)); }
+    }
+    return grid;
+  }
+
+  const Kind        getKind()     const { return _kind; }
+  const bool        isConstant()  const { return _kind == Kind::constant; }
+  const bool        isUniform()   const { return _kind == Kind::uniform; }
+  const std::size_t size()        const { return _size; }
+
+  // Spacing of a uniform grid, which the differences of its points only
+  // match up to rounding
+  const double getDelta() const { return _delta; }
+  const bool        empty()       const { return _size == 0; }
+
+  const double operator[](const std::size_t n) const {
+    switch (_kind) {
+    case Kind::constant: return _start;
+    case Kind::uniform:  return point(_n_first + n);
+    default:             return _values[n];
+    }
+  }
+
+  const double at(const std::size_t n) const {
+    if (n >= _size) { throw std::out_of_range("util::Series::at"); }
+    return (*this)[n];
+  }
+
+  const double front() const { return at(0); }
+  const double back()  const { return at(_size - 1); }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end()   const { return const_iterator(this, _size); }
+
+  // Values n_start to n_stop, keeping the representation
+  Series window(const std::size_t n_start, const std::size_t n_stop) const {
+    if (_kind == Kind::tabulated) {
+      return Series(std::vector<double>(_values.begin() + n_start,
+					_values.begin() + n_stop));
+    }
+
+    Series series = *this;
+    series._size     = n_stop - n_start;
+    series._n_first += n_start;
+    return series;
+  }
+
+  // Contiguous storage of the values read every stride() doubles, which a
+  // uniform grid does not have
+  const double* data() const {
+    return _kind == Kind::constant ? &_start :
+      _kind == Kind::tabulated ? _values.data() : nullptr;
+  }
+  const std::size_t stride() const { return _kind == Kind::constant ? 0 : 1; }
+
+  std::vector<double> toVector() const {
+    if (_kind == Kind::tabulated) { return _values; }
+    return std::vector<double>(begin(), end());
+  }
+};
+
+} // namespace util
+
+#endif
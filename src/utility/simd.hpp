@@ -0,0 +1,178 @@
+#ifndef _UTILITY_SIMD_HEADER_
+#define _UTILITY_SIMD_HEADER_
+
+#include <cstddef>
+#include <cstdint>
+
+// Select the widest double precision vector extension enabled by the compiler
+// flags (e.g. -mavx2 -mfma, -mavx512f or -march=native). Without one of them
+// the batched kernels fall back to their scalar loops.
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define UTIL_SIMD_AVX512 1
+#elif defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define UTIL_SIMD_AVX2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define UTIL_SIMD_NEON 1
+#endif
+
+#if defined(UTIL_SIMD_AVX512) || defined(UTIL_SIMD_AVX2) || defined(UTIL_SIMD_NEON)
+#define UTIL_SIMD_ENABLED 1
+#endif
+
+namespace util {
+namespace simd {
+
+#ifdef UTIL_SIMD_ENABLED
+
+// A pack of doubles processed by one instruction. Only the operations the
+// batched kernels need are provided.
+struct Pack {
+#if defined(UTIL_SIMD_AVX512)
+  using native = __m512d;
+  static constexpr std::size_t width = 8;
+#elif defined(UTIL_SIMD_AVX2)
+  using native = __m256d;
+  static constexpr std::size_t width = 4;
+#else
+  using native = float64x2_t;
+  static constexpr std::size_t width = 2;
+#endif
+
+  native v;
+
+  Pack(const native x) : v(x) {}
+
+  // broadcast a scalar to every lane
+  Pack(const double x)
+#if defined(UTIL_SIMD_AVX512)
+    : v(_mm512_set1_pd(x)) {}
+#elif defined(UTIL_SIMD_AVX2)
+    : v(_mm256_set1_pd(x)) {}
+#else
+    : v(vdupq_n_f64(x)) {}
+#endif
+};
+
+#if defined(UTIL_SIMD_AVX512)
+
+inline Pack load(const double* p) { return _mm512_loadu_pd(p); }
+inline void store(double* p, const Pack a) { _mm512_storeu_pd(p, a.v); }
+
+inline Pack operator+(const Pack a, const Pack b) { return _mm512_add_pd(a.v, b.v); }
+inline Pack operator-(const Pack a, const Pack b) { return _mm512_sub_pd(a.v, b.v); }
+inline Pack operator*(const Pack a, const Pack b) { return _mm512_mul_pd(a.v, b.v); }
+inline Pack operator/(const Pack a, const Pack b) { return _mm512_div_pd(a.v, b.v); }
+
+// a * b + c
+inline Pack fma(const Pack a, const Pack b, const Pack c) {
+  return _mm512_fmadd_pd(a.v, b.v, c.v);
+}
+
+inline Pack round(const Pack a) {
+  return _mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+// a < b ? x : y, lane by lane
+inline Pack selectLess(const Pack a, const Pack b, const Pack x, const Pack y) {
+  return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ), y.v, x.v);
+}
+
+// a * 2^k for integral k in the normal exponent range
+inline Pack scaleByPow2(const Pack a, const Pack k) {
+  const __m512i bits = _mm512_slli_epi64(
+    _mm512_castpd_si512(_mm512_add_pd(k.v, _mm512_set1_pd(0x1.8p52))), 52);
+  return _mm512_castsi512_pd(_mm512_add_epi64(_mm512_castpd_si512(a.v), bits));
+}
+
+#elif defined(UTIL_SIMD_AVX2)
+
+inline Pack load(const double* p) { return _mm256_loadu_pd(p); }
+inline void store(double* p, const Pack a) { _mm256_storeu_pd(p, a.v); }
+
+inline Pack operator+(const Pack a, const Pack b) { return _mm256_add_pd(a.v, b.v); }
+inline Pack operator-(const Pack a, const Pack b) { return _mm256_sub_pd(a.v, b.v); }
+inline Pack operator*(const Pack a, const Pack b) { return _mm256_mul_pd(a.v, b.v); }
+inline Pack operator/(const Pack a, const Pack b) { return _mm256_div_pd(a.v, b.v); }
+
+// a * b + c
+inline Pack fma(const Pack a, const Pack b, const Pack c) {
+  return _mm256_fmadd_pd(a.v, b.v, c.v);
+}
+
+inline Pack round(const Pack a) {
+  return _mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+// a < b ? x : y, lane by lane
+inline Pack selectLess(const Pack a, const Pack b, const Pack x, const Pack y) {
+  return _mm256_blendv_pd(y.v, x.v, _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ));
+}
+
+// a * 2^k for integral k in the normal exponent range
+inline Pack scaleByPow2(const Pack a, const Pack k) {
+  const __m256i bits = _mm256_slli_epi64(
+    _mm256_castpd_si256(_mm256_add_pd(k.v, _mm256_set1_pd(0x1.8p52))), 52);
+  return _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(a.v), bits));
+}
+
+#else
+
+inline Pack load(const double* p) { return vld1q_f64(p); }
+inline void store(double* p, const Pack a) { vst1q_f64(p, a.v); }
+
+inline Pack operator+(const Pack a, const Pack b) { return vaddq_f64(a.v, b.v); }
+inline Pack operator-(const Pack a, const Pack b) { return vsubq_f64(a.v, b.v); }
+inline Pack operator*(const Pack a, const Pack b) { return vmulq_f64(a.v, b.v); }
+inline Pack operator/(const Pack a, const Pack b) { return vdivq_f64(a.v, b.v); }
+
+// a * b + c
+inline Pack fma(const Pack a, const Pack b, const Pack c) {
+  return vfmaq_f64(c.v, a.v, b.v);
+}
+
+inline Pack round(const Pack a) { return vrndnq_f64(a.v); }
+
+// a < b ? x : y, lane by lane
+inline Pack selectLess(const Pack a, const Pack b, const Pack x, const Pack y) {
+  return vbslq_f64(vcltq_f64(a.v, b.v), x.v, y.v);
+}
+
+// a * 2^k for integral k in the normal exponent range
+inline Pack scaleByPow2(const Pack a, const Pack k) {
+  const int64x2_t bits = vshlq_n_s64(vcvtq_s64_f64(k.v), 52);
+  return vreinterpretq_f64_s64(vaddq_s64(vreinterpretq_s64_f64(a.v), bits));
+}
+
+#endif
+
+// exp(x) by reduction to x = k ln2 + r with |r| <= ln2 / 2 and a degree 13
+// Taylor polynomial in r, accurate to a few ulp. Arguments are clamped to
+// [-700, 700] so the result stays a normal number.
+inline Pack exp(const Pack x_in) {
+  const Pack x = selectLess(x_in, -700., -700., selectLess(700., x_in, 700., x_in));
+
+  const Pack k = round(x * 0x1.71547652b82fep0); // x / ln2
+  Pack r = fma(k, -0x1.62e42fee00000p-1, x);     // high bits of ln2, exact
+  r = fma(k, -0x1.a39ef35793c76p-33, r);          // low bits of ln2
+
+  // Horner evaluation of sum_m r^m / m!
+  constexpr double inv_factorial[14] = {
+    1., 1., 1. / 2, 1. / 6, 1. / 24, 1. / 120, 1. / 720, 1. / 5040,
+    1. / 40320, 1. / 362880, 1. / 3628800, 1. / 39916800, 1. / 479001600,
+    1. / 6227020800.};
+
+  Pack p = inv_factorial[13];
+  for (int m = 12; m >= 0; m--) { p = fma(p, r, inv_factorial[m]); }
+
+  return scaleByPow2(p, k);
+}
+
+#endif // UTIL_SIMD_ENABLED
+
+} // namespace simd
+} // namespace util
+
+#endif
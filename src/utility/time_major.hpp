@@ -0,0 +1,71 @@
+#ifndef _UTILITY_TIME_MAJOR_HEADER_
+#define _UTILITY_TIME_MAJOR_HEADER_
+
+#include <cstddef>
+#include <vector>
+
+namespace util {
+
+// Read-only view of one group's history inside a time-major array, where all
+// groups of a time step are adjacent: data[n * stride + k]
+class StridedView {
+private:
+  const double* _data;
+  std::size_t   _stride;
+  std::size_t   _size;
+
+public:
+  StridedView(const double* data, const std::size_t stride,
+	      const std::size_t size)
+    : _data(data), _stride(stride), _size(size) {}
+
+  const std::size_t size() const { return _size; }
+
+  const double operator[](const std::size_t n) const {
+    return _data[n * _stride];
+  }
+
+  // Copy the viewed history into a contiguous vector
+  std::vector<double> toVector() const {
+    std::vector<double> result(_size);
+    for (std::size_t n = 0; n < _size; n++) { result[n] = (*this)[n]; }
+    return result;
+  }
+};
+
+// Pack per-group histories of equal length into one time-major array
+inline std::vector<double>
+packTimeMajor(const std::vector<std::vector<double>>& histories) {
+  const std::size_t n_groups = histories.size();
+  const std::size_t n_steps  = n_groups > 0 ? histories.front().size() : 0;
+
+  std::vector<double> result(n_steps * n_groups);
+
+  for (std::size_t k = 0; k < n_groups; k++) {
+    for (std::size_t n = 0; n < n_steps; n++) {
+      result[n * n_groups + k] = histories[k].at(n);
+    }
+  }
+
+  return result;
+}
+
+// Unpack a time-major array of n_groups groups into per-group histories
+inline std::vector<std::vector<double>>
+unpackTimeMajor(const std::vector<double>& packed, const std::size_t n_groups) {
+  const std::size_t n_steps = n_groups > 0 ? packed.size() / n_groups : 0;
+
+  std::vector<std::vector<double>> result(n_groups, std::vector<double>(n_steps));
+
+  for (std::size_t n = 0; n < n_steps; n++) {
+    for (std::size_t k = 0; k < n_groups; k++) {
+      result[k][n] = packed[n * n_groups + k];
+    }
+  }
+
+  return result;
+}
+
+} // namespace util
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef _UTILITY_XML_WRITER_HEADER_
+#define _UTILITY_XML_WRITER_HEADER_
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "utility/series.hpp"
+
+namespace util {
+
+// Writes an xml document to a file as it is produced instead of building a
+// tree first. Elements are opened and closed in document order; attributes
+// must follow the open() of their element. Numbers are formatted with
+// std::to_chars, which gives the shortest text that reads back to the same
+// double. Output goes through a fixed-size buffer, so memory use does not
+// grow with the size of the document. finish() ends the document and reports
+// any write that failed; a writer destroyed without it, as when a write has
+// thrown, finishes what it can without throwing.
+class XMLWriter {
+private:
+  struct Element {
+    std::string name;
+    bool        has_children;
+  };
+
+  static constexpr std::size_t buffer_size = 1 << 16;
+
+  std::string          _path;
+  std::FILE*           _file;
+  std::vector<char>    _buffer;
+  std::size_t          _used = 0;
+  std::vector<Element> _elements;
+  bool                 _tag_open = false; // the start tag still takes attributes
+
+  void flush() {
+    if (_used > 0 && std::fwrite(_buffer.data(), 1, _used, _file) != _used) {
+      throw std::runtime_error("Failed to write " + _path);
+    }
+    _used = 0;
+  }
+
+  void put(const char* data, const std::size_t n) {
+    if (_used + n > _buffer.size()) { flush(); }
+    if (n > _buffer.size()) {
+      if (std::fwrite(data, 1, n, _file) != n) {
+	throw std::runtime_error("Failed to write " + _path);
+      }
+      return;
+    }
+    std::copy(data, data + n, _buffer.data() + _used);
+    _used += n;
+  }
+
+  void put(const std::string& s) { put(s.data(), s.size()); }
+  void put(const char c) { put(&c, 1); }
+
+  // xml escapes of text and attribute values
+  void putEscaped(const std::string& s) {
+    for (const char c : s) {
+      switch (c) {
+      case '&':  put("&amp;", 5);  break;
+      case '<':  put("&lt;", 4);   break;
+      case '>':  put("&gt;", 4);   break;
+      case '"':  put("&quot;", 6); break;
+      default:   put(c);
+      }
+    }
+  }
+
+  template <typename T>
+  void putNumber(const T value) {
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    put(text, result.ptr - text);
+  }
+
+  void indent(const std::size_t depth) {
+    put('\n');
+    for (std::size_t i = 0; i < depth; i++) { put('\t'); }
+  }
+
+  // end the start tag before any content of the element
+  void closeTag() {
+    if (_tag_open) { put('>'); _tag_open = false; }
+  }
+
+public:
+  XMLWriter(const std::string& path)
+    : _path(path), _file(std::fopen(path.c_str(), "wb")), _buffer(buffer_size) {
+    if (!_file) {
+      throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    put("<?xml version=\"1.0\"?>");
+  }
+
+  ~XMLWriter() {
+    if (!_file) { return; }
+
+    try {
+      finish();
+    } catch (...) {
+      if (_file) { std::fclose(_file); }
+    }
+  }
+
+  XMLWriter(const XMLWriter&) = delete;
+  XMLWriter& operator=(const XMLWriter&) = delete;
+
+  void open(const std::string& name) {
+    closeTag();
+    if (!_elements.empty()) { _elements.back().has_children = true; }
+
+    indent(_elements.size());
+    put('<');
+    put(name);
+
+    _elements.push_back({name, false});
+    _tag_open = true;
+  }
+
+  void attribute(const std::string& name, const std::string& value) {
+    put(' ');
+    put(name);
+    put("=\"", 2);
+    putEscaped(value);
+    put('"');
+  }
+
+  void attribute(const std::string& name, const char* value) {
+    attribute(name, std::string(value));
+  }
+
+  template <typename T,
+	    typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+  void attribute(const std::string& name, const T value) {
+    put(' ');
+    put(name);
+    put("=\"", 2);
+    putNumber(value);
+    put('"');
+  }
+
+  void text(const std::string& value) {
+    closeTag();
+    putEscaped(value);
+  }
+
+  // Space separated values read every stride doubles from data
+  void values(const double* data,
+	      const std::size_t size,
+	      const std::size_t stride = 1) {
+    closeTag();
+    for (std::size_t i = 0; i < size; i++) {
+      if (i > 0) { put(' '); }
+      putNumber(data[i * stride]);
+    }
+  }
+
+  void values(const std::vector<double>& data) {
+    values(data.data(), data.size());
+  }
+
+  // Values of a series, which a uniform grid evaluates point by point
+  void values(const Series& series) {
+    if (series.data()) {
+      values(series.data(), series.size(), series.stride());
+      return;
+    }
+
+    closeTag();
+    for (std::size_t i = 0; i < series.size(); i++) {
+      if (i > 0) { put(' '); }
+      putNumber(series[i]);
+    }
+  }
+
+  // Element holding only an array of values
+  void element(const std::string& name,
+	       const double* data,
+	       const std::size_t size,
+	       const std::size_t stride = 1) {
+    open(name);
+    values(data, size, stride);
+    close();
+  }
+
+  void element(const std::string& name, const std::vector<double>& data) {
+    element(name, data.data(), data.size());
+  }
+
+  void element(const std::string& name, const Series& series) {
+    open(name);
+    values(series);
+    close();
+  }
+
+  // Close the open elements and the file, throwing if any of the document
+  // did not reach it
+  void finish() {
+    while (!_elements.empty()) { close(); }
+    put('\n');
+    flush();
+
+    std::FILE* file = _file;
+    _file = nullptr;
+    if (std::fclose(file) != 0) {
+      throw std::runtime_error("Failed to write " + _path);
+    }
+  }
+
+  void close() {
+    const Element element = _elements.back();
+    _elements.pop_back();
+
+    if (_tag_open) {
+      put(" />", 3);
+      _tag_open = false;
+      return;
+    }
+
+    if (element.has_children) { indent(_elements.size()); }
+    put("</", 2);
+    put(element.name);
+    put('>');
+  }
+};
+
+} // namespace util
+
+#endif
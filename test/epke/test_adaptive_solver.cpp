@@ -0,0 +1,100 @@
+#include <cmath>
+
+#include "../catch.hpp"
+#include "parareal/definitions.hpp"
+#include "epke/adaptive_solver.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+TEST_CASE("Test the adaptive time step solver.", "[AdaptiveSolver]") {
+  using namespace para;
+
+  // a reactivity ramp over the first 0.1 s held until the end
+  timeBins time    = {0.0, 0.1, 0.5, 1.0};
+  timeBins rho_imp = {0.0, 0.003, 0.003, 0.003};
+
+  const timeBins lambdas = {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01};
+  const timeBins betas   = {0.00021, 0.00141, 0.00127, 0.00255, 0.00074, 0.00027};
+
+  auto makeParams = [&](const timeBins& rho) {
+    precBins<epke::Precursor::ptr> precursors;
+    for (precIndex k = 0; k < lambdas.size(); k++) {
+      precursors.push_back(std::make_shared<epke::Precursor>(
+	timeBins(time.size(), lambdas[k]), timeBins(time.size(), betas[k])));
+    }
+
+    return std::make_shared<epke::EPKEParameters>(time, precursors, rho,
+						  timeBins(time.size(), 1e-5),
+						  timeBins(time.size(), 1.0),
+						  timeBins(time.size(), 0.0065),
+						  timeBins(time.size(), 0.5),
+						  0.5, -0.001, 1.0);
+  };
+
+  // steady initial conditions on the grid of the parameters
+  auto makeInitial = [&](const timeIndex n_steps, const timeBins& grid) {
+    precBins<timeBins> concentrations;
+    for (precIndex k = 0; k < lambdas.size(); k++) {
+      concentrations.push_back(timeBins(n_steps, betas[k] / lambdas[k]));
+    }
+
+    return std::make_shared<epke::EPKEOutput>(1, n_steps, grid,
+					      concentrations,
+					      timeBins(n_steps, 1.0),
+					      timeBins(n_steps, 1.0),
+					      timeBins(n_steps, 0.0));
+  };
+
+  // reference on a uniform grid of 1e-4 s
+  const timeIndex n_fine = 10001;
+  const timeBins fine_time = util::linspace(0., 1., n_fine);
+
+  auto solveFine = [&](epke::EPKEParameters::ptr params) {
+    auto fine_output = makeInitial(n_fine, fine_time);
+    epke::Solver fine_solver(para::interpolate(params, fine_time), fine_output);
+    fine_solver.solve();
+    return fine_output;
+  };
+
+  SECTION("Steps grow through a slowly varying transient") {
+    auto params = makeParams(timeBins(time.size(), 0.0));
+    auto fine_output = solveFine(params);
+
+    epke::AdaptiveSolver::Tolerances tolerances;
+    tolerances.dt_initial = 1e-3;
+
+    epke::AdaptiveSolver solver(params, makeInitial(time.size(), time),
+				tolerances, "");
+    solver.solve();
+
+    auto output = solver.getOutput();
+    const timeIndex n_last = output->getNumTimeSteps() - 1;
+
+    REQUIRE(solver.getNumTimeSteps() < 40);
+    REQUIRE(output->getTime(n_last) == time.back());
+    REQUIRE(output->getPower(n_last) ==
+	    Approx(fine_output->getPower(n_fine - 1)).epsilon(1e-3));
+  }
+
+  SECTION("A reactivity ramp matches a fine uniform solve") {
+    auto params = makeParams(rho_imp);
+    auto fine_output = solveFine(params);
+
+    epke::AdaptiveSolver::Tolerances tolerances;
+    tolerances.rtol = 1e-5;
+
+    epke::AdaptiveSolver solver(params, makeInitial(time.size(), time),
+				tolerances, "");
+    solver.solve();
+
+    // the requested times are interpolated from the adaptive grid
+    auto output = solver.getOutput(time);
+
+    REQUIRE(output->getNumTimeSteps() == time.size());
+    REQUIRE(solver.getNumTimeSteps() < n_fine / 10);
+    REQUIRE(output->getPower(time.size() - 1) ==
+	    Approx(fine_output->getPower(n_fine - 1)).epsilon(1e-4));
+  }
+}
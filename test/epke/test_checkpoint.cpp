@@ -0,0 +1,83 @@
+#include <cstdio>
+
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "epke/checkpoint.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+// A reactivity ramp on one group, scaled by factor from step n_change onward
+static epke::EPKEParameters::ptr makeScaledRamp(const timeIndex n_steps,
+						const timeIndex n_change = 0,
+						const double factor = 1.) {
+  const timeBins time = util::linspace(0., 1., n_steps);
+
+  timeBins rho(n_steps);
+  for (timeIndex n = 0; n < n_steps; n++) {
+    rho[n] = 0.2 * 0.0065 * time[n] * (n >= n_change ? factor : 1.);
+  }
+
+  return makeOneGroup(time, rho, timeBins(n_steps, 0.08));
+}
+
+static epke::EPKEOutput::ptr solve(epke::EPKEParameters::ptr params,
+				   epke::EPKEOutput::ptr solution) {
+  epke::Solver solver(params, solution);
+  solver.solve();
+  return solution;
+}
+
+TEST_CASE("Test checkpoints and restarts.", "[Checkpoint]") {
+  const timeIndex   n_steps = 101;
+  const std::string path    = "test_checkpoint.bin";
+
+  auto params = makeScaledRamp(n_steps);
+  epke::Checkpoint::write(path, *params, *solve(params, makeSteady(*params)), 10);
+
+  const epke::Checkpoint checkpoint(path);
+  REQUIRE( checkpoint.getSteps().size() == 10 );
+  REQUIRE( checkpoint.getSteps().front() == 10 );
+
+  SECTION("Unchanged inputs resume at the last checkpoint") {
+    REQUIRE( checkpoint.findFirstChange(*params, *makeSteady(*params)) == n_steps );
+  }
+
+  SECTION("Other initial conditions change every step") {
+    REQUIRE( checkpoint.findFirstChange(*params, *makeSteady(*params, 2.)) == 0 );
+    REQUIRE( !checkpoint.createRestart(*params, *makeSteady(*params), 0) );
+  }
+
+  SECTION("A restart reproduces the full solve from the change onward") {
+    auto changed = makeScaledRamp(n_steps, 57, 1.5);
+    auto initial = makeSteady(*params);
+
+    const timeIndex n_change = checkpoint.findFirstChange(*changed, *initial);
+    REQUIRE( n_change == 57 );
+
+    auto restart = checkpoint.createRestart(*changed, *initial, n_change);
+    REQUIRE( restart );
+    REQUIRE( restart->getStartTimeIndex() == 50 );
+
+    auto full = solve(changed, makeSteady(*params));
+    solve(changed, restart);
+
+    for (timeIndex n = restart->getTimeOffset(); n < n_steps; n++) {
+      REQUIRE( restart->getPower(n) == full->getPower(n) );
+      REQUIRE( restart->getConcentration(0, n) == full->getConcentration(0, n) );
+    }
+
+    // the checkpoints before the restart carry over from the previous file
+    epke::Checkpoint::write(path, *changed, *restart, 10, &checkpoint);
+    const epke::Checkpoint updated(path);
+    REQUIRE( updated.getSteps() == checkpoint.getSteps() );
+    REQUIRE( updated.findFirstChange(*changed, *initial) == n_steps );
+  }
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,156 @@
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "epke/coefficients.hpp"
+#include "epke/parameters.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+TEST_CASE("Test exponential coefficient tables.", "[Coefficients]") {
+  using namespace para;
+
+  timeBins lambda_k   = {0.2, 0.2, 0.2, 0.2, 0.2};
+  timeBins beta_eff_k = {0.1, 0.1, 0.1, 0.1, 0.1};
+  precBins<epke::Precursor::ptr> precursors =
+    {std::make_shared<epke::Precursor>(lambda_k, beta_eff_k)};
+  timeBins rho_imp    = {0.0, 1.0, 2.0, 1.0, 0.0};
+  timeBins gen_time   = {1.0, 1.0, 1.0, 1.0, 1.0};
+  timeBins pow_norm   = {1.0, 1.0, 1.0, 1.0, 1.0};
+  timeBins beta_eff   = {0.1, 0.1, 0.1, 0.1, 0.1};
+  timeBins lambda_h   = {2.0, 2.0, 2.0, 2.0, 2.0};
+
+  SECTION("Uniform grid and constant lambdas collapse", "[Coefficients]") {
+    timeBins time = {0.0, 0.5, 1.0, 1.5, 2.0};
+
+    epke::EPKEParameters params(time, precursors, rho_imp, gen_time,
+				pow_norm, beta_eff, lambda_h, 0.5, 0.0, 1.0);
+    epke::Coefficients coefficients(params);
+
+    REQUIRE(coefficients.isCollapsed());
+    REQUIRE(coefficients.getNumChannels() == 2);
+
+    for (timeIndex n = 0; n < time.size(); n++) {
+      const auto& entry = coefficients.get(0, n);
+      REQUIRE(entry.E == util::E(0.2, 0.5));
+      REQUIRE(entry.omega_n == util::omegaN(0.2, 0.5, 1.0));
+
+      const auto& heat = coefficients.get(coefficients.getHeatChannel(), n);
+      REQUIRE(heat.k0 == util::k0(2.0, 0.5));
+      REQUIRE(heat.omega_n2 == util::omegaN2(2.0, 0.5, 1.0));
+    }
+  }
+
+  SECTION("Linspace grids collapse on their spacing", "[Coefficients]") {
+    const timeIndex n_steps = 101;
+    const timeBins  time    = util::linspace(0., 0.7, n_steps);
+
+    // the differences of the points are not all the same
+    bool rounded = false;
+    for (timeIndex n = 2; n < n_steps; n++) {
+      rounded = rounded || time[n] - time[n-1] != time[1] - time[0];
+    }
+    REQUIRE(rounded);
+
+    epke::EPKEParameters params(util::Series::compact(time),
+				precBins<epke::Precursor::ptr>(
+				  {std::make_shared<epke::Precursor>(
+				      util::Series::constant(0.2, n_steps),
+				      util::Series::constant(0.1, n_steps))}),
+				util::Series::constant(0.0, n_steps),
+				util::Series::constant(1.0, n_steps),
+				util::Series::constant(1.0, n_steps),
+				util::Series::constant(0.1, n_steps),
+				util::Series::constant(2.0, n_steps),
+				0.5, 0.0, 1.0);
+    epke::Coefficients coefficients(params);
+
+    REQUIRE(params.getTime().isUniform());
+    REQUIRE(coefficients.isCollapsed());
+    REQUIRE(coefficients.get(0, n_steps - 1).E == util::E(0.2, 0.7 / (n_steps - 1)));
+
+    // and so do windows of them
+    auto window = para::interpolateWindow(std::make_shared<epke::EPKEParameters>(params),
+					  0., 0.7, 4 * (n_steps - 1) + 1, 37, 81);
+    REQUIRE(epke::Coefficients(*window).isCollapsed());
+  }
+
+  SECTION("Nonuniform grid is tabulated per step", "[Coefficients]") {
+    timeBins time = {0.0, 0.5, 1.0, 2.0, 4.0};
+
+    epke::EPKEParameters params(time, precursors, rho_imp, gen_time,
+				pow_norm, beta_eff, lambda_h, 0.5, 0.0, 1.0);
+    epke::Coefficients coefficients(params);
+
+    REQUIRE(!coefficients.isCollapsed());
+
+    for (timeIndex n = 0; n < time.size(); n++) {
+      const double dt    = params.computeDT(n);
+      const double gamma = params.computeGamma(n);
+      const auto& entry  = coefficients.get(0, n);
+
+      REQUIRE(entry.E == util::E(0.2, dt));
+      REQUIRE(entry.omega_n == util::omegaN(0.2, dt, gamma));
+      REQUIRE(entry.omega_n1 == util::omegaN1(0.2, dt, gamma));
+      REQUIRE(entry.omega_n2 == util::omegaN2(0.2, dt, gamma));
+    }
+  }
+
+  // Eight groups and the heat channel fill a vector pack of every width in
+  // simd.hpp, whose exp only agrees with the scalar one to rounding
+  SECTION("Vector tables agree with the uncached coefficients", "[Coefficients]") {
+    const timeBins  time    = {0.0, 0.1, 0.3, 0.4, 0.7, 1.2, 1.3, 2.0};
+    const timeIndex n_steps = time.size();
+
+    precBins<epke::Precursor::ptr> groups;
+    for (precIndex k = 0; k < 8; k++) {
+      timeBins lambda(n_steps);
+      for (timeIndex n = 0; n < n_steps; n++) {
+	lambda[n] = 0.0124 * (k + 1) * (k + 1) * (1. + 0.01 * n);
+      }
+      groups.push_back(std::make_shared<epke::Precursor>(
+	lambda, timeBins(n_steps, 0.0065 / 8)));
+    }
+
+    timeBins rho(n_steps, 0.3 * 0.0065);
+    rho[0] = 0.;
+    auto cached = std::make_shared<epke::EPKEParameters>(
+      time, groups, rho, timeBins(n_steps, 1e-5), timeBins(n_steps, 1.0),
+      timeBins(n_steps, 0.0065), timeBins(n_steps, 0.5), 0.5, -0.001, 1.0);
+    auto uncached = std::make_shared<epke::EPKEParameters>(*cached);
+    cached->buildCoefficients();
+
+    const epke::Coefficients& coefficients = cached->getCoefficients();
+    REQUIRE(!coefficients.isCollapsed());
+    REQUIRE(coefficients.getNumChannels() == 9);
+
+    for (timeIndex n = coefficients.getFirstStep(); n < n_steps; n++) {
+      const double dt    = cached->computeDT(n);
+      const double gamma = cached->computeGamma(n);
+
+      for (precIndex c = 0; c < 9; c++) {
+	const double lambda = c < 8 ? cached->getDecayConstant(c, n) :
+	  cached->getLambdaH(n);
+	const auto&  entry  = coefficients.get(c, n);
+	const auto   exact  = epke::Coefficients::compute(lambda, dt, gamma);
+
+	REQUIRE(entry.E == Approx(exact.E).epsilon(1e-14));
+	REQUIRE(entry.k0 == Approx(exact.k0).epsilon(1e-14));
+	REQUIRE(entry.omega_n == Approx(exact.omega_n).epsilon(1e-14));
+	REQUIRE(entry.omega_n1 == Approx(exact.omega_n1).epsilon(1e-14));
+	REQUIRE(entry.omega_n2 == Approx(exact.omega_n2).epsilon(1e-14));
+      }
+    }
+
+    auto cached_output   = fixtures::makeSteady(*cached);
+    auto uncached_output = fixtures::makeSteady(*uncached);
+    epke::Solver(cached, cached_output).solve();
+    epke::Solver(uncached, uncached_output).solve();
+
+    for (timeIndex n = 0; n < n_steps; n++) {
+      REQUIRE(cached_output->getPower(n) ==
+	      Approx(uncached_output->getPower(n)).epsilon(1e-12));
+      REQUIRE(cached_output->getRho(n) ==
+	      Approx(uncached_output->getRho(n)).epsilon(1e-12));
+    }
+  }
+}
@@ -0,0 +1,87 @@
+#include "../catch.hpp"
+#include "parareal/definitions.hpp"
+#include "epke/ensemble.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+
+TEST_CASE("Test ensemble of perturbed scenarios.", "[Ensemble]") {
+  using namespace para;
+
+  timeBins time     = {0.0, 0.1, 0.2, 0.4, 0.8, 1.0};
+  timeBins rho_imp  = {0.0, 0.001, 0.002, 0.002, 0.001, 0.0};
+  timeBins gen_time = {1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5};
+  timeBins pow_norm = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+  timeBins beta_eff = {0.0065, 0.0065, 0.0065, 0.0065, 0.0065, 0.0065};
+  timeBins lambda_h = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5};
+  const double gamma_d = -0.01;
+
+  const timeBins lambdas = {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01};
+  const timeBins betas   = {0.00021, 0.00141, 0.00127, 0.00255, 0.00074, 0.00027};
+
+  precBins<epke::Precursor::ptr> precursors;
+  precBins<timeBins> concentrations;
+
+  for (precIndex k = 0; k < lambdas.size(); k++) {
+    precursors.push_back(std::make_shared<epke::Precursor>(
+      timeBins(time.size(), lambdas[k]), timeBins(time.size(), betas[k])));
+    concentrations.push_back(timeBins(time.size(), betas[k] / lambdas[k]));
+  }
+
+  auto initial = [&]() {
+    return std::make_shared<epke::EPKEOutput>(1, time.size(), time,
+					      concentrations,
+					      timeBins(time.size(), 1.0),
+					      pow_norm,
+					      timeBins(time.size(), 0.0));
+  };
+
+  // scalar solution of the base parameters with a scaled rho_imp and gamma_d
+  auto solveScalar = [&](const double rho_scale, const double gamma_scale) {
+    timeBins scaled_rho_imp(rho_imp);
+    for (auto& rho : scaled_rho_imp) { rho = rho_scale * rho; }
+
+    auto params = std::make_shared<epke::EPKEParameters>(time, precursors,
+							 scaled_rho_imp,
+							 gen_time, pow_norm,
+							 beta_eff, lambda_h, 0.5,
+							 gamma_scale * gamma_d,
+							 1.0);
+    auto output = initial();
+    epke::Solver(params, output).solve();
+    return output;
+  };
+
+  auto params = std::make_shared<epke::EPKEParameters>(time, precursors, rho_imp,
+						       gen_time, pow_norm,
+						       beta_eff, lambda_h,
+						       0.5, gamma_d, 1.0);
+
+  std::vector<epke::Ensemble::Perturbation> perturbations(3);
+  perturbations[1].rho_imp = 1.5;
+  perturbations[2].gamma_d = 0.5;
+
+  epke::Ensemble ensemble(params, initial(), perturbations, "");
+  ensemble.solve();
+
+  const auto outputs = ensemble.getOutputs();
+  REQUIRE(outputs.size() == 3);
+
+  const std::vector<epke::EPKEOutput::ptr> references =
+    {solveScalar(1.0, 1.0), solveScalar(1.5, 1.0), solveScalar(1.0, 0.5)};
+
+  // every scenario matches the scalar solver on its scaled parameters
+  for (std::size_t s = 0; s < outputs.size(); s++) {
+    for (timeIndex n = 0; n < time.size(); n++) {
+      REQUIRE(outputs[s]->getPower(n) == Approx(references[s]->getPower(n)).epsilon(1e-12));
+      REQUIRE(outputs[s]->getRho(n) == Approx(references[s]->getRho(n)).epsilon(1e-12));
+
+      for (precIndex k = 0; k < lambdas.size(); k++) {
+	REQUIRE(outputs[s]->getConcentration(k,n) ==
+		Approx(references[s]->getConcentration(k,n)).epsilon(1e-12));
+      }
+    }
+  }
+
+  REQUIRE(outputs[1]->getPower(3) != outputs[0]->getPower(3));
+}
@@ -0,0 +1,62 @@
+#include "../catch.hpp"
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+
+TEST_CASE("Test solver specialized on the group count.", "[FixedSolver]") {
+  using namespace para;
+
+  timeBins time     = {0.0, 0.1, 0.2, 0.4, 0.8, 1.0};
+  timeBins rho_imp  = {0.0, 0.001, 0.002, 0.002, 0.001, 0.0};
+  timeBins gen_time = {1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5};
+  timeBins pow_norm = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+  timeBins beta_eff = {0.0065, 0.0065, 0.0065, 0.0065, 0.0065, 0.0065};
+  timeBins lambda_h = {0.5, 0.5, 0.5, 0.5, 0.5, 0.5};
+
+  const timeBins lambdas = {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01};
+  const timeBins betas   = {0.00021, 0.00141, 0.00127, 0.00255, 0.00074, 0.00027};
+
+  precBins<epke::Precursor::ptr> precursors;
+  precBins<timeBins> concentrations;
+
+  for (precIndex k = 0; k < lambdas.size(); k++) {
+    precursors.push_back(std::make_shared<epke::Precursor>(
+      timeBins(time.size(), lambdas[k]), timeBins(time.size(), betas[k])));
+    concentrations.push_back(timeBins(time.size(),
+				      betas[k] / lambdas[k]));
+  }
+
+  auto params = std::make_shared<epke::EPKEParameters>(time, precursors, rho_imp,
+						       gen_time, pow_norm,
+						       beta_eff, lambda_h,
+						       0.5, 0.0, 1.0);
+
+  auto initial = [&]() {
+    return std::make_shared<epke::EPKEOutput>(1, time.size(), time,
+					      concentrations,
+					      timeBins(time.size(), 1.0),
+					      pow_norm,
+					      timeBins(time.size(), 0.0));
+  };
+
+  auto dynamic_output = initial();
+  auto fixed_output   = initial();
+
+  epke::Solver dynamic_solver(params, dynamic_output);
+  epke::FixedSolver<6> fixed_solver(params, fixed_output);
+
+  dynamic_solver.solve();
+  fixed_solver.solve();
+
+  for (timeIndex n = 0; n < time.size(); n++) {
+    REQUIRE(fixed_output->getPower(n) == Approx(dynamic_output->getPower(n)).epsilon(1e-12));
+    REQUIRE(fixed_output->getRho(n) == Approx(dynamic_output->getRho(n)).epsilon(1e-12));
+
+    for (precIndex k = 0; k < lambdas.size(); k++) {
+      REQUIRE(fixed_output->getConcentration(k,n) ==
+	      Approx(dynamic_output->getConcentration(k,n)).epsilon(1e-12));
+    }
+  }
+
+}
@@ -0,0 +1,141 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../catch.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/parareal.hpp"
+#include "epke/library.hpp"
+#include "epke/output.hpp"
+#include "epke/parameters.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+
+TEST_CASE("Test the C interface of the library.", "[Library]") {
+  const timeIndex n_steps = 21;
+  const timeBins  time    = util::linspace(0., 1., n_steps);
+
+  // a ramp with two groups
+  timeBins rho(n_steps), lambda(2 * n_steps), beta(2 * n_steps);
+  for (timeIndex n = 0; n < n_steps; n++) {
+    rho[n] = 0.2 * 0.0065 * time[n];
+    lambda[n] = 0.08; lambda[n_steps + n] = 0.8 + 0.1 * time[n];
+    beta[n] = 0.004;  beta[n_steps + n] = 0.0025;
+  }
+
+  const timeBins gen_time(n_steps, 1e-5), pow_norm(n_steps, 1.),
+    beta_eff(n_steps, 0.0065), lambda_h(n_steps, 0.5);
+
+  epke_parameters* params = epke_parameters_create(
+    n_steps, 2, time.data(), lambda.data(), beta.data(), rho.data(),
+    gen_time.data(), pow_norm.data(), beta_eff.data(), lambda_h.data(),
+    1.0, -0.001, 1.0);
+  REQUIRE( params );
+
+  const double power = 1., norm = 1., rho_0 = 0.;
+  const double concentrations[2] = {0.004 / 0.08, 0.0025 / 0.8};
+
+  // the same problem through the C++ classes
+  auto cpp_params = std::make_shared<epke::EPKEParameters>(
+    time,
+    precBins<epke::Precursor::ptr>(
+      {std::make_shared<epke::Precursor>(
+	 timeBins(lambda.begin(), lambda.begin() + n_steps),
+	 timeBins(beta.begin(), beta.begin() + n_steps)),
+       std::make_shared<epke::Precursor>(
+	 timeBins(lambda.begin() + n_steps, lambda.end()),
+	 timeBins(beta.begin() + n_steps, beta.end()))}),
+    rho, gen_time, pow_norm, beta_eff, lambda_h, 1.0, -0.001, 1.0);
+  cpp_params->buildCoefficients();
+
+  auto makeInitial = [&](const timeIndex n) {
+    return std::make_shared<epke::EPKEOutput>(
+      1, n, util::linspace(0., 1., n),
+      precBins<timeBins>({timeBins(n, concentrations[0]),
+			  timeBins(n, concentrations[1])}),
+      timeBins(n, power), timeBins(n, norm), timeBins(n, rho_0));
+  };
+
+  SECTION("Serial solves match the solver") {
+    epke_output* output =
+      epke_output_create(params, 1, &power, &norm, &rho_0, concentrations);
+    REQUIRE( output );
+    REQUIRE( epke_solve(params, output) == 0 );
+
+    auto expected = makeInitial(n_steps);
+    epke::Solver(cpp_params, expected).solve();
+
+    REQUIRE( epke_output_num_steps(output) == n_steps );
+    REQUIRE( epke_output_num_groups(output) == 2 );
+    for (timeIndex n = 0; n < n_steps; n++) {
+      REQUIRE( epke_output_time(output)[n] == time[n] );
+      REQUIRE( epke_output_power(output)[n] == expected->getPower(n) );
+      REQUIRE( epke_output_concentrations(output)[2 * n + 1] ==
+	       expected->getConcentration(1, n) );
+    }
+
+    epke_output_destroy(output);
+  }
+
+  SECTION("Parareal solves match parareal") {
+    const timeIndex n_fine = (n_steps - 1) * 4 + 1;
+
+    epke_output* output =
+      epke_output_create(params, 1, &power, &norm, &rho_0, concentrations);
+    REQUIRE( epke_solve_parareal(params, output, 4, 2, 2, 0., 0) == 0 );
+
+    auto fine_params = para::interpolate(cpp_params, util::linspace(0., 1., n_fine));
+    fine_params->buildCoefficients();
+    auto coarse_precomp = makeInitial(n_steps);
+    auto fine_precomp   = makeInitial(n_steps);
+    fine_precomp->resize(n_fine);
+
+    para::Parareal<epke::Solver, epke::Solver> parareal(
+      std::make_shared<epke::Solver>(cpp_params, coarse_precomp),
+      std::make_shared<epke::Solver>(fine_params, fine_precomp),
+      fine_precomp, 4, 2, "", 2);
+    parareal.solve();
+
+    REQUIRE( epke_output_num_steps(output) == n_fine );
+    for (timeIndex n = 0; n < n_fine; n++) {
+      REQUIRE( epke_output_power(output)[n] == parareal.getSolution()->getPower(n) );
+    }
+
+    epke_output_destroy(output);
+  }
+
+  SECTION("Threads share one parameter handle") {
+    std::vector<epke_output*> outputs(4);
+    std::vector<int> status(outputs.size(), -1);
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < outputs.size(); i++) {
+      outputs[i] = epke_output_create(params, 1, &power, &norm, &rho_0, concentrations);
+      threads.emplace_back([&, i]() {
+	status[i] = i % 2 ? epke_solve(params, outputs[i]) :
+	  epke_solve_parareal(params, outputs[i], 4, 2, 1, 0., 0);
+      });
+    }
+    for (auto& thread : threads) { thread.join(); }
+
+    for (std::size_t i = 0; i < outputs.size(); i++) {
+      REQUIRE( status[i] == 0 );
+      REQUIRE( epke_output_power(outputs[i])[1] == epke_output_power(outputs[i % 2])[1] );
+    }
+    for (auto output : outputs) { epke_output_destroy(output); }
+  }
+
+  SECTION("Invalid calls report an error") {
+    REQUIRE( !epke_output_create(params, 0, &power, &norm, &rho_0, concentrations) );
+    REQUIRE( std::string(epke_last_error()).size() > 0 );
+
+    epke_output* output =
+      epke_output_create(params, 1, &power, &norm, &rho_0, concentrations);
+    REQUIRE( epke_solve_parareal(params, output, 0, 2, 1, 0., 0) != 0 );
+    epke_output_destroy(output);
+  }
+
+  epke_parameters_destroy(params);
+}
@@ -0,0 +1,109 @@
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/parareal.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/mixed_solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+// Six groups at equilibrium under a constant imposed reactivity from t = 0
+static epke::EPKEParameters::ptr makeParams(const timeBins& time) {
+  return makeJump(time, 0.3 * 0.0065, -0.01);
+}
+
+// Largest difference of the power relative to the reference
+static double powerError(const epke::EPKEOutput& output,
+			 const epke::EPKEOutput& reference) {
+  double error = 0.;
+  for (timeIndex n = 0; n < reference.getNumTimeSteps(); n++) {
+    error = std::max(error, std::abs(output.getPower(n) / reference.getPower(n) - 1.));
+  }
+  return error;
+}
+
+// Parareal over the grid of coarse_params with ten fine steps per window
+template <typename Coarse>
+static epke::EPKEOutput::ptr solveParareal(epke::EPKEParameters::ptr coarse_params,
+					   epke::EPKEParameters::ptr fine_params,
+					   const paraIndex n_iterations) {
+  auto fine_precomp = makeSteady(*fine_params);
+
+  Parareal<Coarse, epke::FixedSolver<6>> parareal(
+    std::make_shared<Coarse>(coarse_params,
+			     makeSteady(*coarse_params)),
+    std::make_shared<epke::FixedSolver<6>>(fine_params, fine_precomp),
+    fine_precomp, 10, n_iterations, "", 2);
+
+  parareal.solve();
+  return parareal.getSolution();
+}
+
+TEST_CASE("Test the mixed precision solver.", "[MixedSolver]") {
+  const timeBins time = util::linspace(0., 10., 201);
+  auto params = makeParams(time);
+  params->buildCoefficients();
+
+  auto full_output = makeSteady(*params);
+  epke::FixedSolver<6> full(params, full_output);
+  full.solve();
+
+  SECTION("Steps like Solver in double precision") {
+    auto output = makeSteady(*params);
+    epke::MixedSolver<double, 6> solver(params, output);
+    solver.solve();
+
+    for (timeIndex n = 0; n < time.size(); n++) {
+      REQUIRE(output->getTime(n) == full_output->getTime(n));
+      REQUIRE(output->getPower(n) == Approx(full_output->getPower(n)).epsilon(1e-12));
+      REQUIRE(output->getRho(n) == Approx(full_output->getRho(n)).epsilon(1e-12));
+
+      for (precIndex k = 0; k < lambdas.size(); k++) {
+	REQUIRE(output->getConcentration(k, n) ==
+		Approx(full_output->getConcentration(k, n)).epsilon(1e-12));
+      }
+    }
+  }
+
+  SECTION("Stays within single precision rounding of Solver") {
+    auto output = makeSteady(*params);
+    epke::MixedSolver<float, 0> solver(params, output);
+    solver.solve();
+
+    REQUIRE(powerError(*output, *full_output) < 1e-5);
+    REQUIRE(powerError(*output, *full_output) > 0.);
+
+    for (timeIndex n = 0; n < time.size(); n++) {
+      for (precIndex k = 0; k < lambdas.size(); k++) {
+	REQUIRE(output->getConcentration(k, n) ==
+		Approx(full_output->getConcentration(k, n)).epsilon(1e-5));
+      }
+    }
+  }
+
+  SECTION("Builds its own table for parameters without one") {
+    auto output = makeSteady(*params);
+    epke::MixedSolver<float, 6> solver(makeParams(time), output);
+    solver.solve();
+
+    REQUIRE(powerError(*output, *full_output) < 1e-5);
+  }
+
+  SECTION("Converges as the coarse propagator of parareal") {
+    auto coarse_params = makeParams(util::linspace(0., 10., 21));
+    coarse_params->buildCoefficients();
+
+    auto single_20 = solveParareal<epke::MixedSolver<float, 6>>(coarse_params, params, 20);
+    auto double_20 = solveParareal<epke::FixedSolver<6>>(coarse_params, params, 20);
+    auto single_6  = solveParareal<epke::MixedSolver<float, 6>>(coarse_params, params, 6);
+    auto double_6  = solveParareal<epke::FixedSolver<6>>(coarse_params, params, 6);
+
+    // an iteration per window reaches the solution of the fine propagator,
+    // and the iterations before it come within the single precision rounding
+    REQUIRE(powerError(*single_20, *double_20) < 1e-12);
+    REQUIRE(powerError(*single_6, *double_6) < 1e-5);
+  }
+}
@@ -0,0 +1,77 @@
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+TEST_CASE("Test the prompt jump solver.", "[PromptJumpSolver]") {
+  const timeBins time = util::linspace(0., 10., 201);
+
+  SECTION("Follows a transient below prompt critical") {
+    auto params = makeJump(time, 0.3 * 0.0065, -0.01);
+
+    auto full_output = makeSteady(*params);
+    auto jump_output = makeSteady(*params);
+
+    epke::Solver full(params, full_output);
+    epke::PromptJumpSolver<0> jump(params, jump_output);
+
+    full.solve();
+    jump.solve();
+
+    // past the prompt response the two only differ by the neglected
+    // derivative of the power
+    for (timeIndex n = 20; n < time.size(); n++) {
+      REQUIRE(jump_output->getPower(n) ==
+	      Approx(full_output->getPower(n)).epsilon(1e-2));
+      REQUIRE(jump_output->getRho(n) ==
+	      Approx(full_output->getRho(n)).epsilon(1e-2));
+
+      for (precIndex k = 0; k < lambdas.size(); k++) {
+	REQUIRE(jump_output->getConcentration(k, n) ==
+		Approx(full_output->getConcentration(k, n)).epsilon(1e-2));
+      }
+    }
+  }
+
+  SECTION("Specialized on the group count") {
+    auto params = makeJump(time, 0.3 * 0.0065, -0.01);
+
+    auto dynamic_output = makeSteady(*params);
+    auto fixed_output   = makeSteady(*params);
+
+    epke::PromptJumpSolver<0> dynamic_solver(params, dynamic_output);
+    epke::PromptJumpSolver<6> fixed_solver(params, fixed_output);
+
+    dynamic_solver.solve();
+    fixed_solver.solve();
+
+    for (timeIndex n = 0; n < time.size(); n++) {
+      REQUIRE(fixed_output->getPower(n) == Approx(dynamic_output->getPower(n)).epsilon(1e-12));
+      REQUIRE(fixed_output->getRho(n) == Approx(dynamic_output->getRho(n)).epsilon(1e-12));
+    }
+  }
+
+  SECTION("Falls back to the full step above prompt critical") {
+    const timeBins short_time = util::linspace(0., 0.01, 11);
+    auto params = makeJump(short_time, 1.5 * 0.0065, 0.);
+
+    auto full_output = makeSteady(*params);
+    auto jump_output = makeSteady(*params);
+
+    epke::Solver full(params, full_output);
+    epke::PromptJumpSolver<0> jump(params, jump_output);
+
+    full.solve();
+    jump.solve();
+
+    for (timeIndex n = 0; n < short_time.size(); n++) {
+      REQUIRE(jump_output->getPower(n) == full_output->getPower(n));
+    }
+  }
+}
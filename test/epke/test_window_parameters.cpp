@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/parareal.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+// A ramp with a time-dependent decay constant, so the coefficients are
+// tabulated per step
+static epke::EPKEParameters::ptr makeDecayRamp(const timeIndex n_steps) {
+  const timeBins time = util::linspace(0., 1., n_steps);
+
+  timeBins lambda(n_steps), rho(n_steps);
+  for (timeIndex n = 0; n < n_steps; n++) {
+    lambda[n] = 0.08 + 0.01 * time[n];
+    rho[n]    = 0.2 * 0.0065 * time[n];
+  }
+
+  return makeOneGroup(time, rho, lambda);
+}
+
+TEST_CASE("Test window-scoped fine parameters.", "[Parameters]") {
+  const timeIndex n_windows = 10;
+  const timeIndex n_fine    = 6;
+  const timeIndex n_steps   = n_windows * n_fine + 1;
+
+  auto coarse_params = makeDecayRamp(n_windows + 1);
+  auto full = para::interpolate(coarse_params, util::linspace(0., 1., n_steps));
+  full->buildCoefficients();
+
+  SECTION("Windows match the full interpolation") {
+    for (const timeIndex w : {0, 1, 4, 9}) {
+      const timeIndex n_offset = w == 0 ? 0 : w * n_fine - 2;
+      const timeIndex n_stop   = std::min(n_steps, (w + 1) * n_fine + 1);
+
+      auto window = para::interpolateWindow(coarse_params, 0., 1., n_steps,
+					    n_offset, n_stop);
+      window->buildCoefficients();
+
+      REQUIRE(window->getTimeOffset() == n_offset);
+      REQUIRE(window->getNumTimeSteps() == n_stop);
+      REQUIRE(window->getInitialGenTime() == full->getInitialGenTime());
+
+      for (timeIndex n = n_offset; n < n_stop; n++) {
+	REQUIRE(window->getTime(n) == full->getTime(n));
+	REQUIRE(window->getRhoImp(n) == full->getRhoImp(n));
+	REQUIRE(window->getGenTime(n) == full->getGenTime(n));
+	REQUIRE(window->getDecayConstant(0, n) == full->getDecayConstant(0, n));
+	REQUIRE(window->getDelayedFraction(0, n) == full->getDelayedFraction(0, n));
+      }
+
+      // the solver reads coefficients from two steps past the first value
+      const auto& coefficients = window->getCoefficients();
+      for (timeIndex n = n_offset == 0 ? 0 : n_offset + 2; n < n_stop; n++) {
+	for (precIndex c = 0; c < coefficients.getNumChannels(); c++) {
+	  const auto& a = coefficients.get(c, n);
+	  const auto& b = full->getCoefficients().get(c, n);
+	  REQUIRE(a.E == b.E);
+	  REQUIRE(a.omega_n == b.omega_n);
+	  REQUIRE(a.omega_n1 == b.omega_n1);
+	  REQUIRE(a.omega_n2 == b.omega_n2);
+	}
+      }
+    }
+  }
+
+  SECTION("Parareal with window parameters matches the full parameters") {
+    using Solver = epke::Solver;
+
+    auto solve = [&](const bool window, const bool window_local) {
+      auto fine_params = window ?
+	para::interpolateWindow(coarse_params, 0., 1., n_steps, 0, n_fine + 1) :
+	full;
+      auto fine_precomp = makeSteady(*full);
+
+      Parareal<Solver, Solver> parareal(
+	std::make_shared<Solver>(coarse_params,
+				 makeSteady(*coarse_params)),
+	std::make_shared<Solver>(fine_params, fine_precomp),
+	fine_precomp, n_fine, 4, "", 2, 0., window_local);
+
+      if (window) { parareal.interpolateWindows(coarse_params, 0., 1.); }
+
+      // the solution is assembled into the precomputed fine output
+      parareal.solve();
+      return fine_precomp;
+    };
+
+    auto expected = solve(false, true);
+    auto solution = solve(true, true);
+
+    REQUIRE(solution->getPower() == expected->getPower());
+    REQUIRE(solution->getRho() == expected->getRho());
+    for (timeIndex n = 0; n < n_steps; n++) {
+      REQUIRE(solution->getConcentration(0, n) == expected->getConcentration(0, n));
+    }
+
+    // windows reading the history from t = 0 would each hold parameters from
+    // there
+    REQUIRE_THROWS(solve(true, false));
+  }
+}
@@ -0,0 +1,118 @@
+#ifndef _TEST_FIXTURES_HEADER_
+#define _TEST_FIXTURES_HEADER_
+
+#include <algorithm>
+#include <memory>
+
+#include "parareal/definitions.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/precursor.hpp"
+#include "utility/interpolate.hpp"
+
+// Problems shared by the solver and parareal tests. Each has a generation
+// time of 1e-5, a total delayed fraction of 0.0065, unit power
+// normalization and heat removal at 0.5 / s.
+namespace fixtures {
+
+  using para::timeBins;
+  using para::timeIndex;
+  using para::precIndex;
+  using para::precBins;
+
+  // Decay constants and delayed fractions of six groups
+  const timeBins lambdas = {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01};
+  const timeBins betas   = {0.00021, 0.00141, 0.00127,
+			    0.00255, 0.00074, 0.00027};
+
+  // One group under the imposed reactivity rho, with decay constant lambda
+  // at each step
+  inline epke::EPKEParameters::ptr makeOneGroup(const timeBins& time,
+						const timeBins& rho,
+						const timeBins& lambda) {
+    const timeIndex n_steps = time.size();
+
+    return std::make_shared<epke::EPKEParameters>(
+      time,
+      precBins<epke::Precursor::ptr>(
+	{std::make_shared<epke::Precursor>(lambda, timeBins(n_steps, 0.0065))}),
+      rho,
+      timeBins(n_steps, 1e-5),
+      timeBins(n_steps, 1.0),
+      timeBins(n_steps, 0.0065),
+      timeBins(n_steps, 0.5),
+      1.0, -0.001, 1.0);
+  }
+
+  // The six groups under the imposed reactivity rho
+  inline epke::EPKEParameters::ptr makeSixGroups(const timeBins& time,
+						 const timeBins& rho,
+						 const double    gamma_d) {
+    const timeIndex n_steps = time.size();
+
+    precBins<epke::Precursor::ptr> precursors;
+    for (precIndex k = 0; k < lambdas.size(); k++) {
+      precursors.push_back(std::make_shared<epke::Precursor>(
+	timeBins(n_steps, lambdas[k]), timeBins(n_steps, betas[k])));
+    }
+
+    return std::make_shared<epke::EPKEParameters>(time, precursors, rho,
+						  timeBins(n_steps, 1e-5),
+						  timeBins(n_steps, 1.0),
+						  timeBins(n_steps, 0.0065),
+						  timeBins(n_steps, 0.5),
+						  1.0, gamma_d, 1.0);
+  }
+
+  // One group under 0.3 beta, on n_steps points from 0 to 1
+  inline epke::EPKEParameters::ptr makeStep(const timeIndex n_steps) {
+    return makeOneGroup(util::linspace(0., 1., n_steps),
+			timeBins(n_steps, 0.3 * 0.0065),
+			timeBins(n_steps, 0.08));
+  }
+
+  // The six groups under a constant reactivity rho_imp from t = 0
+  inline epke::EPKEParameters::ptr makeJump(const timeBins& time,
+					    const double    rho_imp,
+					    const double    gamma_d) {
+    timeBins rho(time.size(), rho_imp);
+    rho[0] = 0.;
+    return makeSixGroups(time, rho, gamma_d);
+  }
+
+  // The six groups under a ramp to 0.5 beta over the first 0.5 s, on n_steps
+  // points from 0 to 2
+  inline epke::EPKEParameters::ptr makeRamp(const timeIndex n_steps) {
+    const timeBins time = util::linspace(0., 2., n_steps);
+
+    timeBins rho_imp(n_steps);
+    for (timeIndex n = 0; n < n_steps; n++) {
+      rho_imp[n] = 0.5 * 0.0065 * std::min(1., time[n] / 0.5);
+    }
+
+    return makeSixGroups(time, rho_imp, -0.001);
+  }
+
+  // Every step at the equilibrium of the first step of params at the given
+  // power, on the grid of params
+  inline epke::EPKEOutput::ptr makeSteady(const epke::EPKEParameters& params,
+					  const double power = 1.) {
+    const timeIndex n_steps = params.getNumTimeSteps();
+
+    precBins<timeBins> concentrations;
+    for (precIndex k = 0; k < params.getNumPrecursors(); k++) {
+      concentrations.push_back(timeBins(n_steps, power *
+					params.getDelayedFraction(k, 0) /
+					params.getDecayConstant(k, 0)));
+    }
+
+    return std::make_shared<epke::EPKEOutput>(1, n_steps, params.getTime().toVector(),
+					      concentrations,
+					      timeBins(n_steps, power),
+					      timeBins(n_steps, 1.0),
+					      timeBins(n_steps, 0.0));
+  }
+
+} // namespace fixtures
+
+#endif
@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "../catch.hpp"
+#include "parareal/batch.hpp"
+#include "utility/binary_io.hpp"
+
+// A step reactivity with one group, solved by parareal on 11 coarse steps
+static std::string writeInput(const std::string& name, const std::string& rho_imp,
+			      const std::string& options = "") {
+  const std::string path = "test_batch_" + name + ".xml";
+  std::ofstream(path) <<
+    "<parareal outpath=\"test_batch_" + name + ".epkb\" max_iterations=\"2\""
+    "  n_threads=\"2\" n_fine_per_coarse=\"4\"" + options + ">"
+    " <epke_output n_steps=\"11\" n_start=\"1\" n_stop=\"11\">"
+    "  <time>0.</time> <power>1.</power> <pow_norm>1.</pow_norm> <rho>0.</rho>"
+    "  <concentrations><concentration k=\"0\">0.08125</concentration></concentrations>"
+    " </epke_output>"
+    " <epke_input n_steps=\"11\" theta=\"1.0\" gamma_d=\"0.0\" eta=\"1.0\">"
+    "  <time>0. 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.</time>"
+    "  <rho_imp value=\"" + rho_imp + "\"/>"
+    "  <gen_time value=\"1e-5\"/> <pow_norm value=\"1.\"/>"
+    "  <beta_eff value=\"0.0065\"/> <lambda_h value=\"0.5\"/>"
+    "  <precursors><precursor k=\"0\">"
+    "   <decay_constant value=\"0.08\"/> <delayed_fraction value=\"0.0065\"/>"
+    "  </precursor></precursors>"
+    " </epke_input>"
+    "</parareal>";
+  return path;
+}
+
+static std::vector<double> getPower(const std::string& name) {
+  util::BinaryFile file("test_batch_" + name + ".epkb");
+  return file.get("power").toVector();
+}
+
+TEST_CASE("Test the batch driver.", "[Batch]") {
+  const std::string low  = writeInput("low", "0.001");
+  const std::string high = writeInput("high", "0.00195");
+  const std::string bad  = writeInput("bad", "0.001", " schedule=\"bogus\"");
+
+  std::ofstream("test_batch_manifest.txt") <<
+    "# two steps between a bad and a missing case\n" << low << "\n" << bad
+    << "\n\n" << high << "\n" "test_batch_missing.xml\n";
+
+  const std::vector<std::string> paths = Batch::loadManifest("test_batch_manifest.txt");
+  REQUIRE( paths == std::vector<std::string>({low, bad, high, "test_batch_missing.xml"}) );
+
+  Batch batch(paths, 3);
+  batch.run();
+
+  // failed cases are reported and the cases after them still run
+  REQUIRE( batch.getNumFailed() == 2 );
+  REQUIRE( batch.getCases()[1].failed );
+  REQUIRE( batch.getCases()[1].error == "Unknown parareal schedule: bogus" );
+  REQUIRE( batch.getCases()[3].failed );
+
+  for (const std::size_t i : {0, 2}) {
+    REQUIRE( !batch.getCases()[i].failed );
+    REQUIRE( batch.getCases()[i].n_threads == 2 );
+    REQUIRE( batch.getCases()[i].wall_time > 0. );
+  }
+
+  SECTION("Cases on the same grid share one coefficient table") {
+    const auto& coarse = batch.getCache().coarse_params;
+    REQUIRE( coarse.size() == 2 );
+    REQUIRE( &coarse.begin()->second.params->getCoefficients() ==
+	     &std::next(coarse.begin())->second.params->getCoefficients() );
+    REQUIRE( batch.getCache().fine_params.size() == 2 );
+    REQUIRE( batch.getCache().coefficients.size() == 2 );
+  }
+
+  SECTION("Cases give the outputs of their own runs") {
+    const std::vector<double> power = getPower("low");
+    REQUIRE( power.size() == 41 );
+    REQUIRE( power != getPower("high") );
+
+    Batch single({low}, 1);
+    single.run();
+    REQUIRE( getPower("low") == power );
+  }
+
+  for (const std::string name : {"low.xml", "high.xml", "bad.xml", "low.epkb",
+				 "high.epkb", "manifest.txt"}) {
+    std::remove(("test_batch_" + name).c_str());
+  }
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/output_spec.hpp"
+#include "parareal/parareal.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+// Heap allocations made, on any thread, while an AllocationCounter is alive.
+// Outside of one the replaced operator new only forwards to malloc like the
+// default, so the other tests of the program are unaffected.
+static std::atomic<bool>        counting(false);
+static std::atomic<std::size_t> n_allocations(0);
+
+void* operator new(std::size_t size) {
+  if (counting) { n_allocations++; }
+  if (void* p = std::malloc(size > 0 ? size : 1)) { return p; }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+class AllocationCounter {
+public:
+  AllocationCounter() { n_allocations = 0; counting = true; }
+  ~AllocationCounter() { counting = false; }
+
+  const std::size_t getCount() const { return n_allocations; }
+};
+
+using namespace para;
+using namespace fixtures;
+
+TEST_CASE("Test the reuse of the parareal buffers.", "[Parareal]") {
+  using Solver = epke::Solver;
+
+  const timeIndex n_windows = 12;
+  const timeIndex n_fine    = 8;
+
+  auto coarse_params = makeStep(n_windows + 1);
+  auto fine_params   = makeStep(n_windows * n_fine + 1);
+
+  auto makeParareal = [&](const paraIndex n_iterations, const paraIndex n_threads) {
+    auto fine_precomp = makeSteady(*fine_params);
+
+    return std::make_unique<Parareal<Solver, Solver>>(
+      std::make_shared<Solver>(coarse_params, makeSteady(*coarse_params)),
+      std::make_shared<Solver>(fine_params, fine_precomp),
+      fine_precomp, n_fine, n_iterations, "", n_threads);
+  };
+
+  // heap allocations of a whole solve with the given number of iterations
+  auto count = [&](const paraIndex n_iterations, const paraIndex n_threads,
+		   const OutputSpec& spec = OutputSpec()) {
+    auto parareal = makeParareal(n_iterations, n_threads);
+    parareal->record(spec);
+
+    AllocationCounter counter;
+    parareal->solve();
+    return counter.getCount();
+  };
+
+  SECTION("Windows are solved without allocating") {
+    auto parareal = makeParareal(1, 1);
+    parareal->runCoarseSolver();
+
+    for (timeIndex n = 0; n < n_windows; n++) {
+      AllocationCounter counter;
+      parareal->runFineSolver(0, n);
+      REQUIRE(counter.getCount() == 0);
+    }
+  }
+
+  SECTION("Windows and the coarsened solution are refilled in place") {
+    for (const paraIndex n_threads : {1, 3}) {
+      REQUIRE(count(1, n_threads) == count(6, n_threads));
+    }
+  }
+
+  SECTION("Recorded windows are refilled in place") {
+    OutputSpec spec;
+    spec.stride = 4;
+
+    for (const paraIndex n_threads : {1, 3}) {
+      REQUIRE(count(1, n_threads, spec) == count(6, n_threads, spec));
+    }
+  }
+
+  SECTION("Refilled windows match new ones") {
+    auto coarse = makeSteady(*coarse_params);
+    for (timeIndex n = 0; n < coarse->getNumTimeSteps(); n++) {
+      coarse->setPower(n, 1. + 0.1 * n);
+      coarse->setConcentration(0, n, 0.08 - 0.001 * n);
+    }
+
+    epke::EPKEOutput::ptr window;
+    epke::EPKEOutput::ptr precomp;
+
+    for (const timeIndex n : {3, 0, 7, 5}) {
+      auto fresh = createWindow(coarse, n, n_fine);
+      createWindow(coarse, n, n_fine, window);
+
+      REQUIRE(window->getTimeOffset() == fresh->getTimeOffset());
+      REQUIRE(window->getNumTimeSteps() == fresh->getNumTimeSteps());
+      REQUIRE(window->getStartTimeIndex() == fresh->getStartTimeIndex());
+      REQUIRE(window->getStopTimeIndex() == fresh->getStopTimeIndex());
+      REQUIRE(window->getInitialPower() == fresh->getInitialPower());
+
+      for (timeIndex i = fresh->getTimeOffset(); i < fresh->getNumTimeSteps(); i++) {
+	REQUIRE(window->getTime(i) == fresh->getTime(i));
+	REQUIRE(window->getPower(i) == fresh->getPower(i));
+	REQUIRE(window->getConcentration(0, i) == fresh->getConcentration(0, i));
+      }
+
+      auto full = createPrecomputed(coarse, n, n_fine);
+      createPrecomputed(coarse, n, n_fine, precomp);
+
+      REQUIRE(precomp->getStartTimeIndex() == full->getStartTimeIndex());
+      REQUIRE(precomp->getNumTimeSteps() == full->getNumTimeSteps());
+      REQUIRE(precomp->getPower() == full->getPower());
+      REQUIRE(precomp->getRho() == full->getRho());
+
+      for (timeIndex i = 0; i < full->getNumTimeSteps(); i++) {
+	REQUIRE(precomp->getTime(i) == full->getTime(i));
+	REQUIRE(precomp->getConcentration(0, i) == full->getConcentration(0, i));
+      }
+    }
+  }
+}
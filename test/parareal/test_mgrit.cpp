@@ -0,0 +1,74 @@
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/mgrit.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+TEST_CASE("Test the multigrid reduction in time solver.", "[MGRIT]") {
+  using Solver = epke::FixedSolver<6>;
+
+  auto params = makeRamp(401);
+
+  auto serial = makeSteady(*params);
+  Solver(params, serial).solve();
+
+  SECTION("Coarsens down to the smallest level") {
+    MGRIT<Solver> mgrit(params, makeSteady(*params), 4, 0, 3, 1, "");
+
+    // 401, 101, 26 and 7 points
+    REQUIRE(mgrit.getNumLevels() == 4);
+    REQUIRE(mgrit.getNumCoarsest() == 7);
+
+    MGRIT<Solver> two_levels(params, makeSteady(*params), 4, 2, 3, 1, "");
+
+    REQUIRE(two_levels.getNumLevels() == 2);
+    REQUIRE(two_levels.getNumCoarsest() == 101);
+  }
+
+  SECTION("Converges to the serial solution") {
+    MGRIT<Solver> mgrit(params, makeSteady(*params), 4, 0, 3, 20, "", 1, 1e-10);
+    mgrit.solve();
+
+    const auto& residuals = mgrit.getResiduals();
+
+    REQUIRE(residuals.size() < 20);
+    REQUIRE(residuals.back() <= 1e-10);
+
+    auto solution = mgrit.getSolution();
+
+    for (timeIndex n = 0; n < params->getNumTimeSteps(); n++) {
+      REQUIRE(solution->getTime(n) == params->getTime(n));
+      REQUIRE(solution->getPower(n) == Approx(serial->getPower(n)).epsilon(1e-8));
+      REQUIRE(solution->getRho(n) ==
+	      Approx(serial->getRho(n)).epsilon(1e-8).margin(1e-14));
+    }
+  }
+
+  SECTION("F-relaxation also converges") {
+    MGRIT<Solver> mgrit(params, makeSteady(*params), 4, 0, 3, 40, "", 1, 1e-8,
+			false);
+    mgrit.solve();
+
+    REQUIRE(mgrit.getResiduals().back() <= 1e-8);
+  }
+
+  SECTION("Does not depend on the number of threads") {
+    MGRIT<Solver> one(params, makeSteady(*params), 4, 0, 3, 3, "", 1);
+    MGRIT<Solver> three(params, makeSteady(*params), 4, 0, 3, 3, "", 3);
+
+    one.solve();
+    three.solve();
+
+    REQUIRE(one.getResiduals() == three.getResiduals());
+
+    for (timeIndex n = 0; n < params->getNumTimeSteps(); n++) {
+      REQUIRE(one.getSolution()->getPower(n) == three.getSolution()->getPower(n));
+    }
+  }
+}
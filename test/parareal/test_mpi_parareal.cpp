@@ -0,0 +1,69 @@
+#ifdef PARA_USE_MPI
+
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/mpi_parareal.hpp"
+#include "parareal/parareal.hpp"
+#include "epke/solver.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+// Built with `make mpi=1`, where the test main initializes MPI. `make test`
+// runs it on one rank, which owns every window, and `make test_mpi` on
+// several, which exchange boundary states, reduce the residuals and gather
+// the solution on rank 0. Each rank also solves the problem with the shared
+// memory backend to compare with.
+TEST_CASE("Test the mpi parareal backend against shared memory.", "[MPIParareal]") {
+  using Solver = epke::Solver;
+
+  const timeIndex n_windows = 10;
+  const timeIndex n_fine    = 8;
+
+  auto coarse_params = makeStep(n_windows + 1);
+  auto fine_params   = makeStep(n_windows * n_fine + 1);
+
+  auto shared = std::make_shared<Parareal<Solver, Solver>>(
+    std::make_shared<Solver>(coarse_params, makeSteady(*coarse_params)),
+    std::make_shared<Solver>(fine_params, makeSteady(*fine_params)),
+    makeSteady(*fine_params), n_fine, 3, "", 2);
+
+  MPIParareal<Solver, Solver> mpi(
+    std::make_shared<Solver>(coarse_params, makeSteady(*coarse_params)),
+    std::make_shared<Solver>(fine_params, makeSteady(*fine_params)),
+    makeSteady(*fine_params), n_fine, 3, "", 2);
+
+  // checks before the solve do not stop this rank, which would leave the
+  // others waiting for it
+  const int rank    = mpi.getRank();
+  const int n_ranks = mpi.getNumRanks();
+  CHECK(mpi.getStartWindow() == n_windows * rank / n_ranks);
+  CHECK(mpi.getStopWindow() == n_windows * (rank + 1) / n_ranks);
+
+  shared->solve();
+  mpi.solve();
+
+  // every rank holds the reduced residuals
+  REQUIRE(mpi.getResiduals().size() == shared->getResiduals().size());
+
+  for (std::size_t k = 0; k < mpi.getResiduals().size(); k++) {
+    REQUIRE(mpi.getResiduals()[k] ==
+	    Approx(shared->getResiduals()[k]).epsilon(1e-12).margin(1e-15));
+  }
+
+  // and rank 0 the gathered solution
+  if (rank == 0) {
+    auto expected = shared->getSolution();
+    auto solution = mpi.getSolution();
+
+    for (timeIndex n = 0; n < expected->getNumTimeSteps(); n++) {
+      REQUIRE(solution->getTime(n) == expected->getTime(n));
+      REQUIRE(solution->getPower(n) == Approx(expected->getPower(n)).epsilon(1e-12));
+      REQUIRE(solution->getConcentration(0, n) ==
+	      Approx(expected->getConcentration(0, n)).epsilon(1e-12));
+    }
+  }
+}
+
+#endif // PARA_USE_MPI
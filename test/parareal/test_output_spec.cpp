@@ -0,0 +1,146 @@
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/output_spec.hpp"
+#include "parareal/parareal.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+TEST_CASE("Test the output spec records.", "[OutputSpec]") {
+  const timeBins time = {0.0, 1.0, 2.0, 3.0, 4.0};
+  auto output = std::make_shared<epke::EPKEOutput>(
+    1, time.size(), time,
+    precBins<timeBins>({{0.5, 1.0, 1.5, 2.0, 2.5}}),
+    timeBins({1.0, 2.0, 3.0, 2.5, 2.0}),
+    timeBins({1.0, 1.0, 1.0, 1.0, 1.0}),
+    timeBins({0.0, 1.0, 2.0, 1.0, 0.0}));
+
+  auto record = [&](const OutputSpec& spec) {
+    auto result = createRecord(output);
+    for (timeIndex n = 0; n < time.size(); n++) {
+      result->recordImpl(spec, *output, n);
+    }
+    return result;
+  };
+
+  SECTION("The default spec keeps everything") {
+    REQUIRE(OutputSpec().isFull());
+
+    auto full = record(OutputSpec());
+    REQUIRE(full->getTime() == output->getTime());
+    REQUIRE(full->getPower() == output->getPower());
+    REQUIRE(full->getPowNorm() == output->getPowNorm());
+    REQUIRE(full->getRho() == output->getRho());
+    REQUIRE(full->getConcentration(0, 4) == 2.5);
+  }
+
+  SECTION("Every stride-th step of the kept quantities") {
+    OutputSpec spec;
+    spec.stride = 2;
+    spec.quantities = {"power", "rho"};
+
+    auto strided = record(spec);
+    REQUIRE(strided->getTime() == timeBins({0.0, 2.0, 4.0}));
+    REQUIRE(strided->getPower() == timeBins({1.0, 3.0, 2.0}));
+    REQUIRE(strided->getRho() == timeBins({0.0, 2.0, 0.0}));
+    REQUIRE(strided->getPowNorm().empty());
+    REQUIRE_THROWS(strided->getConcentration(0, 0));
+  }
+
+  SECTION("Interpolated to the listed times") {
+    OutputSpec spec;
+    spec.times = {-1.0, 0.5, 2.0, 3.25, 5.0};
+
+    auto sampled = record(spec);
+    REQUIRE(sampled->getTime() == timeBins({-1.0, 0.5, 2.0, 3.25}));
+    REQUIRE(sampled->getPower() == timeBins({1.0, 1.5, 3.0, 2.375}));
+    REQUIRE(sampled->getConcentration(0, 3) == Approx(2.125));
+  }
+
+  SECTION("Records append in order") {
+    OutputSpec spec;
+    spec.stride = 3;
+
+    auto first = createRecord(output);
+    auto second = createRecord(output);
+    for (timeIndex n = 0; n < 2; n++) { first->recordImpl(spec, *output, n); }
+    for (timeIndex n = 2; n < 5; n++) { second->recordImpl(spec, *output, n); }
+
+    first->appendImpl(*second);
+    REQUIRE(first->getTime() == timeBins({0.0, 3.0}));
+    REQUIRE(first->getStopTimeIndex() == 2);
+    REQUIRE(first->getConcentration(0, 1) == 2.0);
+  }
+}
+
+TEST_CASE("Test parareal with an output spec.", "[OutputSpec]") {
+  using Solver = epke::Solver;
+
+  const timeIndex n_windows = 10;
+  const timeIndex n_fine    = 8;
+
+  auto coarse_params = makeStep(n_windows + 1);
+  auto fine_params   = makeStep(n_windows * n_fine + 1);
+
+  // parareal recording spec, with initial conditions on the coarse grid
+  // alone unless spec keeps everything
+  auto solve = [&](const OutputSpec& spec, const paraIndex n_iterations,
+		   const bool asynchronous) {
+    auto fine_precomp = spec.isFull() ? makeSteady(*fine_params) :
+      makeSteady(*coarse_params);
+
+    Parareal<Solver, Solver> parareal(
+      std::make_shared<Solver>(coarse_params, makeSteady(*coarse_params)),
+      std::make_shared<Solver>(fine_params, fine_precomp),
+      fine_precomp, n_fine, n_iterations, "", 3, 0., true, asynchronous);
+
+    parareal.record(spec);
+    parareal.solve();
+    return std::make_pair(parareal.getSolution(), parareal.getResiduals());
+  };
+
+  for (const bool asynchronous : {false, true}) {
+    auto full = solve(OutputSpec(), 3, asynchronous);
+
+    OutputSpec spec;
+    spec.stride = 4;
+    spec.quantities = {"power", "rho"};
+
+    auto strided = solve(spec, 3, asynchronous);
+    auto solution = strided.first;
+
+    // the boundary jumps are those of the whole fine solution
+    REQUIRE(strided.second == full.second);
+    REQUIRE(solution->getNumTimeSteps() == n_windows * n_fine / 4 + 1);
+    REQUIRE(solution->getPowNorm().empty());
+
+    for (timeIndex i = 0; i < solution->getNumTimeSteps(); i++) {
+      REQUIRE(solution->getTime(i) == full.first->getTime(4 * i));
+      REQUIRE(solution->getPower(i) == full.first->getPower(4 * i));
+      REQUIRE(solution->getRho(i) == full.first->getRho(4 * i));
+    }
+
+    OutputSpec times;
+    times.times = {0.0, 0.33, 0.5, 0.999};
+
+    auto sampled = solve(times, 3, asynchronous).first;
+    REQUIRE(sampled->getTime() == times.times);
+
+    // 0.5 lies on fine step 40
+    REQUIRE(sampled->getPower(2) == Approx(full.first->getPower(40)));
+    REQUIRE(sampled->getConcentration(0, 0) == 0.0065 / 0.08);
+  }
+
+  SECTION("Without iterations the coarse solution is recorded") {
+    OutputSpec spec;
+    spec.stride = 5;
+
+    auto solution = solve(spec, 0, false).first;
+    REQUIRE(solution->getTime() == timeBins({0.0, 0.5, 1.0}));
+  }
+}
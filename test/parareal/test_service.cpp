@@ -0,0 +1,147 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "../catch.hpp"
+#include "parareal/service.hpp"
+#include "utility/binary_io.hpp"
+
+// A step of 0.3 beta with one group, solved by parareal on 11 coarse steps
+static std::string makeInput(const std::string& rho_imp) {
+  return
+    "<parareal max_iterations=\"2\" n_threads=\"2\" n_fine_per_coarse=\"4\">"
+    " <epke_output n_steps=\"11\" n_start=\"1\" n_stop=\"11\">"
+    "  <time>0.</time> <power>1.</power> <pow_norm>1.</pow_norm> <rho>0.</rho>"
+    "  <concentrations><concentration k=\"0\">0.08125</concentration></concentrations>"
+    " </epke_output>"
+    " <epke_input n_steps=\"11\" theta=\"1.0\" gamma_d=\"0.0\" eta=\"1.0\">"
+    "  <time>0. 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.</time>"
+    "  <rho_imp value=\"" + rho_imp + "\"/>"
+    "  <gen_time value=\"1e-5\"/> <pow_norm value=\"1.\"/>"
+    "  <beta_eff value=\"0.0065\"/> <lambda_h value=\"0.5\"/>"
+    "  <precursors><precursor k=\"0\">"
+    "   <decay_constant value=\"0.08\"/> <delayed_fraction value=\"0.0065\"/>"
+    "  </precursor></precursors>"
+    " </epke_input>"
+    "</parareal>";
+}
+
+// Power of a returned binary container
+static std::vector<double> getPower(const std::string& container) {
+  const std::string path = "test_service_output.epkb";
+  std::ofstream(path, std::ios::binary) << container;
+
+  std::vector<double> power;
+  {
+    util::BinaryFile file(path);
+    power = file.get("power").toVector();
+  }
+  std::remove(path.c_str());
+  return power;
+}
+
+TEST_CASE("Test the solver service.", "[Service]") {
+  Service service("test_service.epkb");
+
+  const std::vector<double> power = getPower(service.solve(makeInput("0.00195")));
+  REQUIRE( power.size() == 41 );
+  REQUIRE( service.getCache().coarse_params.size() == 1 );
+  REQUIRE( service.getCache().fine_params.size() == 1 );
+
+  SECTION("Repeated cases reuse the cached parameters") {
+    REQUIRE( getPower(service.solve(makeInput("0.00195"))) == power );
+    REQUIRE( service.getCache().coarse_params.size() == 1 );
+    REQUIRE( service.getCache().fine_params.size() == 1 );
+  }
+
+  SECTION("Other cases are solved from their own parameters") {
+    const std::vector<double> other = getPower(service.solve(makeInput("0.001")));
+    REQUIRE( other != power );
+    REQUIRE( service.getCache().coarse_params.size() == 2 );
+
+    Service fresh("test_service.epkb");
+    REQUIRE( getPower(fresh.solve(makeInput("0.001"))) == other );
+  }
+
+  SECTION("Malformed inputs are reported") {
+    REQUIRE_THROWS_AS( service.solve("<parareal"), std::runtime_error );
+    REQUIRE_THROWS_AS( service.solve("<epke_input/>"), std::runtime_error );
+
+    std::string bad = makeInput("0.00195");
+    bad.insert(std::string("<parareal").size(), " coarse=\"bogus\"");
+    REQUIRE_THROWS_AS( service.solve(bad), std::runtime_error );
+
+    for (const std::string n_threads : {"0", "-1", "65536"}) {
+      std::string threads = makeInput("0.00195");
+      threads.replace(threads.find("n_threads=\"2\""), 13,
+		      "n_threads=\"" + n_threads + "\"");
+      REQUIRE_THROWS_WITH( service.solve(threads),
+			   "Between 1 and 65535 threads are supported, not " +
+			   n_threads );
+    }
+  }
+
+  SECTION("The cache keeps at most its capacity of cases") {
+    Service bounded("test_service.epkb");
+    bounded.getCache().capacity = 1;
+
+    bounded.solve(makeInput("0.00195"));
+    bounded.solve(makeInput("0.001"));
+    REQUIRE( bounded.getCache().coarse_params.size() == 1 );
+    REQUIRE( bounded.getCache().fine_params.size() == 1 );
+
+    REQUIRE( getPower(bounded.solve(makeInput("0.00195"))) == power );
+  }
+}
+
+TEST_CASE("Test the service survives bad requests.", "[Service]") {
+  int requests[2], responses[2];
+  REQUIRE( ::pipe(requests) == 0 );
+  REQUIRE( ::pipe(responses) == 0 );
+
+  auto send = [&](const std::string& document) {
+    const std::uint64_t length = document.size();
+    REQUIRE( ::write(requests[1], &length, sizeof(length)) == sizeof(length) );
+    REQUIRE( ::write(requests[1], document.data(), length) == ssize_t(length) );
+  };
+
+  std::string bad = makeInput("0.00195");
+  bad.insert(std::string("<parareal").size(), " schedule=\"bogus\"");
+
+  send(bad);
+  send(makeInput("0.00195"));
+  send("");
+  ::close(requests[1]);
+
+  Service service("test_service.epkb");
+  REQUIRE( service.serve(requests[0], responses[1]) );
+  ::close(requests[0]);
+  ::close(responses[1]);
+
+  auto receive = [&]() {
+    std::uint64_t header[2];
+    REQUIRE( ::read(responses[0], header, sizeof(header)) == sizeof(header) );
+
+    std::string payload(header[1], '\0');
+    std::size_t n_read = 0;
+    while (n_read < payload.size()) {
+      const ssize_t n = ::read(responses[0], &payload[n_read], payload.size() - n_read);
+      REQUIRE( n > 0 );
+      n_read += n;
+    }
+    return std::make_pair(header[0], payload);
+  };
+
+  const auto failed = receive();
+  REQUIRE( failed.first == 1 );
+  REQUIRE( failed.second == "Unknown parareal schedule: bogus" );
+
+  const auto solved = receive();
+  REQUIRE( solved.first == 0 );
+  REQUIRE( getPower(solved.second).size() == 41 );
+
+  ::close(responses[0]);
+}
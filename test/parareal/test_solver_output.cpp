@@ -1,30 +1,42 @@
+#include <cmath>
+
 #include "../catch.hpp"
 #include "parareal/definitions.hpp"
 #include "parareal/solver_output.hpp"
+#include "epke/output.hpp"
 
 TEST_CASE("Test solver_output functions.", "[SolverOutput]") {
   SECTION("Create precomputed solver output values", "[createPrecomputed]") {
     using namespace para;
 
     // output data
-    timeBins time  = {0.0, 1.0, 2.0, 3.0, 4.0};
-    timeBins power = {1.0, 2.0, 3.0, 2.5, 2.0};
-    timeBins rho   = {0.0, 1.0, 2.0, 1.0, 0.0};
+    timeBins time     = {0.0, 1.0, 2.0, 3.0, 4.0};
+    timeBins power    = {1.0, 2.0, 3.0, 2.5, 2.0};
+    timeBins pow_norm = {1.0, 1.0, 1.0, 1.0, 1.0};
+    timeBins rho      = {0.0, 1.0, 2.0, 1.0, 0.0};
     precBins<timeBins> concentrations = {{0.5, 1.0, 1.5, 2.0, 2.5}};
 
-    auto output = std::make_shared<epke::EPKEOutput>(time,
+    auto output = std::make_shared<epke::EPKEOutput>(1,
+						     time.size(),
+						     time,
 						     concentrations,
 						     power,
+						     pow_norm,
 						     rho);
 
+    REQUIRE(output->getConcentrations() == concentrations);
+
     timeBins fine_p_history = {1.0, 2.0, 3.0};
     timeBins fine_rho_history = {0.0, 1.0, 2.0};
     precBins<timeBins> fine_zeta_histories = {{0.5, 1.0, 1.5}};
 
     auto precomp = createPrecomputed(output, 2, 1);
 
+    REQUIRE(precomp->getStartTimeIndex() == 3);
+    REQUIRE(precomp->getStopTimeIndex() == 4);
+
     // Check the precomputed "history" values
-    for (timeIndex n = 0; n < precomp->getNumTimeSteps(); n++) {
+    for (timeIndex n = 0; n < precomp->getStartTimeIndex(); n++) {
       REQUIRE(precomp->getPower(n) == fine_p_history.at(n));
       REQUIRE(precomp->getRho(n) == fine_rho_history.at(n));
 
@@ -35,17 +47,118 @@ TEST_CASE("Test solver_output functions.", "[SolverOutput]") {
     }
   }
 
+  SECTION("Create window-local solver output values", "[createWindow]") {
+    using namespace para;
+
+    // coarse output data
+    timeBins time     = {0.0, 1.0, 2.0, 3.0, 4.0};
+    timeBins power    = {1.0, 2.0, 3.0, 2.5, 2.0};
+    timeBins pow_norm = {1.0, 1.0, 1.0, 1.0, 1.0};
+    timeBins rho      = {0.0, 1.0, 2.0, 1.0, 0.0};
+    precBins<timeBins> concentrations = {{0.5, 1.0, 1.5, 2.0, 2.5}};
+
+    auto output = std::make_shared<epke::EPKEOutput>(1,
+						     time.size(),
+						     time,
+						     concentrations,
+						     power,
+						     pow_norm,
+						     rho);
+
+    // window after coarse index 2 with two fine steps per coarse step
+    auto window = createWindow(output, 2, 2);
+    auto precomp = createPrecomputed(output, 2, 2);
+
+    REQUIRE(window->getStartTimeIndex() == 5);
+    REQUIRE(window->getStopTimeIndex() == 7);
+
+    // only the two steps before the window are stored
+    REQUIRE(window->getTimeOffset() == 3);
+    REQUIRE(window->getNumTimeSteps() == 7);
+    REQUIRE(window->getInitialPower() == power.front());
+
+    // the history matches the one interpolated from t = 0
+    for (timeIndex n = window->getTimeOffset();
+	 n < window->getStartTimeIndex(); n++) {
+      REQUIRE(window->getTime(n) == Approx(precomp->getTime(n)));
+      REQUIRE(window->getPower(n) == Approx(precomp->getPower(n)));
+      REQUIRE(window->getRho(n) == Approx(precomp->getRho(n)));
+
+      for (precIndex k = 0; k < window->getNumPrecursors(); k++) {
+	REQUIRE(window->getConcentration(k,n) ==
+		Approx(precomp->getConcentration(k,n)));
+      }
+    }
+
+    // the first window only needs the initial condition
+    auto first = createWindow(output, 0, 2);
+
+    REQUIRE(first->getTimeOffset() == 0);
+    REQUIRE(first->getPower(0) == power.front());
+  }
+
+  SECTION("Create slices on the same time grid", "[createSlice]") {
+    using namespace para;
+
+    timeBins time     = {0.0, 1.0, 2.0, 3.0, 4.0};
+    timeBins power    = {1.0, 2.0, 3.0, 2.5, 2.0};
+    timeBins pow_norm = {1.0, 1.0, 1.0, 1.0, 1.0};
+    timeBins rho      = {0.0, 1.0, 2.0, 1.0, 0.0};
+    precBins<timeBins> concentrations = {{0.5, 1.0, 1.5, 2.0, 2.5}};
+
+    auto output = std::make_shared<epke::EPKEOutput>(1,
+						     time.size(),
+						     time,
+						     concentrations,
+						     power,
+						     pow_norm,
+						     rho);
+
+    auto slice = createSlice(output, 3, 5, 2);
+
+    REQUIRE(slice->getStartTimeIndex() == 3);
+    REQUIRE(slice->getStopTimeIndex() == 5);
+    REQUIRE(slice->getTimeOffset() == 1);
+    REQUIRE(slice->getNumTimeSteps() == 5);
+    REQUIRE(slice->getInitialPower() == power.front());
+
+    // the values are copied, not interpolated
+    for (timeIndex n = slice->getTimeOffset(); n < slice->getNumTimeSteps(); n++) {
+      REQUIRE(slice->getTime(n) == time[n]);
+      REQUIRE(slice->getPower(n) == power[n]);
+      REQUIRE(slice->getRho(n) == rho[n]);
+      REQUIRE(slice->getConcentration(0, n) == concentrations[0][n]);
+    }
+
+    // the history is cut at the first stored step
+    auto first = createSlice(output, 1, 2, 2);
+
+    REQUIRE(first->getTimeOffset() == 0);
+    REQUIRE(first->getPower(0) == power.front());
+
+    // slices of slices keep the global indices
+    auto nested = createSlice(slice, 4, 5, 1);
+
+    REQUIRE(nested->getTimeOffset() == 3);
+    REQUIRE(nested->getPower(4) == power[4]);
+  }
+
   SECTION("Coarsen values from a fine time grid", "[coarsen]") {
     using namespace para;
 
-    timeBins fine_time  = {0.0, 0.5, 1.0, 1.5, 2.0};
-    timeBins fine_power = {1.0, 2.0, 3.0, 2.5, 2.0};
-    timeBins fine_rho   = {0.0, 1.0, 2.0, 1.0, 0.0};
+    // the refined grid need not hold the coarse times exactly
+    timeBins fine_time     = {0.0, 0.5, std::nextafter(1.0, 2.0), 1.5, 2.0};
+    timeBins fine_power    = {1.0, 2.0, 3.0, 2.5, 2.0};
+    timeBins fine_pow_norm = {1.0, 1.0, 1.0, 1.0, 1.0};
+    timeBins fine_rho      = {0.0, 1.0, 2.0, 1.0, 0.0};
     precBins<timeBins> fine_concentrations = {{0.5, 1.0, 1.5, 2.0, 2.5}};
 
-    auto fine_output = std::make_shared<epke::EPKEOutput>(fine_time,
+    auto fine_output = std::make_shared<epke::EPKEOutput>(1,
+							  fine_time.size(),
+							  fine_time,
 							  fine_concentrations,
 							  fine_power,
+							  fine_pow_norm,
 							  fine_rho);
 
     timeBins coarse_time  = {0.0, 1.0, 2.0};
@@ -53,7 +166,7 @@ TEST_CASE("Test solver_output functions.", "[SolverOutput]") {
     timeBins coarse_rho   = {0.0, 2.0, 0.0};
     precBins<timeBins> coarse_concentrations = {{0.5, 1.5, 2.5}};
 
-    auto coarse_output = coarsen(fine_output, coarse_time);
+    auto coarse_output = fine_output->coarsen(coarse_time, 2);
 
     for (timeIndex n = 0; n < coarse_output->getNumTimeSteps(); n++) {
       REQUIRE(coarse_output->getPower(n) == coarse_power.at(n));
@@ -0,0 +1,141 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "../catch.hpp"
+#include "../fixtures.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/parareal.hpp"
+#include "parareal/task_graph.hpp"
+#include "epke/parameters.hpp"
+#include "epke/output.hpp"
+#include "epke/solver.hpp"
+#include "utility/interpolate.hpp"
+
+using namespace para;
+using namespace fixtures;
+
+TEST_CASE("Test task graph functions.", "[TaskGraph]") {
+  SECTION("Tasks run after their dependencies", "[run]") {
+    ThreadPool pool(4);
+    TaskGraph graph;
+
+    // a chain of tasks, each of which fans out to a few leaves
+    std::vector<std::atomic<int>> finished(40);
+    for (auto& f : finished) { f = 0; }
+
+    std::atomic<bool> out_of_order(false);
+
+    std::vector<TaskGraph::id> chain;
+    for (std::size_t i = 0; i < 10; i++) {
+      chain.push_back(graph.add([&, i](const paraIndex) {
+	  if (i > 0 && !finished[i-1]) { out_of_order = true; }
+	  finished[i]++;
+	}, {0, i, 0}));
+
+      if (i > 0) { graph.depend(chain[i], chain[i-1]); }
+
+      for (std::size_t j = 0; j < 3; j++) {
+	const std::size_t leaf = 10 + 3 * i + j;
+	graph.depend(graph.add([&, i, leaf](const paraIndex) {
+	      if (!finished[i]) { out_of_order = true; }
+	      finished[leaf]++;
+	    }, {1, i, j}), chain[i]);
+      }
+    }
+
+    REQUIRE(graph.getNumTasks() == 40);
+
+    graph.run(pool);
+
+    REQUIRE(!out_of_order);
+    for (const auto& f : finished) { REQUIRE(f == 1); }
+  }
+
+  SECTION("A throwing task fails the run", "[run]") {
+    ThreadPool pool(4);
+    TaskGraph graph;
+
+    // independent tasks, and a task after the one that throws
+    std::atomic<int> n_run(0);
+    for (std::size_t i = 0; i < 20; i++) {
+      graph.add([&](const paraIndex) { n_run++; }, {0, i, 0});
+    }
+
+    const TaskGraph::id failing = graph.add([](const paraIndex) {
+	throw std::runtime_error("no root");
+      }, {0, 0, 1});
+
+    std::atomic<bool> after(false);
+    graph.depend(graph.add([&](const paraIndex) { after = true; }, {0, 0, 2}),
+		 failing);
+
+    REQUIRE_THROWS_WITH(graph.run(pool), "no root");
+    REQUIRE(!after);
+
+    // the pool runs other graphs afterwards
+    TaskGraph other;
+    for (std::size_t i = 0; i < 8; i++) {
+      other.add([&](const paraIndex) { n_run++; }, {0, i, 0});
+    }
+
+    const int before = n_run;
+    other.run(pool);
+    REQUIRE(n_run == before + 8);
+  }
+
+  SECTION("Ready tasks run by priority", "[run]") {
+    ThreadPool pool(1);
+    TaskGraph graph;
+
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < 4; i++) {
+      graph.add([&, i](const paraIndex) { order.push_back(i); }, {0, 3 - i, 0});
+    }
+
+    graph.run(pool);
+
+    REQUIRE(order == std::vector<std::size_t>({3, 2, 1, 0}));
+  }
+
+  SECTION("The async parareal schedule matches the bulk one", "[Parareal]") {
+    using Solver   = epke::FixedSolver<6>;
+    using Parareal = para::Parareal<Solver, Solver>;
+
+    const timeIndex n_windows = 16;
+    const timeIndex n_fine    = 10;
+
+    auto coarse_params = makeRamp(n_windows + 1);
+    auto fine_params   = para::interpolate(
+      coarse_params, util::linspace(0., 2., n_windows * n_fine + 1));
+
+    // the fine output is also the global output that parareal fills in
+    auto make = [&](epke::EPKEOutput::ptr fine_precomp, const bool asynchronous,
+		    const double tolerance, const paraIndex n_threads) {
+      return std::make_unique<Parareal>(
+	std::make_shared<Solver>(coarse_params, makeSteady(*coarse_params)),
+	std::make_shared<Solver>(fine_params, fine_precomp),
+	fine_precomp, n_fine, 6, "", n_threads, tolerance, true, asynchronous);
+    };
+
+    for (const double tolerance : {0., 1e-6}) {
+      auto bulk_out  = makeSteady(*fine_params);
+      auto async_out = makeSteady(*fine_params);
+
+      auto bulk  = make(bulk_out, false, tolerance, 2);
+      auto async = make(async_out, true, tolerance, 3);
+
+      bulk->solve();
+      async->solve();
+
+      if (tolerance > 0.) { REQUIRE(bulk->getResiduals().size() < 6); }
+
+      REQUIRE(async->getResiduals() == bulk->getResiduals());
+
+      for (timeIndex n = 0; n < fine_params->getNumTimeSteps(); n++) {
+	REQUIRE(async_out->getPower(n) == bulk_out->getPower(n));
+	REQUIRE(async_out->getRho(n) == bulk_out->getRho(n));
+      }
+    }
+  }
+}
@@ -0,0 +1,91 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../catch.hpp"
+#include "parareal/definitions.hpp"
+#include "parareal/thread_pool.hpp"
+
+TEST_CASE("Test thread pool functions.", "[ThreadPool]") {
+  using namespace para;
+
+  SECTION("Every index is visited exactly once", "[parallelFor]") {
+    ThreadPool pool(4);
+
+    REQUIRE(pool.getNumThreads() == 4);
+
+    std::vector<std::atomic<int>> visits(100);
+    for (auto& v : visits) { v = 0; }
+
+    // Catch assertions are not thread safe, so only record bad worker ids
+    std::atomic<bool> bad_worker(false);
+
+    // run several batches to make sure the workers are reused
+    for (int batch = 0; batch < 3; batch++) {
+      pool.parallelFor(0, visits.size(),
+		       [&](const paraIndex w, const timeIndex i) {
+			 if (w >= pool.getNumThreads()) { bad_worker = true; }
+			 visits[i]++;
+		       });
+    }
+
+    REQUIRE(!bad_worker);
+
+    for (const auto& v : visits) {
+      REQUIRE(v == 3);
+    }
+  }
+
+  SECTION("A pool needs a thread") {
+    REQUIRE_THROWS_AS(ThreadPool(0), std::runtime_error);
+  }
+
+  SECTION("A throwing item fails the batch and the pool is reused", "[parallelFor]") {
+    ThreadPool pool(4);
+
+    std::atomic<int> started(0);
+    REQUIRE_THROWS_WITH(
+      pool.parallelFor(0, 1000, [&](const paraIndex, const timeIndex i) {
+	  started++;
+	  if (i % 100 == 3) { throw std::runtime_error("item " + std::to_string(i)); }
+	  std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}),
+      Catch::Matchers::StartsWith("item "));
+
+    // the rest of the batch is skipped
+    REQUIRE(started < 1000);
+
+    // every item throwing, on the calling thread as well as the workers
+    REQUIRE_THROWS_AS(
+      pool.parallelFor(0, 16, [&](const paraIndex, const timeIndex) {
+	  throw std::runtime_error("every item");
+	}),
+      std::runtime_error);
+
+    std::vector<std::atomic<int>> visits(100);
+    for (auto& v : visits) { v = 0; }
+
+    pool.parallelFor(0, visits.size(), [&](const paraIndex, const timeIndex i) {
+	visits[i]++;
+      });
+
+    for (const auto& v : visits) {
+      REQUIRE(v == 1);
+    }
+  }
+
+  SECTION("A single thread runs on the calling thread", "[parallelFor]") {
+    ThreadPool pool(1);
+
+    std::vector<timeIndex> order;
+    pool.parallelFor(2, 6, [&](const paraIndex w, const timeIndex i) {
+	REQUIRE(w == 0);
+	order.push_back(i);
+      });
+
+    REQUIRE(order == std::vector<timeIndex>({2, 3, 4, 5}));
+  }
+}
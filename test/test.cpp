@@ -1,2 +1,21 @@
+#ifdef PARA_USE_MPI
+
+// The mpi backend needs MPI initialized around the whole run
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <mpi.h>
+
+int main(int argc, char* argv[]) {
+  MPI_Init(&argc, &argv);
+  const int result = Catch::Session().run(argc, argv);
+  MPI_Finalize();
+  return result;
+}
+
+#else
+
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
+
+#endif
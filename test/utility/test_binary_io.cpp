@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "../catch.hpp"
+#include "utility/binary_io.hpp"
+
+using namespace util;
+
+TEST_CASE( "Test binary container round trip", "[binary_io]" ) {
+  const std::string path = "test_binary_io.epkb";
+
+  std::vector<double> time  = {0.0, 0.1, 0.2, 0.3};
+  std::vector<double> power = {1.0, 1.0000000000000002, 1.1, 1e-300};
+
+  // two groups stored time-major
+  std::vector<double> concentrations = {1., 2., 3., 4., 5., 6., 7., 8.};
+
+  {
+    BinaryWriter writer(path);
+    writer.add("time", time);
+    writer.add("power", power);
+    writer.add("concentration_0", concentrations.data(), 4, 2);
+    writer.add("concentration_1", concentrations.data() + 1, 4, 2);
+    writer.add("solve_time", 0.5);
+    writer.add("empty", nullptr, 0);
+    writer.write();
+  }
+
+  SECTION("Arrays are read back exactly") {
+    BinaryFile file(path);
+
+    REQUIRE( file.has("time") );
+    REQUIRE( !file.has("rho") );
+    REQUIRE( file.get("time", 4).toVector() == time );
+    REQUIRE( file.get("power").toVector() == power );
+    REQUIRE( file.get("concentration_0").toVector() ==
+	     std::vector<double>({1., 3., 5., 7.}) );
+    REQUIRE( file.get("concentration_1").toVector() ==
+	     std::vector<double>({2., 4., 6., 8.}) );
+    REQUIRE( file.get("solve_time").size() == 1 );
+    REQUIRE( file.get("solve_time")[0] == 0.5 );
+    REQUIRE( file.get("empty").size() == 0 );
+  }
+
+  SECTION("Bad files and arrays throw") {
+    BinaryFile file(path);
+
+    REQUIRE_THROWS_AS( file.get("rho"), std::runtime_error );
+    REQUIRE_THROWS_WITH( file.get("time", 5),
+			 path + ": array time has 4 values, expected 5" );
+
+    REQUIRE_THROWS_AS( BinaryFile("test_binary_io_missing.epkb"),
+		       std::runtime_error );
+
+    std::ofstream("test_binary_io.xml") << "<epke_output/>";
+    REQUIRE_THROWS_WITH( BinaryFile("test_binary_io.xml"),
+			 "test_binary_io.xml: not an epke binary file" );
+    std::remove("test_binary_io.xml");
+
+    BinaryWriter writer(path);
+    REQUIRE_THROWS_AS( writer.add(std::string(binary_name_size, 'x'), time),
+		       std::runtime_error );
+    REQUIRE_THROWS_AS( BinaryWriter("no_such_directory/out.epkb").write(),
+		       std::runtime_error );
+
+    // a small container only fails when its buffer is flushed
+    BinaryWriter full("/dev/full");
+    full.add("time", time);
+    REQUIRE_THROWS_WITH( full.write(), "Failed to write /dev/full" );
+  }
+
+  SECTION("Binary paths are recognized by extension") {
+    REQUIRE( isBinaryPath("out.epkb") );
+    REQUIRE( !isBinaryPath("out.xml") );
+    REQUIRE( !isBinaryPath("epkb") );
+  }
+
+  std::remove(path.c_str());
+}
@@ -29,4 +29,96 @@ TEST_CASE( "Test linear interpolation functions", "[interpolate]" ) {
 
     REQUIRE( interpolate(x,y,x_new) == y_new );
   }
+
+  SECTION("Interval lookups match the scalar search") {
+    std::vector<double> x_uniform = linspace(0., 2., 21);
+    std::vector<double> x_graded;
+    for (int i = 0; i < 21; i++) { x_graded.push_back(0.005 * i * i); }
+
+    // sorted, repeated, out of range and unsorted queries
+    std::vector<double> x_new = linspace(-0.5, 2.5, 301);
+    x_new.insert(x_new.end(), {0.1, 0.1, 1.9, 0.0, 2.0, 1.0, 0.3, 1.5});
+
+    for (const auto& x_grid : {x_uniform, x_graded}) {
+      std::vector<double> y_grid;
+      for (const auto x_val : x_grid) { y_grid.push_back(std::sin(3. * x_val)); }
+
+      const std::vector<double> y_new = interpolate(x_grid, y_grid, x_new);
+
+      for (std::size_t j = 0; j < x_new.size(); j++) {
+	REQUIRE( y_new[j] == interpolate(x_grid, y_grid, x_new[j]) );
+      }
+    }
+  }
+
+  SECTION("Interpolate many series sharing a grid") {
+    std::vector<double> x_new = {1.25, 1.75};
+    std::vector<std::vector<double>> ys = {y, {0.0, 1.0, 0.0}};
+
+    const auto ys_new = interpolate(x, ys, x_new);
+
+    REQUIRE( ys_new.size() == 2 );
+    REQUIRE( ys_new[0] == std::vector<double>({2.5, 3.5}) );
+    REQUIRE( ys_new[1] == std::vector<double>({0.5, 0.5}) );
+  }
+}
+
+TEST_CASE( "Test exponential coefficient kernels", "[exponential]" ) {
+  SECTION("Series and closed forms agree near the switch-over") {
+    const double below = std::nextafter(small_lambda_dt, 0.);
+    const double above = small_lambda_dt;
+
+    REQUIRE( k1(below, 1.) == Approx(k1(above, 1.)).epsilon(1e-13) );
+    REQUIRE( k2(below, 1.) == Approx(k2(above, 1.)).epsilon(1e-13) );
+    REQUIRE( k0(below, 1.) == Approx(1. - E(above, 1.)).epsilon(1e-13) );
+  }
+
+  SECTION("Small lambda * dt keeps the leading terms of k1 and k2") {
+    const double x = 1e-7;
+
+    REQUIRE( k1(x, 1.) == Approx(x / 2. - x * x / 6.).epsilon(1e-15) );
+    REQUIRE( k2(x, 1.) == Approx(x / 3. - x * x / 12.).epsilon(1e-15) );
+  }
+
+  SECTION("Batched weights match the single-channel functions") {
+    const std::vector<double> lambda =
+      {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01, 14.5, 120., 2.e3};
+    const double dt = 0.01, gamma = 1.5;
+    const std::size_t n = lambda.size();
+
+    std::vector<double> w(7 * n);
+    ExponentialWeights out = {&w[0], &w[n], &w[2*n], &w[3*n],
+			      &w[4*n], &w[5*n], &w[6*n]};
+    exponentialWeights(lambda.data(), n, dt, gamma, out);
+
+    for (std::size_t i = 0; i < n; i++) {
+      const double l = lambda[i];
+      REQUIRE( out.E[i] == Approx(E(l, dt)).epsilon(1e-14) );
+      REQUIRE( out.k0[i] == Approx(k0(l, dt)).epsilon(1e-14) );
+      REQUIRE( out.k1[i] == Approx(k1(l, dt)).epsilon(1e-14) );
+      REQUIRE( out.k2[i] == Approx(k2(l, dt)).epsilon(1e-14) );
+      REQUIRE( out.omega_n[i] == Approx(omegaN(l, dt, gamma)).epsilon(1e-14) );
+      REQUIRE( out.omega_n1[i] == Approx(omegaN1(l, dt, gamma)).epsilon(1e-14) );
+      REQUIRE( out.omega_n2[i] == Approx(omegaN2(l, dt, gamma)).epsilon(1e-14) );
+    }
+  }
+}
+
+TEST_CASE( "Test the root of the power equation", "[powerRoot]" ) {
+  SECTION("Matches the quadratic formula") {
+    const double a = -0.3, b = -2., c = 1.5;
+    REQUIRE( powerRoot(a, b, c) ==
+	     Approx((-b - std::sqrt(b * b - 4 * a * c)) / (2 * a)).epsilon(1e-14) );
+    REQUIRE( powerRoot(a, 2., c) ==
+	     Approx((-2. - std::sqrt(4. - 4 * a * c)) / (2 * a)).epsilon(1e-14) );
+  }
+
+  SECTION("Keeps its digits when a is small") {
+    // the root is c / -b to first order in a, while the quadratic formula
+    // cancels to nothing
+    const double a = -1e-17, b = -1., c = 1.;
+    REQUIRE( (-b - std::sqrt(b * b - 4 * a * c)) / (2 * a) == 0. );
+    REQUIRE( powerRoot(a, b, c) == Approx(1.).epsilon(1e-15) );
+    REQUIRE( powerRoot(-1e-9, b, c) == Approx(1. - 1e-9).epsilon(1e-15) );
+  }
 }
@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <string>
+
+#include "../catch.hpp"
+#include "utility/load_data.hpp"
+
+using namespace util;
+
+TEST_CASE( "Test numeric array parsing", "[load_data]" ) {
+  SECTION("Tokens are counted and parsed") {
+    const std::string text = "\n\t1.5 -2e-3  +4\r\n0.1 ";
+
+    REQUIRE( countTokens(text.data(), text.data() + text.size()) == 4 );
+    REQUIRE( parseValues(text.data(), text.data() + text.size(), "test")
+	     == std::vector<double>({1.5, -2e-3, 4., 0.1}) );
+  }
+
+  SECTION("Chunked parsing matches a single pass") {
+    std::string text;
+    std::vector<double> values;
+    char token[32];
+
+    for (int i = 0; i < 40000; i++) {
+      values.push_back(1. / (i + 1) - 0.25 * i);
+      std::snprintf(token, sizeof(token), "%.17g ", values.back());
+      text += token;
+    }
+
+    const char* begin = text.data();
+    const char* end   = text.data() + text.size();
+
+    REQUIRE( parseValues(begin, end, "test", 1) == values );
+    REQUIRE( parseValues(begin, end, "test", 4) == values );
+    REQUIRE( parseValues(begin, end, "test", 7) == values );
+  }
+
+  SECTION("Bad tokens are reported from any chunk") {
+    std::string text;
+    for (int i = 0; i < 60000; i++) { text += "1.25 "; }
+
+    // in the last of four chunks, and then in the first one too
+    text.replace(text.size() - 10, 4, "1.x5");
+    REQUIRE_THROWS_WITH( parseValues(text.data(), text.data() + text.size(), "test", 4),
+			 "Invalid value '1.x5' in test" );
+
+    text.replace(0, 4, "bad!");
+    REQUIRE_THROWS_WITH( parseValues(text.data(), text.data() + text.size(), "test", 4),
+			 "Invalid value 'bad!' in test" );
+  }
+
+  SECTION("Arrays must hold n_steps values") {
+    pugi::xml_document doc;
+    doc.load_string("<power>1 2 3</power>");
+
+    REQUIRE( loadVectorData(doc.child("power"), 3)
+	     == std::vector<double>({1., 2., 3.}) );
+    REQUIRE( loadVectorData(doc.child("power"))
+	     == std::vector<double>({1., 2., 3.}) );
+
+    REQUIRE_THROWS_WITH( loadVectorData(doc.child("power"), 5),
+			 "<power> has 3 values but n_steps is 5" );
+    REQUIRE_THROWS( loadVectorData(doc.child("power"), 2) );
+    REQUIRE_THROWS( loadSeriesData(doc.child("power"), 5) );
+  }
+
+  SECTION("Histories shorter than n_steps are padded with zeros") {
+    pugi::xml_document doc;
+    doc.load_string("<power>1 2 3</power>");
+
+    REQUIRE( loadHistoryData(doc.child("power"), 5)
+	     == std::vector<double>({1., 2., 3., 0., 0.}) );
+    REQUIRE_THROWS( loadHistoryData(doc.child("power"), 2) );
+  }
+
+  SECTION("Constant arrays come from the value attribute") {
+    pugi::xml_document doc;
+    doc.load_string("<gen_time value=\"2e-5\"/>");
+
+    REQUIRE( loadVectorData(doc.child("gen_time"), 3)
+	     == std::vector<double>({2e-5, 2e-5, 2e-5}) );
+
+    doc.load_string("<rho_imp value=\"0.\"/>");
+    REQUIRE( loadVectorData(doc.child("rho_imp"), 2)
+	     == std::vector<double>({0., 0.}) );
+  }
+}
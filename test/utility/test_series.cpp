@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include "../catch.hpp"
+#include "epke/parameters.hpp"
+#include "utility/interpolate.hpp"
+#include "utility/series.hpp"
+
+using namespace util;
+
+TEST_CASE( "Test compact parameter series", "[series]" ) {
+
+  SECTION("Uniform grids evaluate the points of linspace") {
+    const std::vector<double> grid = linspace(0., 0.7, 71);
+    const Series series = Series::uniform(0., 0.7, 71);
+
+    REQUIRE( series.isUniform() );
+    REQUIRE( series.size() == grid.size() );
+    REQUIRE( series.toVector() == grid );
+    REQUIRE( series.back() == 0.7 );
+
+    const Series window = series.window(40, 71);
+    REQUIRE( window.isUniform() );
+    REQUIRE( window.size() == 31 );
+    for (std::size_t n = 0; n < window.size(); n++) {
+      REQUIRE( window[n] == grid[40 + n] );
+    }
+
+    REQUIRE( std::upper_bound(series.begin(), series.end(), 0.355) - series.begin()
+	     == std::upper_bound(grid.begin(), grid.end(), 0.355) - grid.begin() );
+  }
+
+  SECTION("Values are stored in the most compact exact form") {
+    REQUIRE( Series::compact({2., 2., 2.}).isConstant() );
+    REQUIRE( Series::compact(linspace(0., 3., 7)).isUniform() );
+
+    const Series tabulated = Series::compact({0., 1., 3.});
+    REQUIRE( tabulated.getKind() == Series::Kind::tabulated );
+    REQUIRE( tabulated.toVector() == std::vector<double>({0., 1., 3.}) );
+
+    const Series constant = Series::constant(0.5, 4);
+    REQUIRE( constant.size() == 4 );
+    REQUIRE( constant.at(3) == 0.5 );
+    REQUIRE( constant.stride() == 0 );
+    REQUIRE_THROWS( constant.at(4) );
+  }
+
+  SECTION("Interpolation keeps constant series constant") {
+    const Series x = Series::uniform(0., 1., 5);
+    const std::vector<double> x_new = linspace(0., 1., 17);
+    const Interpolation interpolation(x, x_new);
+
+    const Series constant = interpolation(Series::constant(0.08, 5));
+    REQUIRE( constant.isConstant() );
+    REQUIRE( constant.size() == 17 );
+
+    const std::vector<double> y = {0., 1., 3., 2., 5.};
+    REQUIRE( interpolation(Series(y)).toVector() ==
+	     interpolate(x.toVector(), y, x_new) );
+  }
+
+  SECTION("Parameters store constant precursor data once") {
+    using namespace para;
+
+    const Series time = Series::uniform(0., 1., 5);
+    auto params = [&](const Series& lambda) {
+      return std::make_shared<epke::EPKEParameters>(
+	time,
+	precBins<epke::Precursor::ptr>(
+	  {std::make_shared<epke::Precursor>(lambda, Series::constant(0.0065, 5)),
+	   std::make_shared<epke::Precursor>(lambda, Series::constant(0.001, 5))}),
+	Series({0., 1e-3, 2e-3, 1e-3, 0.}),
+	Series::constant(1e-5, 5),
+	Series::constant(1., 5),
+	Series::constant(0.0075, 5),
+	Series::constant(0.5, 5),
+	1.0, -0.001, 1.0);
+    };
+
+    auto compact   = params(Series::constant(0.08, 5));
+    auto tabulated = params(Series(timeBins(5, 0.08)));
+
+    REQUIRE( compact->hasConstantDecay() );
+    REQUIRE( !tabulated->hasConstantDecay() );
+
+    for (timeIndex n = 0; n < 5; n++) {
+      REQUIRE( compact->getDecayConstantsAt(n)[1] == 0.08 );
+      REQUIRE( compact->getDelayedFraction(1, n) == tabulated->getDelayedFraction(1, n) );
+    }
+
+    const Series fine_time = Series::uniform(0., 1., 41);
+    auto fine_compact   = para::interpolate(compact, fine_time);
+    auto fine_tabulated = para::interpolate(tabulated, fine_time);
+
+    fine_compact->buildCoefficients();
+    fine_tabulated->buildCoefficients();
+    REQUIRE( fine_compact->getCoefficients().isCollapsed() ==
+	     fine_tabulated->getCoefficients().isCollapsed() );
+
+    for (timeIndex n = 0; n < 41; n++) {
+      REQUIRE( fine_compact->getRhoImp(n) == fine_tabulated->getRhoImp(n) );
+      REQUIRE( fine_compact->getDecayConstant(0, n) ==
+	       fine_tabulated->getDecayConstant(0, n) );
+      REQUIRE( fine_compact->getDelayedFraction(1, n) ==
+	       fine_tabulated->getDelayedFraction(1, n) );
+      REQUIRE( fine_compact->getCoefficients().get(0, n).E ==
+	       fine_tabulated->getCoefficients().get(0, n).E );
+    }
+  }
+}
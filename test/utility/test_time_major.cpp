@@ -0,0 +1,32 @@
+#include "../catch.hpp"
+#include "utility/time_major.hpp"
+
+using namespace util;
+
+TEST_CASE( "Test time-major storage functions", "[time_major]" ) {
+  std::vector<std::vector<double>> histories = {{1.0, 2.0, 3.0},
+						{4.0, 5.0, 6.0}};
+
+  SECTION("Pack histories with the groups of a time step adjacent") {
+    std::vector<double> packed = {1.0, 4.0, 2.0, 5.0, 3.0, 6.0};
+
+    REQUIRE( packTimeMajor(histories) == packed );
+  }
+
+  SECTION("Unpack the histories of every group") {
+    REQUIRE( unpackTimeMajor(packTimeMajor(histories), 2) == histories );
+    REQUIRE( unpackTimeMajor({}, 2) == std::vector<std::vector<double>>(2) );
+  }
+
+  SECTION("View the history of a single group") {
+    std::vector<double> packed = packTimeMajor(histories);
+
+    for (std::size_t k = 0; k < histories.size(); k++) {
+      StridedView view(packed.data() + k, histories.size(), 3);
+
+      REQUIRE( view.size() == 3 );
+      REQUIRE( view[1] == histories[k][1] );
+      REQUIRE( view.toVector() == histories[k] );
+    }
+  }
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <stdexcept>
+
+#include "../catch.hpp"
+#include "pugi/pugixml.hpp"
+#include "utility/load_data.hpp"
+#include "utility/xml_writer.hpp"
+
+using namespace util;
+
+TEST_CASE( "Test streaming xml writer", "[xml_writer]" ) {
+  const std::string path = "test_xml_writer.xml";
+
+  std::vector<double> power = {1.0, 1.0000000000000002, 0.1, 1e-300, -2.5e7};
+  std::vector<double> concentrations = {1., 2., 3., 4., 5., 6.};
+
+  {
+    XMLWriter writer(path);
+    writer.open("parareal");
+    writer.attribute("n_iterations", 3);
+    writer.attribute("outpath", "a<b>&\"c\"");
+    writer.element("power", power);
+    writer.open("concentrations");
+    writer.open("concentration");
+    writer.attribute("k", 1);
+    writer.values(concentrations.data() + 1, 3, 2);
+    writer.close();
+    writer.close();
+    writer.open("empty");
+    writer.close();
+    writer.close();
+    writer.finish();
+  }
+
+  pugi::xml_document doc;
+  REQUIRE( doc.load_file(path.c_str()) );
+
+  const pugi::xml_node root = doc.child("parareal");
+
+  SECTION("Values read back exactly") {
+    REQUIRE( loadVectorData(root.child("power")) == power );
+    REQUIRE( loadVectorData(root.child("concentrations").child("concentration"))
+	     == std::vector<double>({2., 4., 6.}) );
+  }
+
+  SECTION("Attributes are written and escaped") {
+    REQUIRE( root.attribute("n_iterations").as_int() == 3 );
+    REQUIRE( std::string(root.attribute("outpath").value()) == "a<b>&\"c\"" );
+    REQUIRE( root.child("concentrations").child("concentration")
+	     .attribute("k").as_int() == 1 );
+    REQUIRE( root.child("empty") );
+  }
+
+  SECTION("Failed writes throw") {
+    // the error of a small document only shows when the file is closed
+    XMLWriter small("/dev/full");
+    small.element("power", power);
+    REQUIRE_THROWS_AS( small.finish(), std::runtime_error );
+
+    // a large one fails part way, and its writer is destroyed while the
+    // error unwinds
+    const std::vector<double> large(1 << 17, 0.125);
+    REQUIRE_THROWS_AS( [&] {
+	XMLWriter writer("/dev/full");
+	writer.open("parareal");
+	writer.element("power", large);
+	writer.finish();
+      }(), std::runtime_error );
+  }
+
+  std::remove(path.c_str());
+}